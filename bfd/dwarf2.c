@@ -186,6 +186,31 @@ struct dwarf2_debug
 #define STASH_INFO_HASH_ON         1
 #define STASH_INFO_HASH_DISABLED   2
 
+  /* Table of the address ranges of all comp units, sorted by address.
+     Only built once every comp unit has been read.  */
+  struct addr_range_entry *unit_ranges;
+
+  /* Number of entries in the table above.  */
+  unsigned int num_unit_ranges;
+
+  /* Comp units without an address range, which may contain any
+     address.  */
+  struct addr_range_entry *unranged_units;
+
+  /* Number of entries in the table above.  */
+  unsigned int num_unranged_units;
+
+  /* TRUE if the two tables above have been built.  */
+  bfd_boolean unit_ranges_built;
+
+  /* Entries of the two tables above for the comp units which may
+     contain the address being looked up, in the order of the
+     all_comp_units list.  Large enough to hold every entry.  */
+  struct addr_range_entry **addr_units;
+
+  /* Number of entries in use in ADDR_UNITS.  */
+  unsigned int num_addr_units;
+
   /* True if we opened bfd_ptr.  */
   bfd_boolean close_on_cleanup;
 };
@@ -197,6 +222,26 @@ struct arange
   bfd_vma high;
 };
 
+/* An address range of a function or comp unit.  A table of these
+   sorted by LOW lets us find the entries containing an address with
+   a binary search, rather than by walking every range.  */
+
+struct addr_range_entry
+{
+  bfd_vma low;
+  bfd_vma high;
+  /* The largest HIGH of this and all preceding entries in the table.  */
+  bfd_vma max_high;
+  /* Position of the owner in the list the table was built from, used
+     to break ties the same way a walk of that list would.  */
+  unsigned int idx;
+  union
+  {
+    struct funcinfo *func;
+    struct comp_unit *unit;
+  } u;
+};
+
 /* A minimal decoding of DWARF2 compilation units.  We only decode
    what's needed to get to the line number information.  */
 
@@ -253,6 +298,15 @@ struct comp_unit
   /* A list of the functions found in this comp. unit.  */
   struct funcinfo *function_table;
 
+  /* The address ranges of the functions above, sorted by address.  */
+  struct addr_range_entry *lookup_funcinfo_table;
+
+  /* Number of entries in the table above.  */
+  unsigned int number_of_lookup_funcinfos;
+
+  /* TRUE if lookup_funcinfo_table has been built.  */
+  bfd_boolean lookup_funcinfo_built;
+
   /* A list of the variables found in this comp. unit.  */
   struct varinfo *variable_table;
 
@@ -1130,6 +1184,8 @@ struct line_sequence
   bfd_vma               low_pc;
   struct line_sequence* prev_sequence;
   struct line_info*     last_line;  /* Largest VMA.  */
+  struct line_info**    line_info_lookup;  /* Lines sorted by VMA.  */
+  unsigned int          num_lines;  /* Entries in line_info_lookup.  */
 };
 
 struct line_info_table
@@ -1279,6 +1335,8 @@ add_line_info (struct line_info_table *table,
       seq->low_pc = address;
       seq->prev_sequence = table->sequences;
       seq->last_line = info;
+      seq->line_info_lookup = NULL;
+      seq->num_lines = 0;
       table->lcl_head = info;
       table->sequences = seq;
       table->num_sequences++;
@@ -1498,6 +1556,8 @@ sort_line_sequences (struct line_info_table* table)
       sequences[n].low_pc = seq->low_pc;
       sequences[n].prev_sequence = NULL;
       sequences[n].last_line = seq->last_line;
+      sequences[n].line_info_lookup = NULL;
+      sequences[n].num_lines = 0;
       seq = seq->prev_sequence;
       free (last_seq);
     }
@@ -1526,6 +1586,8 @@ sort_line_sequences (struct line_info_table* table)
 	  /* Close up the gap.  */
 	  sequences[num_sequences].low_pc = sequences[n].low_pc;
 	  sequences[num_sequences].last_line = sequences[n].last_line;
+	  sequences[num_sequences].line_info_lookup = NULL;
+	  sequences[num_sequences].num_lines = 0;
 	}
       num_sequences++;
     }
@@ -1920,6 +1982,35 @@ decode_line_info (struct comp_unit *unit, struct dwarf2_debug *stash)
   return NULL;
 }
 
+/* Build the array of the lines of SEQ sorted by increasing VMA, for
+   binary searching.  */
+
+static bfd_boolean
+build_line_info_lookup (struct line_info_table *table,
+			struct line_sequence *seq)
+{
+  struct line_info **line_info_lookup;
+  struct line_info *each_line;
+  unsigned int num_lines = 0;
+  bfd_size_type amt;
+
+  for (each_line = seq->last_line; each_line; each_line = each_line->prev_line)
+    num_lines++;
+
+  amt = sizeof (struct line_info *) * num_lines;
+  line_info_lookup = (struct line_info **) bfd_alloc (table->abfd, amt);
+  if (line_info_lookup == NULL)
+    return FALSE;
+
+  /* The list runs from the largest VMA down.  */
+  seq->num_lines = num_lines;
+  for (each_line = seq->last_line; each_line; each_line = each_line->prev_line)
+    line_info_lookup[--num_lines] = each_line;
+
+  seq->line_info_lookup = line_info_lookup;
+  return TRUE;
+}
+
 /* If ADDR is within TABLE set the output parameters and return the
    range of addresses covered by the entry used to fill them out.
    Otherwise set * FILENAME_PTR to NULL and return 0.
@@ -1954,12 +2045,25 @@ lookup_address_in_line_info_table (struct line_info_table *table,
 
   if (seq && addr >= seq->low_pc && addr < seq->last_line->address)
     {
-      /* Note: seq->last_line should be a descendingly sorted list.  */
-      for (each_line = seq->last_line;
-	   each_line;
-	   each_line = each_line->prev_line)
-	if (addr >= each_line->address)
-	  break;
+      /* Binary search the lines of the sequence for the last one at
+	 or below ADDR.  */
+      each_line = NULL;
+      if (seq->line_info_lookup != NULL
+	  || build_line_info_lookup (table, seq))
+	{
+	  low = 0;
+	  high = seq->num_lines;
+	  while (low < high)
+	    {
+	      mid = (low + high) / 2;
+	      if (seq->line_info_lookup[mid]->address <= addr)
+		low = mid + 1;
+	      else
+		high = mid;
+	    }
+	  if (low > 0)
+	    each_line = seq->line_info_lookup[low - 1];
+	}
 
       if (each_line
 	  && !(each_line->end_sequence || each_line == seq->last_line))
@@ -1987,12 +2091,134 @@ read_debug_ranges (struct comp_unit *unit)
 		       &stash->dwarf_ranges_buffer, &stash->dwarf_ranges_size);
 }
 
+/* Address range table functions.  */
+
+/* Compare function for address range table entries.  */
+
+static int
+compare_addr_range_entries (const void *a, const void *b)
+{
+  const struct addr_range_entry *entry1 = a;
+  const struct addr_range_entry *entry2 = b;
+
+  if (entry1->low < entry2->low)
+    return -1;
+  if (entry1->low > entry2->low)
+    return 1;
+
+  if (entry1->idx < entry2->idx)
+    return -1;
+  if (entry1->idx > entry2->idx)
+    return 1;
+
+  return 0;
+}
+
+/* Sort the COUNT entries of TABLE by address and set their max_high
+   fields, ready for lookup_addr_range_table.  */
+
+static void
+sort_addr_range_table (struct addr_range_entry *table, unsigned int count)
+{
+  bfd_vma max_high = 0;
+  unsigned int i;
+
+  qsort (table, count, sizeof (*table), compare_addr_range_entries);
+
+  for (i = 0; i < count; i++)
+    {
+      if (table[i].high > max_high)
+	max_high = table[i].high;
+      table[i].max_high = max_high;
+    }
+}
+
+/* Return the index of the first of the COUNT entries of TABLE which
+   may contain ADDR.  Every entry which contains ADDR is at or after
+   the returned index, and before the first entry whose low address is
+   above ADDR.  */
+
+static unsigned int
+lookup_addr_range_table (const struct addr_range_entry *table,
+			 unsigned int count,
+			 bfd_vma addr)
+{
+  unsigned int low, high, mid;
+
+  /* max_high never decreases, so binary search for the first entry
+     with max_high above ADDR; no earlier entry can contain ADDR.  */
+  low = 0;
+  high = count;
+  while (low < high)
+    {
+      mid = (low + high) / 2;
+      if (table[mid].max_high <= addr)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+
+  return low;
+}
+
 /* Function table functions.  */
 
+/* Build the sorted table of function address ranges for UNIT.  */
+
+static bfd_boolean
+build_lookup_funcinfo_table (struct comp_unit *unit)
+{
+  struct addr_range_entry *table;
+  struct funcinfo *each_func;
+  struct arange *arange;
+  unsigned int count = 0;
+  unsigned int idx;
+  bfd_size_type amt;
+
+  unit->lookup_funcinfo_built = TRUE;
+
+  for (each_func = unit->function_table;
+       each_func;
+       each_func = each_func->prev_func)
+    for (arange = &each_func->arange; arange; arange = arange->next)
+      if (arange->low < arange->high)
+	count++;
+
+  if (count == 0)
+    return TRUE;
+
+  amt = sizeof (struct addr_range_entry) * count;
+  table = (struct addr_range_entry *) bfd_alloc (unit->abfd, amt);
+  if (table == NULL)
+    return FALSE;
+
+  count = 0;
+  for (each_func = unit->function_table, idx = 0;
+       each_func;
+       each_func = each_func->prev_func, idx++)
+    for (arange = &each_func->arange; arange; arange = arange->next)
+      if (arange->low < arange->high)
+	{
+	  table[count].low = arange->low;
+	  table[count].high = arange->high;
+	  table[count].idx = idx;
+	  table[count].u.func = each_func;
+	  count++;
+	}
+
+  sort_addr_range_table (table, count);
+
+  unit->lookup_funcinfo_table = table;
+  unit->number_of_lookup_funcinfos = count;
+  return TRUE;
+}
+
 /* If ADDR is within UNIT's function tables, set FUNCTIONNAME_PTR, and return
    TRUE.  Note that we need to find the function that has the smallest range
    that contains ADDR, to handle inlined functions without depending upon
-   them being ordered in TABLE by increasing range.  */
+   them being ordered in TABLE by increasing range.  Of functions with
+   equally small ranges, pick the one nearest the head of the function
+   table.  */
 
 static bfd_boolean
 lookup_address_in_function_table (struct comp_unit *unit,
@@ -2000,35 +2226,40 @@ lookup_address_in_function_table (struct comp_unit *unit,
 				  struct funcinfo **function_ptr,
 				  const char **functionname_ptr)
 {
-  struct funcinfo* each_func;
-  struct funcinfo* best_fit = NULL;
+  struct addr_range_entry *table;
+  unsigned int count;
+  unsigned int i;
+  struct addr_range_entry *best_fit = NULL;
   bfd_vma best_fit_len = 0;
-  struct arange *arange;
 
-  for (each_func = unit->function_table;
-       each_func;
-       each_func = each_func->prev_func)
+  if (!unit->lookup_funcinfo_built
+      && !build_lookup_funcinfo_table (unit))
+    return FALSE;
+
+  table = unit->lookup_funcinfo_table;
+  count = unit->number_of_lookup_funcinfos;
+  for (i = lookup_addr_range_table (table, count, addr);
+       i < count && table[i].low <= addr;
+       i++)
     {
-      for (arange = &each_func->arange;
-	   arange;
-	   arange = arange->next)
+      if (addr < table[i].high)
 	{
-	  if (addr >= arange->low && addr < arange->high)
+	  bfd_vma len = table[i].high - table[i].low;
+
+	  if (!best_fit
+	      || len < best_fit_len
+	      || (len == best_fit_len && table[i].idx < best_fit->idx))
 	    {
-	      if (!best_fit
-		  || arange->high - arange->low < best_fit_len)
-		{
-		  best_fit = each_func;
-		  best_fit_len = arange->high - arange->low;
-		}
+	      best_fit = &table[i];
+	      best_fit_len = len;
 	    }
 	}
     }
 
   if (best_fit)
     {
-      *functionname_ptr = best_fit->name;
-      *function_ptr = best_fit;
+      *functionname_ptr = best_fit->u.func->name;
+      *function_ptr = best_fit->u.func;
       return TRUE;
     }
   else
@@ -3406,6 +3637,139 @@ stash_find_line_fast (struct dwarf2_debug *stash,
 				   filename_ptr, linenumber_ptr);
 }
 
+/* Build the tables of comp unit address ranges of STASH.  Every comp
+   unit must already have been read.  */
+
+static bfd_boolean
+stash_build_unit_ranges (bfd *abfd, struct dwarf2_debug *stash)
+{
+  struct comp_unit *each;
+  struct arange *arange;
+  unsigned int num_ranges = 0;
+  unsigned int num_unranged = 0;
+  unsigned int idx;
+  bfd_size_type amt;
+
+  for (each = stash->all_comp_units; each; each = each->next_unit)
+    {
+      if (each->arange.high == 0)
+	num_unranged++;
+      else
+	for (arange = &each->arange; arange; arange = arange->next)
+	  num_ranges++;
+    }
+
+  amt = sizeof (struct addr_range_entry) * (num_ranges + num_unranged);
+  stash->unit_ranges = (struct addr_range_entry *) bfd_alloc (abfd, amt);
+  amt = sizeof (struct addr_range_entry *) * (num_ranges + num_unranged);
+  stash->addr_units = (struct addr_range_entry **) bfd_alloc (abfd, amt);
+  if (stash->unit_ranges == NULL || stash->addr_units == NULL)
+    return FALSE;
+  stash->unranged_units = stash->unit_ranges + num_ranges;
+
+  num_ranges = 0;
+  num_unranged = 0;
+  for (each = stash->all_comp_units, idx = 0;
+       each;
+       each = each->next_unit, idx++)
+    {
+      if (each->arange.high == 0)
+	{
+	  stash->unranged_units[num_unranged].low = 0;
+	  stash->unranged_units[num_unranged].high = 0;
+	  stash->unranged_units[num_unranged].max_high = 0;
+	  stash->unranged_units[num_unranged].idx = idx;
+	  stash->unranged_units[num_unranged].u.unit = each;
+	  num_unranged++;
+	}
+      else
+	for (arange = &each->arange; arange; arange = arange->next)
+	  {
+	    stash->unit_ranges[num_ranges].low = arange->low;
+	    stash->unit_ranges[num_ranges].high = arange->high;
+	    stash->unit_ranges[num_ranges].idx = idx;
+	    stash->unit_ranges[num_ranges].u.unit = each;
+	    num_ranges++;
+	  }
+    }
+
+  sort_addr_range_table (stash->unit_ranges, num_ranges);
+
+  stash->num_unit_ranges = num_ranges;
+  stash->num_unranged_units = num_unranged;
+  stash->unit_ranges_built = TRUE;
+  return TRUE;
+}
+
+/* Compare function for the entries of stash->addr_units.  */
+
+static int
+compare_addr_units (const void *a, const void *b)
+{
+  const struct addr_range_entry *entry1
+    = *(const struct addr_range_entry * const *) a;
+  const struct addr_range_entry *entry2
+    = *(const struct addr_range_entry * const *) b;
+
+  if (entry1->idx < entry2->idx)
+    return -1;
+  if (entry1->idx > entry2->idx)
+    return 1;
+  return 0;
+}
+
+/* Collect in STASH->addr_units the comp units of STASH which may
+   contain ADDR, which are those whose ranges contain ADDR and those
+   without any range.  Returns FALSE if the comp unit range tables are
+   not available, in which case the caller must check every comp unit
+   in turn.  The tables are built the first time we are called after
+   the last comp unit has been read.  */
+
+static bfd_boolean
+stash_find_units_for_address (bfd *abfd, struct dwarf2_debug *stash,
+			      bfd_vma addr)
+{
+  struct addr_range_entry *table;
+  unsigned int count;
+  unsigned int i;
+  unsigned int n;
+
+  if (!stash->unit_ranges_built)
+    {
+      if (stash->info_ptr < stash->info_ptr_end
+	  || !stash_build_unit_ranges (abfd, stash))
+	return FALSE;
+    }
+
+  n = 0;
+  table = stash->unit_ranges;
+  count = stash->num_unit_ranges;
+  for (i = lookup_addr_range_table (table, count, addr);
+       i < count && table[i].low <= addr;
+       i++)
+    if (addr < table[i].high)
+      stash->addr_units[n++] = &table[i];
+  for (i = 0; i < stash->num_unranged_units; i++)
+    stash->addr_units[n++] = &stash->unranged_units[i];
+
+  if (n > 1)
+    {
+      unsigned int j;
+
+      qsort (stash->addr_units, n, sizeof (*stash->addr_units),
+	     compare_addr_units);
+
+      /* A comp unit may have several ranges containing ADDR.  */
+      for (i = 1, j = 1; i < n; i++)
+	if (stash->addr_units[i]->idx != stash->addr_units[j - 1]->idx)
+	  stash->addr_units[j++] = stash->addr_units[i];
+      n = j;
+    }
+
+  stash->num_addr_units = n;
+  return TRUE;
+}
+
 /* Save current section VMAs.  */
 
 static bfd_boolean
@@ -3716,11 +4080,31 @@ find_line (bfd *abfd,
       const char * local_functionname = NULL;
       unsigned int local_linenumber = 0;
       unsigned int local_discriminator = 0;
+      struct comp_unit *next_unit;
+      bfd_boolean use_unit_ranges;
+      unsigned int i = 0;
+
+      /* Once every comp unit has been read, only look at those which
+	 may contain ADDR, rather than checking each of them.  */
+      use_unit_ranges = stash_find_units_for_address (abfd, stash, addr);
+      if (!use_unit_ranges)
+	each = stash->all_comp_units;
+      else if (stash->num_addr_units > 0)
+	each = stash->addr_units[0]->u.unit;
+      else
+	each = NULL;
 
-      for (each = stash->all_comp_units; each; each = each->next_unit)
+      for (; each; each = next_unit)
 	{
 	  bfd_vma range = (bfd_vma) -1;
 
+	  if (!use_unit_ranges)
+	    next_unit = each->next_unit;
+	  else if (++i < stash->num_addr_units)
+	    next_unit = stash->addr_units[i]->u.unit;
+	  else
+	    next_unit = NULL;
+
 	  found = ((each->arange.high == 0
 		    || comp_unit_contains_address (each, addr))
 		   && (range = comp_unit_find_nearest_line (each, addr,
@@ -3738,8 +4122,8 @@ find_line (bfd *abfd,
 		 will tend to result in extra large address ranges rather than
 		 extra small ranges).
 
-		 This does mean that we scan through all of the CUs associated
-		 with the bfd each time this function is called.  But this does
+		 This does mean that we scan through all of the CUs which may
+		 contain ADDR each time this function is called.  But this does
 		 have the benefit of producing consistent results every time the
 		 function is called.  */
 	      if (range <= min_range)
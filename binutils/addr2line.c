@@ -50,6 +50,10 @@ static char **addr;		/* Hex addresses to process.  */
 
 static asymbol **syms;		/* Symbol table.  */
 
+static char stdin_buffer[65536];	/* Addresses read from stdin.  */
+static size_t stdin_buffer_pos;		/* Next unused byte in stdin_buffer.  */
+static size_t stdin_buffer_len;		/* Bytes read into stdin_buffer.  */
+
 static struct option long_options[] =
 {
   {"addresses", no_argument, NULL, 'a'},
@@ -70,6 +74,7 @@ static void usage (FILE *, int);
 static void slurp_symtab (bfd *);
 static void find_address_in_section (bfd *, asection *, void *);
 static void find_offset_in_section (bfd *, asection *);
+static char *read_stdin_line (char *, int);
 static void translate_addresses (bfd *, asection *);
 
 /* Print a usage message to STREAM and exit with STATUS.  */
@@ -203,6 +208,42 @@ find_offset_in_section (bfd *abfd, asection *section)
                                                &line, &discriminator);
 }
 
+/* Read a line of at most SIZE - 1 characters from stdin into BUF, as
+   fgets does.  stdin is read directly, a block at a time, so that we
+   know whether any more input is already waiting to be processed.  */
+
+static char *
+read_stdin_line (char *buf, int size)
+{
+  int n = 0;
+
+  while (n < size - 1)
+    {
+      char c;
+
+      if (stdin_buffer_pos == stdin_buffer_len)
+	{
+	  ssize_t got;
+
+	  got = read (fileno (stdin), stdin_buffer, sizeof stdin_buffer);
+	  if (got <= 0)
+	    break;
+	  stdin_buffer_pos = 0;
+	  stdin_buffer_len = got;
+	}
+
+      c = stdin_buffer[stdin_buffer_pos++];
+      buf[n++] = c;
+      if (c == '\n')
+	break;
+    }
+
+  if (n == 0)
+    return NULL;
+  buf[n] = '\0';
+  return buf;
+}
+
 /* Read hexadecimal addresses from stdin, translate into
    file_name:line_number and optionally function name.  */
 
@@ -217,7 +258,7 @@ translate_addresses (bfd *abfd, asection *section)
 	{
 	  char addr_hex[100];
 
-	  if (fgets (addr_hex, sizeof addr_hex, stdin) == NULL)
+	  if (read_stdin_line (addr_hex, sizeof addr_hex) == NULL)
 	    break;
 	  pc = bfd_scan_vma (addr_hex, NULL, 16);
 	}
@@ -341,8 +382,11 @@ translate_addresses (bfd *abfd, asection *section)
       /* fflush() is essential for using this command as a server
          child process that reads addresses from a pipe and responds
          with line number information, processing one address at a
-         time.  */
-      fflush (stdout);
+         time.  Only flush once every address read so far has been
+         translated though, so that a large batch of addresses does
+         not cost a write for each of them.  */
+      if (!read_stdin || stdin_buffer_pos == stdin_buffer_len)
+	fflush (stdout);
     }
 }
 
@@ -20,6 +20,11 @@
 #ifndef BUILD_ID_H
 #define BUILD_ID_H
 
+/* Locate NT_GNU_BUILD_ID from ABFD and return its content, or NULL
+   if ABFD has no build-id.  */
+
+extern const struct elf_build_id *build_id_bfd_get (bfd *abfd);
+
 /* Return true if ABFD has NT_GNU_BUILD_ID matching the CHECK value.
    Otherwise, issue a warning and return false.  */
 
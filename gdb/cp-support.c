@@ -119,7 +119,7 @@ make_cleanup_cp_demangled_name_parse_free (struct demangle_parse_info *info)
    afterwards.  This speeds up the critical path for alphanumeric
    identifiers.  */
 
-static int
+int
 cp_already_canonical (const char *string)
 {
   /* Identifier start character [a-zA-Z_].  */
@@ -145,6 +145,8 @@ struct using_direct
 
 /* Functions from cp-support.c.  */
 
+extern int cp_already_canonical (const char *string);
+
 extern char *cp_canonicalize_string (const char *string);
 
 extern char *cp_canonicalize_string_no_typedefs (const char *string);
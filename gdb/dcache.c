@@ -82,6 +82,13 @@ static unsigned dcache_size = DCACHE_DEFAULT_SIZE;
 #define DCACHE_DEFAULT_LINE_SIZE 64
 static unsigned dcache_line_size = DCACHE_DEFAULT_LINE_SIZE;
 
+/* The number of lines past the end of a read that are fetched along
+   with it, when they are not cached yet.  Memory such as the stack is
+   usually read in ascending order, so this saves target round trips
+   for the reads that follow.  */
+#define DCACHE_DEFAULT_PREFETCH 4
+static unsigned dcache_prefetch = DCACHE_DEFAULT_PREFETCH;
+
 /* Each cache block holds LINE_SIZE bytes of data
    starting at a multiple-of-LINE_SIZE address.  */
 
@@ -115,6 +122,10 @@ struct dcache_struct
 
   /* The ptid of last inferior to use cache or null_ptid.  */
   ptid_t ptid;
+
+  /* The range a read ahead last failed in.  Reads do not read ahead
+     into it again until the cache is invalidated.  */
+  CORE_ADDR no_prefetch_start, no_prefetch_end;
 };
 
 typedef void (block_func) (struct dcache_block *block, void *param);
@@ -252,6 +263,7 @@ dcache_invalidate (DCACHE *dcache)
   dcache->oldest = NULL;
   dcache->size = 0;
   dcache->ptid = null_ptid;
+  dcache->no_prefetch_start = dcache->no_prefetch_end = 0;
 
   if (dcache->line_size != dcache_line_size)
     {
@@ -388,6 +400,162 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
   return db;
 }
 
+/* Fill the lines of DCACHE from START up to END, both multiples of
+   the line size, reading as few times from the target as it allows.
+   None of the lines may be cached already.  The read stops at the end
+   of the memory region START is in, at the first error, and, once the
+   lines before REQ_END have been read, after the first transfer that
+   comes back short; the lines past REQ_END are only read ahead, and
+   are not worth a round trip of their own.  Return the address just
+   past the last line filled.  The lines from there on are left out of
+   the cache, for dcache_read_line to retry one at a time.  */
+
+static CORE_ADDR
+dcache_read_lines (DCACHE *dcache, CORE_ADDR start, CORE_ADDR end,
+		   CORE_ADDR req_end)
+{
+  struct mem_region *region;
+  struct cleanup *cleanup;
+  gdb_byte *buf;
+  ULONGEST done;
+  CORE_ADDR addr;
+
+  /* Leave anything that crosses into another memory region, or that
+     may not be read, to dcache_read_line.  */
+  region = lookup_mem_region (start);
+  if (region->attrib.mode == MEM_WO)
+    return start;
+  if (region->hi != 0 && end > region->hi)
+    end = start + ((region->hi - start) / dcache->line_size
+		   * dcache->line_size);
+  if (end - start < 2 * dcache->line_size)
+    return start;
+
+  buf = xmalloc (end - start);
+  cleanup = make_cleanup (xfree, buf);
+
+  /* Like target_read, but keep what was read before an error.  */
+  done = 0;
+  while (done < end - start)
+    {
+      ULONGEST xfered_len;
+      enum target_xfer_status status;
+
+      status = target_xfer_partial (current_target.beneath,
+				    TARGET_OBJECT_RAW_MEMORY, NULL,
+				    buf + done, NULL, start + done,
+				    end - start - done, &xfered_len);
+      if (status != TARGET_XFER_OK)
+	break;
+      done += xfered_len;
+      if (start + done >= req_end)
+	break;
+      QUIT;
+    }
+
+  for (addr = start;
+       addr - start + dcache->line_size <= done;
+       addr += dcache->line_size)
+    {
+      struct dcache_block *db = dcache_alloc (dcache, addr);
+
+      memcpy (db->data, buf + (addr - start), dcache->line_size);
+    }
+
+  do_cleanups (cleanup);
+  return addr;
+}
+
+/* Fill the run of missing lines of DCACHE from START up to END as
+   dcache_read_lines does.  REQ_END is the end of the lines the caller
+   actually asked for.  If the read ahead runs off the end of the
+   target's memory, a target that cannot return partial data fails
+   the whole request; retry just the requested part of the run then,
+   rather than leaving each of its lines to a separate
+   dcache_read_line.  Also remember where the read ahead failed, so
+   that the reads which follow do not fail the same way.  */
+
+static void
+dcache_read_run (DCACHE *dcache, CORE_ADDR start, CORE_ADDR end,
+		 CORE_ADDR req_end)
+{
+  CORE_ADDR filled = dcache_read_lines (dcache, start, end, req_end);
+
+  if (end > req_end && filled < end)
+    {
+      dcache->no_prefetch_start = max (filled, req_end);
+      dcache->no_prefetch_end = end;
+    }
+
+  if (end > req_end && filled < req_end)
+    dcache_read_lines (dcache, filled, req_end, req_end);
+}
+
+/* Make sure the lines of DCACHE covering the LEN bytes at MEMADDR
+   are cached, reading each run of consecutive missing lines with a
+   single target read rather than one read per line.  A run that
+   reaches the end of the range is extended by up to dcache_prefetch
+   following lines.  This is only an optimization; lines it fails to
+   read are left to dcache_peek_byte.  */
+
+static void
+dcache_prefetch_lines (DCACHE *dcache, CORE_ADDR memaddr, ULONGEST len)
+{
+  CORE_ADDR addr, end, run_start, req_end;
+  ULONGEST i, nlines, run_lines, max_run_lines;
+
+  /* Never read more lines at once than half the cache holds, so that
+     filling them cannot evict lines of the same read.  */
+  max_run_lines = dcache_size / 2;
+  if (max_run_lines < 2)
+    return;
+
+  addr = MASK (dcache, memaddr);
+  nlines = ((XFORM (dcache, memaddr) + len + dcache->line_size - 1)
+	    / dcache->line_size);
+  req_end = addr + nlines * dcache->line_size;
+
+  run_start = addr;
+  run_lines = 0;
+  for (i = 0; i < nlines + dcache_prefetch; i++, addr += dcache->line_size)
+    {
+      /* Only read ahead when the read itself misses the cache, and
+	 not where reading ahead failed before.  */
+      if (i >= nlines
+	  && (run_lines == 0
+	      || (addr >= dcache->no_prefetch_start
+		  && addr < dcache->no_prefetch_end)))
+	break;
+
+      /* Stop at the end of the address space.  */
+      end = addr + dcache->line_size;
+      if (end == 0)
+	break;
+
+      if (splay_tree_lookup (dcache->tree, (splay_tree_key) addr) != NULL)
+	{
+	  if (run_lines > 1)
+	    dcache_read_run (dcache, run_start, addr, req_end);
+	  run_lines = 0;
+	  continue;
+	}
+
+      if (run_lines == 0)
+	run_start = addr;
+      run_lines++;
+
+      if (run_lines == max_run_lines)
+	{
+	  dcache_read_run (dcache, run_start, end, req_end);
+	  run_lines = 0;
+	}
+    }
+
+  if (run_lines > 1)
+    dcache_read_run (dcache, run_start,
+		     run_start + run_lines * dcache->line_size, req_end);
+}
+
 /* Using the data cache DCACHE, store in *PTR the contents of the byte at
    address ADDR in the remote machine.  
 
@@ -457,6 +625,7 @@ dcache_init (void)
   dcache->size = 0;
   dcache->line_size = dcache_line_size;
   dcache->ptid = null_ptid;
+  dcache->no_prefetch_start = dcache->no_prefetch_end = 0;
 
   return dcache;
 }
@@ -483,6 +652,8 @@ dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
       dcache->ptid = inferior_ptid;
     }
 
+  dcache_prefetch_lines (dcache, memaddr, len);
+
   for (i = 0; i < len; i++)
     {
       if (!dcache_peek_byte (dcache, memaddr + i, myaddr + i))
@@ -734,4 +905,13 @@ Show number of dcache lines."),
 			     set_dcache_size,
 			     NULL,
 			     &dcache_set_list, &dcache_show_list);
+  add_setshow_zuinteger_cmd ("prefetch", class_obscure,
+			     &dcache_prefetch, _("\
+Set number of dcache lines to read ahead of each read."), _("\
+Show number of dcache lines to read ahead of each read."), _("\
+Lines that follow a read and are not cached yet are fetched together\n\
+with it, in the same target request.  Zero disables reading ahead."),
+			     NULL,
+			     NULL,
+			     &dcache_set_list, &dcache_show_list);
 }
@@ -74,6 +74,13 @@
 #include <fcntl.h>
 #include <sys/types.h>
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#ifndef MAP_FAILED
+#define MAP_FAILED ((void *) -1)
+#endif
+#endif
+
 typedef struct symbol *symbolp;
 DEF_VEC_P (symbolp);
 
@@ -91,6 +98,15 @@ static int check_physname = 0;
 /* When non-zero, do not reject deprecated .gdb_index sections.  */
 static int use_deprecated_index_sections = 0;
 
+/* When non-zero, objfiles without a .gdb_index section look for an
+   index in the index cache, and store one there after their partial
+   symbols have been read.  */
+static int index_cache_enabled = 0;
+
+/* The directory holding the index cache.  Cached indices are named
+   after the build-id of the objfile they describe.  */
+static char *index_cache_directory;
+
 static const struct objfile_data *dwarf2_objfile_data_key;
 
 /* The "aclass" indices for various kinds of computed DWARF symbols.  */
@@ -289,6 +305,12 @@ struct dwarf2_per_objfile
   /* The mapped index, or NULL if .gdb_index is missing or not being used.  */
   struct mapped_index *index_table;
 
+  /* If INDEX_TABLE was read from the index cache, the contents of the
+     cache file, their size, and whether they are mmapped.  */
+  gdb_byte *index_cache_buffer;
+  size_t index_cache_size;
+  int index_cache_mapped;
+
   /* When using index_table, this keeps track of all quick_file_names entries.
      TUs typically share line table entries with a CU, so we maintain a
      separate table of all line table entries to support the sharing.
@@ -307,6 +329,12 @@ struct dwarf2_per_objfile
      The mapping is done via (CU/TU + DIE offset) -> type.  */
   htab_t die_type_hash;
 
+  /* Table mapping C++ names to their canonical forms, so that a name
+     which appears in many CUs, such as a template instantiation from
+     a common header, is only parsed once.  The entries are struct
+     canonical_name_entry.  This is NULL if not allocated yet.  */
+  htab_t canonical_names;
+
   /* The CUs we recently read.  */
   VEC (dwarf2_per_cu_ptr) *just_read_cus;
 };
@@ -1800,6 +1828,8 @@ static void queue_comp_unit (struct dwarf2_per_cu_data *per_cu,
 
 static void process_queue (void);
 
+static void index_cache_store (struct objfile *objfile);
+
 static void find_file_and_directory (struct die_info *die,
 				     struct dwarf2_cu *cu,
 				     const char **name, const char **comp_dir);
@@ -2969,44 +2999,32 @@ find_slot_in_mapped_hash (struct mapped_index *index, const char *name,
     }
 }
 
-/* A helper function that reads the .gdb_index from SECTION and fills
-   in MAP.  FILENAME is the name of the file containing the section;
-   it is used for error reporting.  DEPRECATED_OK is nonzero if it is
-   ok to use deprecated sections.
+/* A helper function that reads a .gdb_index from the SIZE bytes at
+   ADDR and fills in MAP.  FILENAME is the name of the file containing
+   the index; it is used for error reporting.  DEPRECATED_OK is
+   nonzero if it is ok to use deprecated sections.
 
    CU_LIST, CU_LIST_ELEMENTS, TYPES_LIST, and TYPES_LIST_ELEMENTS are
    out parameters that are filled in with information about the CU and
-   TU lists in the section.
+   TU lists in the index.
 
    Returns 1 if all went well, 0 otherwise.  */
 
 static int
-read_index_from_section (struct objfile *objfile,
-			 const char *filename,
-			 int deprecated_ok,
-			 struct dwarf2_section_info *section,
-			 struct mapped_index *map,
-			 const gdb_byte **cu_list,
-			 offset_type *cu_list_elements,
-			 const gdb_byte **types_list,
-			 offset_type *types_list_elements)
+read_index_from_buffer (const char *filename,
+			int deprecated_ok,
+			const gdb_byte *addr,
+			offset_type size,
+			struct mapped_index *map,
+			const gdb_byte **cu_list,
+			offset_type *cu_list_elements,
+			const gdb_byte **types_list,
+			offset_type *types_list_elements)
 {
-  const gdb_byte *addr;
   offset_type version;
   offset_type *metadata;
   int i;
 
-  if (dwarf2_section_empty_p (section))
-    return 0;
-
-  /* Older elfutils strip versions could keep the section in the main
-     executable while splitting it for the separate debug info file.  */
-  if ((get_section_flags (section) & SEC_HAS_CONTENTS) == 0)
-    return 0;
-
-  dwarf2_read_section (objfile, section);
-
-  addr = section->buffer;
   /* Version check.  */
   version = MAYBE_SWAP (*(offset_type *) addr);
   /* Versions earlier than 3 emitted every copy of a psymbol.  This
@@ -3060,7 +3078,7 @@ to use the section anyway."),
     return 0;
 
   map->version = version;
-  map->total_size = section->size;
+  map->total_size = size;
 
   metadata = (offset_type *) (addr + sizeof (offset_type));
 
@@ -3092,27 +3110,57 @@ to use the section anyway."),
   return 1;
 }
 
-
-/* Read the index file.  If everything went ok, initialize the "quick"
-   elements of all the CUs and return 1.  Otherwise, return 0.  */
+/* A helper function that reads the .gdb_index from SECTION and fills
+   in MAP.  The arguments are as for read_index_from_buffer.  */
 
 static int
-dwarf2_read_index (struct objfile *objfile)
+read_index_from_section (struct objfile *objfile,
+			 const char *filename,
+			 int deprecated_ok,
+			 struct dwarf2_section_info *section,
+			 struct mapped_index *map,
+			 const gdb_byte **cu_list,
+			 offset_type *cu_list_elements,
+			 const gdb_byte **types_list,
+			 offset_type *types_list_elements)
 {
-  struct mapped_index local_map, *map;
-  const gdb_byte *cu_list, *types_list, *dwz_list = NULL;
-  offset_type cu_list_elements, types_list_elements, dwz_list_elements = 0;
-  struct dwz_file *dwz;
+  if (dwarf2_section_empty_p (section))
+    return 0;
 
-  if (!read_index_from_section (objfile, objfile_name (objfile),
-				use_deprecated_index_sections,
-				&dwarf2_per_objfile->gdb_index, &local_map,
-				&cu_list, &cu_list_elements,
-				&types_list, &types_list_elements))
+  /* Older elfutils strip versions could keep the section in the main
+     executable while splitting it for the separate debug info file.  */
+  if ((get_section_flags (section) & SEC_HAS_CONTENTS) == 0)
     return 0;
 
+  dwarf2_read_section (objfile, section);
+
+  return read_index_from_buffer (filename, deprecated_ok,
+				 section->buffer, section->size, map,
+				 cu_list, cu_list_elements,
+				 types_list, types_list_elements);
+}
+
+
+/* Start using the index LOCAL_MAP for OBJFILE.  CU_LIST,
+   CU_LIST_ELEMENTS, TYPES_LIST and TYPES_LIST_ELEMENTS are as filled
+   in by read_index_from_buffer.  If everything went ok, initialize
+   the "quick" elements of all the CUs and return 1.  Otherwise,
+   return 0.  */
+
+static int
+dwarf2_use_index (struct objfile *objfile,
+		  struct mapped_index *local_map,
+		  const gdb_byte *cu_list, offset_type cu_list_elements,
+		  const gdb_byte *types_list,
+		  offset_type types_list_elements)
+{
+  struct mapped_index *map;
+  const gdb_byte *dwz_list = NULL;
+  offset_type dwz_list_elements = 0;
+  struct dwz_file *dwz;
+
   /* Don't use the index if it's empty.  */
-  if (local_map.symbol_table_slots == 0)
+  if (local_map->symbol_table_slots == 0)
     return 0;
 
   /* If there is a .dwz file, read it so we can get its CU list as
@@ -3156,10 +3204,10 @@ dwarf2_read_index (struct objfile *objfile)
 					       types_list_elements);
     }
 
-  create_addrmap_from_index (objfile, &local_map);
+  create_addrmap_from_index (objfile, local_map);
 
   map = obstack_alloc (&objfile->objfile_obstack, sizeof (struct mapped_index));
-  *map = local_map;
+  *map = *local_map;
 
   dwarf2_per_objfile->index_table = map;
   dwarf2_per_objfile->using_index = 1;
@@ -3169,6 +3217,287 @@ dwarf2_read_index (struct objfile *objfile)
   return 1;
 }
 
+/* Read the index file.  If everything went ok, initialize the "quick"
+   elements of all the CUs and return 1.  Otherwise, return 0.  */
+
+static int
+dwarf2_read_index (struct objfile *objfile)
+{
+  struct mapped_index local_map;
+  const gdb_byte *cu_list, *types_list;
+  offset_type cu_list_elements, types_list_elements;
+
+  if (!read_index_from_section (objfile, objfile_name (objfile),
+				use_deprecated_index_sections,
+				&dwarf2_per_objfile->gdb_index, &local_map,
+				&cu_list, &cu_list_elements,
+				&types_list, &types_list_elements))
+    return 0;
+
+  return dwarf2_use_index (objfile, &local_map, cu_list, cu_list_elements,
+			   types_list, types_list_elements);
+}
+
+/* Return the name of the index cache file for OBJFILE, or NULL if
+   OBJFILE has no build-id or there is no cache directory.  The result
+   is malloc'd.  */
+
+static char *
+index_cache_file_name (struct objfile *objfile)
+{
+  const struct elf_build_id *build_id;
+  char *hex;
+  size_t i;
+
+  if (index_cache_directory == NULL || *index_cache_directory == '\0')
+    return NULL;
+
+  build_id = build_id_bfd_get (objfile->obfd);
+  if (build_id == NULL)
+    return NULL;
+
+  hex = alloca (2 * build_id->size + 1);
+  for (i = 0; i < build_id->size; ++i)
+    xsnprintf (&hex[2 * i], 3, "%02x", build_id->data[i]);
+  hex[2 * build_id->size] = '\0';
+
+  return concat (index_cache_directory, SLASH_STRING, hex, INDEX_SUFFIX,
+		 (char *) NULL);
+}
+
+/* Release the index cache file contents held by DATA, if any.  */
+
+static void
+index_cache_release (struct dwarf2_per_objfile *data)
+{
+  if (data->index_cache_buffer == NULL)
+    return;
+
+#ifdef HAVE_MMAP
+  if (data->index_cache_mapped)
+    {
+      int res;
+
+      res = munmap (data->index_cache_buffer, data->index_cache_size);
+      gdb_assert (res == 0);
+    }
+  else
+#endif
+    xfree (data->index_cache_buffer);
+
+  data->index_cache_buffer = NULL;
+  data->index_cache_size = 0;
+  data->index_cache_mapped = 0;
+}
+
+/* Return 1 if the index in the cache file BUFFER, which has been
+   parsed into MAP, CU_LIST, CU_LIST_ELEMENTS, TYPES_LIST and
+   TYPES_LIST_ELEMENTS, can be used without reading outside of the
+   file or of the debug sections of OBJFILE.  An index in an objfile is trusted
+   as much as the rest of its debug info, but a cache file may be
+   stale or damaged, so check every offset and CU index in it.  */
+
+static int
+index_cache_contents_valid_p (struct objfile *objfile,
+			      const gdb_byte *buffer,
+			      const struct mapped_index *map,
+			      const gdb_byte *cu_list,
+			      offset_type cu_list_elements,
+			      const gdb_byte *types_list,
+			      offset_type types_list_elements)
+{
+  bfd_size_type info_size, types_size = 0;
+  offset_type n_units, pool_size, i, empty_slots;
+
+  if (cu_list_elements % 2 != 0
+      || types_list_elements % 3 != 0
+      || map->address_table_size % 20 != 0)
+    return 0;
+
+  info_size = dwarf2_section_size (objfile, &dwarf2_per_objfile->info);
+  for (i = 0; i < cu_list_elements; i += 2)
+    {
+      ULONGEST offset, length;
+
+      offset = extract_unsigned_integer (cu_list + i * 8, 8,
+					 BFD_ENDIAN_LITTLE);
+      length = extract_unsigned_integer (cu_list + i * 8 + 8, 8,
+					 BFD_ENDIAN_LITTLE);
+      if (offset >= info_size || length > info_size - offset)
+	return 0;
+    }
+
+  if (types_list_elements != 0)
+    {
+      if (VEC_length (dwarf2_section_info_def, dwarf2_per_objfile->types) != 1)
+	return 0;
+      types_size = dwarf2_section_size (objfile,
+					VEC_index (dwarf2_section_info_def,
+						   dwarf2_per_objfile->types,
+						   0));
+    }
+  for (i = 0; i < types_list_elements; i += 3)
+    {
+      ULONGEST offset;
+
+      offset = extract_unsigned_integer (types_list + i * 8, 8,
+					 BFD_ENDIAN_LITTLE);
+      if (offset >= types_size)
+	return 0;
+    }
+
+  /* The symbol table is probed with a mask, and a lookup only stops
+     at a match or at an empty slot.  */
+  if (map->symbol_table_slots == 0
+      || (map->symbol_table_slots & (map->symbol_table_slots - 1)) != 0)
+    return 0;
+
+  n_units = cu_list_elements / 2 + types_list_elements / 3;
+  pool_size = map->total_size - ((const gdb_byte *) map->constant_pool
+				 - buffer);
+  empty_slots = 0;
+  for (i = 0; i < map->symbol_table_slots; ++i)
+    {
+      offset_type name_offset = MAYBE_SWAP (map->symbol_table[2 * i]);
+      offset_type vec_offset = MAYBE_SWAP (map->symbol_table[2 * i + 1]);
+      const offset_type *vec;
+      offset_type vec_len, vec_idx;
+
+      if (name_offset == 0 && vec_offset == 0)
+	{
+	  ++empty_slots;
+	  continue;
+	}
+
+      if (name_offset >= pool_size
+	  || memchr (map->constant_pool + name_offset, '\0',
+		     pool_size - name_offset) == NULL)
+	return 0;
+
+      if (pool_size < sizeof (offset_type)
+	  || vec_offset > pool_size - sizeof (offset_type))
+	return 0;
+      vec = (const offset_type *) (map->constant_pool + vec_offset);
+      vec_len = MAYBE_SWAP (vec[0]);
+      if (vec_len > ((pool_size - vec_offset) / sizeof (offset_type)) - 1)
+	return 0;
+
+      for (vec_idx = 0; vec_idx < vec_len; ++vec_idx)
+	{
+	  offset_type cu_index_and_attrs = MAYBE_SWAP (vec[vec_idx + 1]);
+
+	  if (GDB_INDEX_CU_VALUE (cu_index_and_attrs) >= n_units)
+	    return 0;
+	}
+    }
+
+  return empty_slots != 0;
+}
+
+/* Read the index for OBJFILE from the index cache.  If everything
+   went ok, initialize the "quick" elements of all the CUs and return
+   1.  Otherwise, return 0.  */
+
+static int
+dwarf2_read_index_cache (struct objfile *objfile)
+{
+  struct mapped_index local_map;
+  const gdb_byte *cu_list, *types_list;
+  offset_type cu_list_elements, types_list_elements;
+  offset_type *metadata, prev;
+  struct cleanup *cleanup;
+  char *filename;
+  struct stat st;
+  int fd, i;
+
+  if (!index_cache_enabled)
+    return 0;
+
+  /* Indices written by write_psymtabs_to_index do not keep the CUs of
+     a .dwz file apart from the others, so they cannot be used here.  */
+  if (dwarf2_get_dwz_file () != NULL)
+    return 0;
+
+  filename = index_cache_file_name (objfile);
+  if (filename == NULL)
+    return 0;
+  cleanup = make_cleanup (xfree, filename);
+
+  fd = gdb_open_cloexec (filename, O_RDONLY | O_BINARY, 0);
+  if (fd < 0)
+    {
+      do_cleanups (cleanup);
+      return 0;
+    }
+  make_cleanup_close (fd);
+
+  if (fstat (fd, &st) < 0
+      || st.st_size < 6 * sizeof (offset_type)
+      || st.st_size > (offset_type) -1)
+    {
+      do_cleanups (cleanup);
+      return 0;
+    }
+
+  dwarf2_per_objfile->index_cache_size = st.st_size;
+#ifdef HAVE_MMAP
+  dwarf2_per_objfile->index_cache_buffer
+    = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (dwarf2_per_objfile->index_cache_buffer != MAP_FAILED)
+    dwarf2_per_objfile->index_cache_mapped = 1;
+  else
+#endif
+    {
+      dwarf2_per_objfile->index_cache_buffer = xmalloc (st.st_size);
+      if (read (fd, dwarf2_per_objfile->index_cache_buffer, st.st_size)
+	  != st.st_size)
+	{
+	  index_cache_release (dwarf2_per_objfile);
+	  do_cleanups (cleanup);
+	  return 0;
+	}
+    }
+
+  /* The file may have been truncated or damaged; make sure the
+     offsets in its header stay within it.  */
+  metadata = (offset_type *) dwarf2_per_objfile->index_cache_buffer;
+  prev = 6 * sizeof (offset_type);
+  for (i = 1; i < 6; ++i)
+    {
+      offset_type offset = MAYBE_SWAP (metadata[i]);
+
+      if (offset < prev || offset > st.st_size)
+	break;
+      prev = offset;
+    }
+
+  if (i < 6
+      || !read_index_from_buffer (filename, 0,
+				  dwarf2_per_objfile->index_cache_buffer,
+				  st.st_size, &local_map,
+				  &cu_list, &cu_list_elements,
+				  &types_list, &types_list_elements)
+      || !index_cache_contents_valid_p (objfile,
+					dwarf2_per_objfile->index_cache_buffer,
+					&local_map,
+					cu_list, cu_list_elements,
+					types_list, types_list_elements)
+      || !dwarf2_use_index (objfile, &local_map, cu_list, cu_list_elements,
+			    types_list, types_list_elements))
+    {
+      index_cache_release (dwarf2_per_objfile);
+      do_cleanups (cleanup);
+      return 0;
+    }
+
+  if (dwarf2_read_debug)
+    fprintf_unfiltered (gdb_stdlog, "Read index for %s from %s\n",
+			objfile_name (objfile), filename);
+
+  do_cleanups (cleanup);
+  return 1;
+}
+
 /* A helper for the "quick" functions which sets the global
    dwarf2_per_objfile according to OBJFILE.  */
 
@@ -4144,6 +4473,9 @@ dwarf2_initialize_objfile (struct objfile *objfile)
   if (dwarf2_read_index (objfile))
     return 1;
 
+  if (dwarf2_read_index_cache (objfile))
+    return 1;
+
   return 0;
 }
 
@@ -4173,6 +4505,8 @@ dwarf2_build_psymtabs (struct objfile *objfile)
     }
   if (except.reason < 0)
     exception_print (gdb_stderr, except);
+  else
+    index_cache_store (objfile);
 }
 
 /* Return the total length of the CU described by HEADER.  */
@@ -18973,20 +19307,87 @@ sibling_die (struct die_info *die)
   return die->sibling;
 }
 
+/* An entry in dwarf2_per_objfile->canonical_names.  */
+
+struct canonical_name_entry
+{
+  /* The name as it appears in the DWARF.  */
+  const char *name;
+
+  /* Its canonical form, or NULL if NAME is already canonical.  */
+  const char *canonical;
+};
+
+/* Hash function for dwarf2_per_objfile->canonical_names.  */
+
+static hashval_t
+hash_canonical_name_entry (const void *item)
+{
+  const struct canonical_name_entry *entry = item;
+
+  return htab_hash_string (entry->name);
+}
+
+/* Equality function for dwarf2_per_objfile->canonical_names.  */
+
+static int
+eq_canonical_name_entry (const void *item_lhs, const void *item_rhs)
+{
+  const struct canonical_name_entry *lhs = item_lhs;
+  const struct canonical_name_entry *rhs = item_rhs;
+
+  return strcmp (lhs->name, rhs->name) == 0;
+}
+
 /* Get name of a die, return NULL if not found.  */
 
 static const char *
 dwarf2_canonicalize_name (const char *name, struct dwarf2_cu *cu,
 			  struct obstack *obstack)
 {
-  if (name && cu->language == language_cplus)
+  if (name && cu->language == language_cplus && !cp_already_canonical (name))
     {
-      char *canon_name = cp_canonicalize_string (name);
+      struct objfile *objfile = cu->objfile;
+      struct canonical_name_entry find_entry, *entry;
+      void **slot;
+      char *canon_name;
+
+      /* Parsing a name is slow, and the same names turn up in many
+	 CUs, so remember the result for each name we parse.  */
+      if (dwarf2_per_objfile->canonical_names == NULL)
+	dwarf2_per_objfile->canonical_names
+	  = htab_create_alloc_ex (127,
+				  hash_canonical_name_entry,
+				  eq_canonical_name_entry,
+				  NULL,
+				  &objfile->objfile_obstack,
+				  hashtab_obstack_allocate,
+				  dummy_obstack_deallocate);
+
+      find_entry.name = name;
+      slot = htab_find_slot (dwarf2_per_objfile->canonical_names,
+			     &find_entry, INSERT);
+      if (*slot != NULL)
+	{
+	  entry = *slot;
+	  return entry->canonical != NULL ? entry->canonical : name;
+	}
+
+      /* NAME may be a temporary string, so the table needs a copy.  */
+      entry = OBSTACK_ZALLOC (&objfile->objfile_obstack,
+			      struct canonical_name_entry);
+      entry->name = obstack_copy0 (&objfile->objfile_obstack, name,
+				   strlen (name));
+      *slot = entry;
 
+      canon_name = cp_canonicalize_string (name);
       if (canon_name != NULL)
 	{
 	  if (strcmp (canon_name, name) != 0)
-	    name = obstack_copy0 (obstack, canon_name, strlen (canon_name));
+	    {
+	      name = obstack_copy0 (obstack, canon_name, strlen (canon_name));
+	      entry->canonical = name;
+	    }
 	  xfree (canon_name);
 	}
     }
@@ -22006,6 +22407,8 @@ dwarf2_per_objfile_free (struct objfile *objfile, void *d)
 
   if (data->dwz_file && data->dwz_file->dwz_bfd)
     gdb_bfd_unref (data->dwz_file->dwz_bfd);
+
+  index_cache_release (data);
 }
 
 
@@ -22684,20 +23087,19 @@ recursively_write_psymbols (struct objfile *objfile,
 		  1);
 }
 
-/* Create an index file for OBJFILE in the directory DIR.  */
+/* Write an index file for OBJFILE to FILENAME.  */
 
 static void
-write_psymtabs_to_index (struct objfile *objfile, const char *dir)
+write_psymtabs_to_index_file (struct objfile *objfile, const char *filename)
 {
   struct cleanup *cleanup;
-  char *filename, *cleanup_filename;
+  const char *cleanup_filename;
   struct obstack contents, addr_obstack, constant_pool, symtab_obstack;
   struct obstack cu_list, types_cu_list;
   int i;
   FILE *out_file;
   struct mapped_symtab *symtab;
   offset_type val, size_of_contents, total_len;
-  struct stat st;
   htab_t psyms_seen;
   htab_t cu_index_htab;
   struct psymtab_cu_index_map *psymtab_cu_index_map;
@@ -22711,19 +23113,12 @@ write_psymtabs_to_index (struct objfile *objfile, const char *dir)
   if (!objfile->psymtabs || !objfile->psymtabs_addrmap)
     return;
 
-  if (stat (objfile_name (objfile), &st) < 0)
-    perror_with_name (objfile_name (objfile));
-
-  filename = concat (dir, SLASH_STRING, lbasename (objfile_name (objfile)),
-		     INDEX_SUFFIX, (char *) NULL);
-  cleanup = make_cleanup (xfree, filename);
-
   out_file = gdb_fopen_cloexec (filename, "wb");
   if (!out_file)
     error (_("Can't open `%s' for writing"), filename);
 
   cleanup_filename = filename;
-  make_cleanup (unlink_if_set, &cleanup_filename);
+  cleanup = make_cleanup (unlink_if_set, &cleanup_filename);
 
   symtab = create_mapped_symtab ();
   make_cleanup (cleanup_mapped_symtab, symtab);
@@ -22870,6 +23265,128 @@ write_psymtabs_to_index (struct objfile *objfile, const char *dir)
   do_cleanups (cleanup);
 }
 
+/* Create an index file for OBJFILE in the directory DIR.  */
+
+static void
+write_psymtabs_to_index (struct objfile *objfile, const char *dir)
+{
+  struct cleanup *cleanup;
+  char *filename;
+  struct stat st;
+
+  if (stat (objfile_name (objfile), &st) < 0)
+    perror_with_name (objfile_name (objfile));
+
+  filename = concat (dir, SLASH_STRING, lbasename (objfile_name (objfile)),
+		     INDEX_SUFFIX, (char *) NULL);
+  cleanup = make_cleanup (xfree, filename);
+
+  write_psymtabs_to_index_file (objfile, filename);
+
+  do_cleanups (cleanup);
+}
+
+#ifdef USE_WIN32API
+#undef mkdir
+#define mkdir(pathname, mode) mkdir (pathname)
+#endif
+
+/* Create the directory DIR and any missing parents of it.  Throw an
+   error on failure.  */
+
+static void
+make_directory_with_parents (const char *dir)
+{
+  char *copy = xstrdup (dir);
+  struct cleanup *cleanup = make_cleanup (xfree, copy);
+  char *p;
+
+  for (p = copy + 1; ; ++p)
+    {
+      if (*p != '\0' && !IS_DIR_SEPARATOR (*p))
+	continue;
+
+      if (!IS_DIR_SEPARATOR (p[-1]))
+	{
+	  char c = *p;
+
+	  *p = '\0';
+	  if (mkdir (copy, S_IRWXU) < 0 && errno != EEXIST)
+	    perror_with_name (copy);
+	  *p = c;
+	}
+
+      if (*p == '\0')
+	break;
+    }
+
+  do_cleanups (cleanup);
+}
+
+/* Store the index for OBJFILE in the index cache, unless the cache is
+   disabled or already has it.  The index is written to a temporary
+   file which is then renamed, so that other GDB processes using the
+   same cache never see a partial index.  Failures are not reported
+   except when "set debug dwarf2-read" is on, as the cache is only an
+   optimization.  */
+
+static void
+index_cache_store (struct objfile *objfile)
+{
+  volatile struct gdb_exception except;
+  struct cleanup *cleanup;
+  char *filename, *tmpname;
+  struct stat st;
+
+  if (!index_cache_enabled
+      || dwarf2_per_objfile->using_index
+      || !objfile->psymtabs || !objfile->psymtabs_addrmap)
+    return;
+
+  filename = index_cache_file_name (objfile);
+  if (filename == NULL)
+    return;
+  cleanup = make_cleanup (xfree, filename);
+
+  if (stat (filename, &st) == 0)
+    {
+      do_cleanups (cleanup);
+      return;
+    }
+
+  tmpname = xstrprintf ("%s.%ld.tmp", filename, (long) getpid ());
+  make_cleanup (xfree, tmpname);
+
+  TRY_CATCH (except, RETURN_MASK_ERROR)
+    {
+      /* See dwarf2_read_index_cache.  */
+      if (dwarf2_get_dwz_file () != NULL)
+	error (_("Cannot cache the index of a file using a .dwz file"));
+
+      make_directory_with_parents (index_cache_directory);
+
+      if (dwarf2_read_debug)
+	fprintf_unfiltered (gdb_stdlog, "Writing index for %s to %s\n",
+			    objfile_name (objfile), filename);
+
+      write_psymtabs_to_index_file (objfile, tmpname);
+      if (rename (tmpname, filename) < 0)
+	{
+	  int save_errno = errno;
+
+	  unlink (tmpname);
+	  errno = save_errno;
+	  perror_with_name (filename);
+	}
+    }
+  if (except.reason < 0 && dwarf2_read_debug)
+    exception_fprintf (gdb_stdlog, except,
+		       _("Error while writing index cache for `%s': "),
+		       objfile_name (objfile));
+
+  do_cleanups (cleanup);
+}
+
 /* Implementation of the `save gdb-index' command.
    
    Note that the file format used by this command is documented in the
@@ -22931,12 +23448,28 @@ show_check_physname (struct ui_file *file, int from_tty,
 		    value);
 }
 
+static void
+show_index_cache_enabled (struct ui_file *file, int from_tty,
+			  struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Use of the index cache is %s.\n"), value);
+}
+
+static void
+show_index_cache_directory (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("The index cache directory is \"%s\".\n"),
+		    value);
+}
+
 void _initialize_dwarf2_read (void);
 
 void
 _initialize_dwarf2_read (void)
 {
   struct cmd_list_element *c;
+  const char *cache_home, *home;
 
   dwarf2_objfile_data_key
     = register_objfile_data_with_cleanup (NULL, dwarf2_per_objfile_free);
@@ -23016,6 +23549,38 @@ Warning: This option must be enabled before gdb reads the file."),
 			   NULL,
 			   &setlist, &showlist);
 
+  add_setshow_boolean_cmd ("index-cache", class_files,
+			   &index_cache_enabled, _("\
+Set whether to use the index cache."), _("\
+Show whether to use the index cache."), _("\
+When enabled, GDB looks up an index for files without a .gdb_index\n\
+section in the index cache directory, using their build-id.  If none is\n\
+found, GDB writes one there once the file's partial symbols are read,\n\
+so that later sessions can skip reading them."),
+			   NULL,
+			   show_index_cache_enabled,
+			   &setlist, &showlist);
+
+  add_setshow_filename_cmd ("index-cache-directory", class_files,
+			    &index_cache_directory, _("\
+Set the directory of the index cache."), _("\
+Show the directory of the index cache."), _("\
+Indices are stored in this directory when \"set index-cache\" is on."),
+			    NULL,
+			    show_index_cache_directory,
+			    &setlist, &showlist);
+
+  cache_home = getenv ("XDG_CACHE_HOME");
+  home = getenv ("HOME");
+  if (cache_home != NULL && *cache_home != '\0')
+    index_cache_directory = concat (cache_home, SLASH_STRING, "gdb",
+				    (char *) NULL);
+  else if (home != NULL && *home != '\0')
+    index_cache_directory = concat (home, SLASH_STRING, ".cache",
+				    SLASH_STRING, "gdb", (char *) NULL);
+  else
+    index_cache_directory = xstrdup ("");
+
   c = add_cmd ("gdb-index", class_files, save_gdb_index_command,
 	       _("\
 Save a gdb-index file.\n\
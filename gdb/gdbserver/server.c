@@ -741,6 +741,40 @@ gdb_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
     return -1;
 }
 
+/* Read as much as possible of the LEN bytes of trace frame or
+   inferior memory at MEMADDR into MYADDR, stopping at the first byte
+   that cannot be read.  Return the number of bytes read, or -1 if the
+   first byte cannot be read.  GDB reads ahead of what it needs, and
+   that may run past the end of a mapping; answering with the part
+   that could be read saves it a second request.  */
+
+static int
+gdb_read_memory_prefix (CORE_ADDR memaddr, unsigned char *myaddr, int len)
+{
+  int readable, unreadable;
+
+  readable = gdb_read_memory (memaddr, myaddr, len);
+  if (readable >= 0)
+    return readable;
+
+  /* Bisect for the end of the readable part.  The first READABLE
+     bytes are in MYADDR; reading the first UNREADABLE bytes fails.  */
+  readable = 0;
+  unreadable = len;
+  while (unreadable - readable > 1)
+    {
+      int mid = readable + (unreadable - readable) / 2;
+
+      if (gdb_read_memory (memaddr + readable, myaddr + readable,
+			   mid - readable) == mid - readable)
+	readable = mid;
+      else
+	unreadable = mid;
+    }
+
+  return readable > 0 ? readable : -1;
+}
+
 /* Write trace frame or inferior memory.  Actually, writing to trace
    frames is forbidden.  */
 
@@ -1897,6 +1931,11 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       if (transport_is_reliable)
 	strcat (own_buf, ";QStartNoAckMode+");
 
+      /* Packets that arrive while one is being handled are buffered
+	 and handled in turn, so GDB may send several memory reads
+	 before waiting for their replies.  */
+      strcat (own_buf, ";binary-upload+;memory-read-pipelining+");
+
       if (the_target->qxfer_osdata != NULL)
 	strcat (own_buf, ";qXfer:osdata:read+");
 
@@ -3683,6 +3722,27 @@ process_serial_event (void)
       else
 	bin2hex (mem_buf, own_buf, res);
       break;
+    case 'x':
+      require_running (own_buf);
+      decode_m_packet (&own_buf[1], &mem_addr, &len);
+      if (len > PBUFSIZ - 1)
+	len = PBUFSIZ - 1;
+      res = gdb_read_memory_prefix (mem_addr, mem_buf, len);
+      if (res < 0)
+	write_enn (own_buf);
+      else
+	{
+	  int out_len;
+
+	  /* Reply with "b" and as much of the memory as fits once
+	     escaped; GDB asks for the rest in another request.  */
+	  own_buf[0] = 'b';
+	  new_packet_len
+	    = 1 + remote_escape_output (mem_buf, res,
+					(gdb_byte *) own_buf + 1,
+					&out_len, PBUFSIZ - 2);
+	}
+      break;
     case 'M':
       require_running (own_buf);
       decode_M_packet (&own_buf[1], &mem_addr, &len, &mem_buf);
@@ -108,37 +108,98 @@ msymbol_hash (const char *string)
   return hash;
 }
 
-/* Add the minimal symbol SYM to an objfile's minsym hash table, TABLE.  */
+/* Add the minimal symbol SYM to an objfile's minsym hash table, TABLE,
+   which has SIZE buckets.  */
 static void
 add_minsym_to_hash_table (struct minimal_symbol *sym,
-			  struct minimal_symbol **table)
+			  struct minimal_symbol **table, unsigned int size)
 {
   if (sym->hash_next == NULL)
     {
-      unsigned int hash
-	= msymbol_hash (MSYMBOL_LINKAGE_NAME (sym)) % MINIMAL_SYMBOL_HASH_SIZE;
+      unsigned int hash;
 
+      sym->hash = msymbol_hash (MSYMBOL_LINKAGE_NAME (sym));
+      hash = sym->hash % size;
       sym->hash_next = table[hash];
       table[hash] = sym;
     }
 }
 
 /* Add the minimal symbol SYM to an objfile's minsym demangled hash table,
-   TABLE.  */
+   TABLE, which has SIZE buckets.  */
 static void
 add_minsym_to_demangled_hash_table (struct minimal_symbol *sym,
-                                  struct minimal_symbol **table)
+                                  struct minimal_symbol **table,
+				  unsigned int size)
 {
   if (sym->demangled_hash_next == NULL)
     {
-      unsigned int hash = msymbol_hash_iw (MSYMBOL_SEARCH_NAME (sym))
-	% MINIMAL_SYMBOL_HASH_SIZE;
+      unsigned int hash;
 
+      sym->demangled_hash = msymbol_hash_iw (MSYMBOL_SEARCH_NAME (sym));
+      hash = sym->demangled_hash % size;
       sym->demangled_hash_next = table[hash];
       table[hash] = sym;
     }
 }
 
+/* Build the demangled name hash table of PER_BFD.  This is deferred
+   until a lookup first needs it, since many sessions never look up a
+   minimal symbol by its demangled name.  */
+
+static void
+build_minimal_symbol_demangled_hash_table
+  (struct objfile_per_bfd_storage *per_bfd)
+{
+  int i;
+  struct minimal_symbol *msym;
+
+  per_bfd->msymbol_demangled_hash
+    = OBSTACK_CALLOC (&per_bfd->storage_obstack, per_bfd->msymbol_hash_size,
+		      struct minimal_symbol *);
+
+  for ((i = per_bfd->minimal_symbol_count, msym = per_bfd->msymbols);
+       i > 0;
+       i--, msym++)
+    {
+      msym->demangled_hash_next = 0;
+      if (MSYMBOL_SEARCH_NAME (msym) != MSYMBOL_LINKAGE_NAME (msym))
+	add_minsym_to_demangled_hash_table (msym,
+					    per_bfd->msymbol_demangled_hash,
+					    per_bfd->msymbol_hash_size);
+    }
+}
+
+/* Return the first minimal symbol of PER_BFD on the hash chain for
+   the linkage name hash HASH, as computed by msymbol_hash.  */
+
+static struct minimal_symbol *
+msymbol_hash_chain (struct objfile_per_bfd_storage *per_bfd,
+		    unsigned int hash)
+{
+  if (per_bfd->msymbol_hash == NULL)
+    return NULL;
+
+  return per_bfd->msymbol_hash[hash % per_bfd->msymbol_hash_size];
+}
+
+/* Return the first minimal symbol of PER_BFD on the hash chain for
+   the demangled name hash HASH, as computed by msymbol_hash_iw.  The
+   demangled hash table is built if needed.  */
+
+static struct minimal_symbol *
+msymbol_demangled_hash_chain (struct objfile_per_bfd_storage *per_bfd,
+			      unsigned int hash)
+{
+  if (per_bfd->msymbol_hash == NULL)
+    return NULL;
+
+  if (per_bfd->msymbol_demangled_hash == NULL)
+    build_minimal_symbol_demangled_hash_table (per_bfd);
+
+  return per_bfd->msymbol_demangled_hash[hash % per_bfd->msymbol_hash_size];
+}
+
 /* Look through all the current minimal symbol tables and find the
    first minimal symbol that matches NAME.  If OBJF is non-NULL, limit
    the search to that objfile.  If SFILE is non-NULL, the only file-scope
@@ -168,8 +229,8 @@ lookup_minimal_symbol (const char *name, const char *sfile,
   struct bound_minimal_symbol found_file_symbol = { NULL, NULL };
   struct bound_minimal_symbol trampoline_symbol = { NULL, NULL };
 
-  unsigned int hash = msymbol_hash (name) % MINIMAL_SYMBOL_HASH_SIZE;
-  unsigned int dem_hash = msymbol_hash_iw (name) % MINIMAL_SYMBOL_HASH_SIZE;
+  unsigned int hash;
+  unsigned int dem_hash;
 
   int needtofreename = 0;
   const char *modified_name;
@@ -190,6 +251,11 @@ lookup_minimal_symbol (const char *name, const char *sfile,
 	}
     }
 
+  /* Hash the name we compare against, so that the full hash codes
+     stored in the symbols can be checked before the names.  */
+  hash = msymbol_hash (modified_name);
+  dem_hash = msymbol_hash_iw (modified_name);
+
   for (objfile = object_files;
        objfile != NULL && found_symbol.minsym == NULL;
        objfile = objfile->next)
@@ -207,9 +273,10 @@ lookup_minimal_symbol (const char *name, const char *sfile,
 	    {
             /* Select hash list according to pass.  */
             if (pass == 1)
-              msymbol = objfile->per_bfd->msymbol_hash[hash];
+              msymbol = msymbol_hash_chain (objfile->per_bfd, hash);
             else
-              msymbol = objfile->per_bfd->msymbol_demangled_hash[dem_hash];
+              msymbol = msymbol_demangled_hash_chain (objfile->per_bfd,
+						      dem_hash);
 
             while (msymbol != NULL && found_symbol.minsym == NULL)
 		{
@@ -221,14 +288,16 @@ lookup_minimal_symbol (const char *name, const char *sfile,
 
 		      cmp = (case_sensitivity == case_sensitive_on
 		             ? strcmp : strcasecmp);
-		      match = cmp (MSYMBOL_LINKAGE_NAME (msymbol),
-				   modified_name) == 0;
+		      match = (msymbol->hash == hash
+			       && cmp (MSYMBOL_LINKAGE_NAME (msymbol),
+				       modified_name) == 0);
 		    }
 		  else
 		    {
 		      /* The function respects CASE_SENSITIVITY.  */
-		      match = MSYMBOL_MATCHES_SEARCH_NAME (msymbol,
-							  modified_name);
+		      match = (msymbol->demangled_hash == dem_hash
+			       && MSYMBOL_MATCHES_SEARCH_NAME (msymbol,
+							      modified_name));
 		    }
 
 		  if (match)
@@ -328,22 +397,23 @@ iterate_over_minimal_symbols (struct objfile *objf, const char *name,
   int (*cmp) (const char *, const char *);
 
   /* The first pass is over the ordinary hash table.  */
-  hash = msymbol_hash (name) % MINIMAL_SYMBOL_HASH_SIZE;
-  iter = objf->per_bfd->msymbol_hash[hash];
+  hash = msymbol_hash (name);
+  iter = msymbol_hash_chain (objf->per_bfd, hash);
   cmp = (case_sensitivity == case_sensitive_on ? strcmp : strcasecmp);
   while (iter)
     {
-      if (cmp (MSYMBOL_LINKAGE_NAME (iter), name) == 0)
+      if (iter->hash == hash && cmp (MSYMBOL_LINKAGE_NAME (iter), name) == 0)
 	(*callback) (iter, user_data);
       iter = iter->hash_next;
     }
 
   /* The second pass is over the demangled table.  */
-  hash = msymbol_hash_iw (name) % MINIMAL_SYMBOL_HASH_SIZE;
-  iter = objf->per_bfd->msymbol_demangled_hash[hash];
+  hash = msymbol_hash_iw (name);
+  iter = msymbol_demangled_hash_chain (objf->per_bfd, hash);
   while (iter)
     {
-      if (MSYMBOL_MATCHES_SEARCH_NAME (iter, name))
+      if (iter->demangled_hash == hash
+	  && MSYMBOL_MATCHES_SEARCH_NAME (iter, name))
 	(*callback) (iter, user_data);
       iter = iter->demangled_hash_next;
     }
@@ -359,7 +429,7 @@ lookup_minimal_symbol_text (const char *name, struct objfile *objf)
   struct bound_minimal_symbol found_symbol = { NULL, NULL };
   struct bound_minimal_symbol found_file_symbol = { NULL, NULL };
 
-  unsigned int hash = msymbol_hash (name) % MINIMAL_SYMBOL_HASH_SIZE;
+  unsigned int hash = msymbol_hash (name);
 
   for (objfile = object_files;
        objfile != NULL && found_symbol.minsym == NULL;
@@ -368,11 +438,12 @@ lookup_minimal_symbol_text (const char *name, struct objfile *objf)
       if (objf == NULL || objf == objfile
 	  || objf == objfile->separate_debug_objfile_backlink)
 	{
-	  for (msymbol = objfile->per_bfd->msymbol_hash[hash];
+	  for (msymbol = msymbol_hash_chain (objfile->per_bfd, hash);
 	       msymbol != NULL && found_symbol.minsym == NULL;
 	       msymbol = msymbol->hash_next)
 	    {
-	      if (strcmp (MSYMBOL_LINKAGE_NAME (msymbol), name) == 0 &&
+	      if (msymbol->hash == hash
+		  && strcmp (MSYMBOL_LINKAGE_NAME (msymbol), name) == 0 &&
 		  (MSYMBOL_TYPE (msymbol) == mst_text
 		   || MSYMBOL_TYPE (msymbol) == mst_text_gnu_ifunc
 		   || MSYMBOL_TYPE (msymbol) == mst_file_text))
@@ -409,7 +480,7 @@ lookup_minimal_symbol_by_pc_name (CORE_ADDR pc, const char *name,
   struct objfile *objfile;
   struct minimal_symbol *msymbol;
 
-  unsigned int hash = msymbol_hash (name) % MINIMAL_SYMBOL_HASH_SIZE;
+  unsigned int hash = msymbol_hash (name);
 
   for (objfile = object_files;
        objfile != NULL;
@@ -418,11 +489,12 @@ lookup_minimal_symbol_by_pc_name (CORE_ADDR pc, const char *name,
       if (objf == NULL || objf == objfile
 	  || objf == objfile->separate_debug_objfile_backlink)
 	{
-	  for (msymbol = objfile->per_bfd->msymbol_hash[hash];
+	  for (msymbol = msymbol_hash_chain (objfile->per_bfd, hash);
 	       msymbol != NULL;
 	       msymbol = msymbol->hash_next)
 	    {
 	      if (MSYMBOL_VALUE_ADDRESS (objfile, msymbol) == pc
+		  && msymbol->hash == hash
 		  && strcmp (MSYMBOL_LINKAGE_NAME (msymbol), name) == 0)
 		return msymbol;
 	    }
@@ -442,7 +514,7 @@ lookup_minimal_symbol_solib_trampoline (const char *name,
   struct minimal_symbol *msymbol;
   struct bound_minimal_symbol found_symbol = { NULL, NULL };
 
-  unsigned int hash = msymbol_hash (name) % MINIMAL_SYMBOL_HASH_SIZE;
+  unsigned int hash = msymbol_hash (name);
 
   for (objfile = object_files;
        objfile != NULL;
@@ -451,11 +523,12 @@ lookup_minimal_symbol_solib_trampoline (const char *name,
       if (objf == NULL || objf == objfile
 	  || objf == objfile->separate_debug_objfile_backlink)
 	{
-	  for (msymbol = objfile->per_bfd->msymbol_hash[hash];
+	  for (msymbol = msymbol_hash_chain (objfile->per_bfd, hash);
 	       msymbol != NULL;
 	       msymbol = msymbol->hash_next)
 	    {
-	      if (strcmp (MSYMBOL_LINKAGE_NAME (msymbol), name) == 0 &&
+	      if (msymbol->hash == hash
+		  && strcmp (MSYMBOL_LINKAGE_NAME (msymbol), name) == 0 &&
 		  MSYMBOL_TYPE (msymbol) == mst_solib_trampoline)
 		{
 		  found_symbol.objfile = objfile;
@@ -845,17 +918,18 @@ lookup_minimal_symbol_and_objfile (const char *name)
 {
   struct bound_minimal_symbol result;
   struct objfile *objfile;
-  unsigned int hash = msymbol_hash (name) % MINIMAL_SYMBOL_HASH_SIZE;
+  unsigned int hash = msymbol_hash (name);
 
   ALL_OBJFILES (objfile)
     {
       struct minimal_symbol *msym;
 
-      for (msym = objfile->per_bfd->msymbol_hash[hash];
+      for (msym = msymbol_hash_chain (objfile->per_bfd, hash);
 	   msym != NULL;
 	   msym = msym->hash_next)
 	{
-	  if (strcmp (MSYMBOL_LINKAGE_NAME (msym), name) == 0)
+	  if (msym->hash == hash
+	      && strcmp (MSYMBOL_LINKAGE_NAME (msym), name) == 0)
 	    {
 	      result.minsym = msym;
 	      result.objfile = objfile;
@@ -1151,36 +1225,56 @@ compact_minimal_symbols (struct minimal_symbol *msymbol, int mcount,
   return (mcount);
 }
 
+/* Return the number of buckets to use in the minimal symbol hash
+   tables for COUNT minimal symbols.  This keeps the hash chains short
+   however many symbols there are.  */
+
+static unsigned int
+minimal_symbol_hash_size (int count)
+{
+  static const unsigned int primes[] =
+    {
+      MINIMAL_SYMBOL_HASH_SIZE, 4093, 8191, 16381, 32749, 65521, 131071,
+      262139, 524287, 1048573, 2097143, 4194301, 8388593, 16777213,
+      33554393, 67108859, 134217689, 268435399, 536870909, 1073741789
+    };
+  int i;
+
+  for (i = 0; i < ARRAY_SIZE (primes) - 1; i++)
+    if (primes[i] >= count)
+      break;
+  return primes[i];
+}
+
 /* Build (or rebuild) the minimal symbol hash tables.  This is necessary
    after compacting or sorting the table since the entries move around
-   thus causing the internal minimal_symbol pointers to become jumbled.  */
+   thus causing the internal minimal_symbol pointers to become jumbled.
+   The demangled name hash table is only discarded here; it is rebuilt
+   when it is next needed.  */
   
 static void
 build_minimal_symbol_hash_tables (struct objfile *objfile)
 {
+  struct objfile_per_bfd_storage *per_bfd = objfile->per_bfd;
   int i;
   struct minimal_symbol *msym;
 
-  /* Clear the hash tables.  */
-  for (i = 0; i < MINIMAL_SYMBOL_HASH_SIZE; i++)
-    {
-      objfile->per_bfd->msymbol_hash[i] = 0;
-      objfile->per_bfd->msymbol_demangled_hash[i] = 0;
-    }
+  /* Allocate new, empty hash tables sized for the symbols.  */
+  per_bfd->msymbol_hash_size
+    = minimal_symbol_hash_size (per_bfd->minimal_symbol_count);
+  per_bfd->msymbol_hash
+    = OBSTACK_CALLOC (&per_bfd->storage_obstack, per_bfd->msymbol_hash_size,
+		      struct minimal_symbol *);
+  per_bfd->msymbol_demangled_hash = NULL;
 
   /* Now, (re)insert the actual entries.  */
-  for ((i = objfile->per_bfd->minimal_symbol_count,
-	msym = objfile->per_bfd->msymbols);
+  for ((i = per_bfd->minimal_symbol_count, msym = per_bfd->msymbols);
        i > 0;
        i--, msym++)
     {
       msym->hash_next = 0;
-      add_minsym_to_hash_table (msym, objfile->per_bfd->msymbol_hash);
-
-      msym->demangled_hash_next = 0;
-      if (MSYMBOL_SEARCH_NAME (msym) != MSYMBOL_LINKAGE_NAME (msym))
-	add_minsym_to_demangled_hash_table (msym,
-                                            objfile->per_bfd->msymbol_demangled_hash);
+      add_minsym_to_hash_table (msym, per_bfd->msymbol_hash,
+				per_bfd->msymbol_hash_size);
     }
 }
 
@@ -163,7 +163,8 @@ struct objstats
 extern void print_objfile_statistics (void);
 extern void print_symbol_bcache_statistics (void);
 
-/* Number of entries in the minimal symbol hash table.  */
+/* Minimum number of entries in the minimal symbol hash tables.  Larger
+   tables are used for objfiles with more minimal symbols.  */
 #define MINIMAL_SYMBOL_HASH_SIZE 2039
 
 /* Some objfile data is hung off the BFD.  This enables sharing of the
@@ -239,14 +240,20 @@ struct objfile_per_bfd_storage
 
   unsigned int minsyms_read : 1;
 
+  /* The number of buckets in each of the minimal symbol hash tables
+     below.  This depends on the number of minimal symbols.  */
+
+  unsigned int msymbol_hash_size;
+
   /* This is a hash table used to index the minimal symbols by name.  */
 
-  struct minimal_symbol *msymbol_hash[MINIMAL_SYMBOL_HASH_SIZE];
+  struct minimal_symbol **msymbol_hash;
 
   /* This hash table is used to index the minimal symbols by their
-     demangled names.  */
+     demangled names.  It is only built the first time it is needed,
+     and is NULL until then.  */
 
-  struct minimal_symbol *msymbol_demangled_hash[MINIMAL_SYMBOL_HASH_SIZE];
+  struct minimal_symbol **msymbol_demangled_hash;
 };
 
 /* Master structure for keeping track of each file from which
@@ -1486,7 +1486,9 @@ start_psymtab_common (struct objfile *objfile,
 /* Calculate a hash code for the given partial symbol.  The hash is
    calculated using the symbol's value, language, domain, class
    and name.  These are the values which are set by
-   add_psymbol_to_bcache.  */
+   add_psymbol_to_bcache.  psymbol_compare compares names by
+   pointer, so only the name's address needs to be hashed, not its
+   characters.  */
 
 static unsigned long
 psymbol_hash (const void *addr, int length)
@@ -1501,7 +1503,7 @@ psymbol_hash (const void *addr, int length)
   h = hash_continue (&lang, sizeof (unsigned int), h);
   h = hash_continue (&domain, sizeof (unsigned int), h);
   h = hash_continue (&class, sizeof (unsigned int), h);
-  h = hash_continue (psymbol->ginfo.name, strlen (psymbol->ginfo.name), h);
+  h = hash_continue (&psymbol->ginfo.name, sizeof (psymbol->ginfo.name), h);
 
   return h;
 }
@@ -1330,6 +1330,12 @@ enum {
   /* Support for qXfer:libraries-svr4:read with a non-empty annex.  */
   PACKET_augmented_libraries_svr4_read_feature,
 
+  /* Support for the binary memory read packet.  */
+  PACKET_x,
+
+  /* Support for having several memory reads in flight at once.  */
+  PACKET_memory_read_pipelining_feature,
+
   PACKET_MAX
 };
 
@@ -3925,7 +3931,10 @@ static const struct protocol_feature remote_protocol_features[] = {
   { "Qbtrace:off", PACKET_DISABLE, remote_supported_packet, PACKET_Qbtrace_off },
   { "Qbtrace:bts", PACKET_DISABLE, remote_supported_packet, PACKET_Qbtrace_bts },
   { "qXfer:btrace:read", PACKET_DISABLE, remote_supported_packet,
-    PACKET_qXfer_btrace }
+    PACKET_qXfer_btrace },
+  { "binary-upload", PACKET_DISABLE, remote_supported_packet, PACKET_x },
+  { "memory-read-pipelining", PACKET_DISABLE, remote_supported_packet,
+    PACKET_memory_read_pipelining_feature }
 };
 
 static char *remote_support_xml;
@@ -6709,12 +6718,96 @@ remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr, ULONGEST len,
 				 packet_format[0], 1);
 }
 
+/* The maximum number of memory read packets sent to the target
+   before waiting for the first reply, if the target supports it.  */
+
+#define DEFAULT_MEMORY_READ_PIPELINE_DEPTH 4
+static unsigned int remote_memory_read_pipeline_depth
+  = DEFAULT_MEMORY_READ_PIPELINE_DEPTH;
+
+/* The largest value "set remote memory-read-pipeline-depth" accepts.
+   Every packet in flight may need a full reply buffered by the
+   transport before GDB reads it, so don't let that grow without
+   bound.  */
+
+#define MAX_MEMORY_READ_PIPELINE_DEPTH 64
+
+static void
+set_memory_read_pipeline_depth (char *args, int from_tty,
+				struct cmd_list_element *c)
+{
+  if (remote_memory_read_pipeline_depth > MAX_MEMORY_READ_PIPELINE_DEPTH)
+    {
+      remote_memory_read_pipeline_depth = DEFAULT_MEMORY_READ_PIPELINE_DEPTH;
+      error (_("Memory read pipeline depth must be at most %d."),
+	     MAX_MEMORY_READ_PIPELINE_DEPTH);
+    }
+}
+
+/* Send a request to read TODO bytes of memory at MEMADDR.  If BINARY,
+   use the "x" packet, otherwise the "m" packet.  */
+
+static void
+remote_send_memory_read (CORE_ADDR memaddr, int todo, int binary)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *p;
+
+  /* Construct "m"<memaddr>","<len>" or "x"<memaddr>","<len>".  */
+  memaddr = remote_address_masked (memaddr);
+  p = rs->buf;
+  *p++ = binary ? 'x' : 'm';
+  p += hexnumstr (p, (ULONGEST) memaddr);
+  *p++ = ',';
+  p += hexnumstr (p, (ULONGEST) todo);
+  *p = '\0';
+  putpkt (rs->buf);
+}
+
+/* Read the reply to a request sent by remote_send_memory_read, and
+   store the memory it describes in MYADDR, which has room for TODO
+   bytes.  Return the number of bytes stored, or -1 if the target
+   reported an error.  */
+
+static int
+remote_get_memory_read_reply (gdb_byte *myaddr, int todo, int binary)
+{
+  struct remote_state *rs = get_remote_state ();
+  int reply_len;
+
+  reply_len = getpkt_sane (&rs->buf, &rs->buf_size, 0);
+  if (rs->buf[0] == 'E'
+      && isxdigit (rs->buf[1]) && isxdigit (rs->buf[2])
+      && rs->buf[3] == '\0')
+    return -1;
+
+  if (binary)
+    {
+      /* Reply is "b" followed by the memory, escaped as in the "X"
+	 packet.  */
+      if (reply_len < 1 || rs->buf[0] != 'b')
+	return -1;
+      return remote_unescape_input ((gdb_byte *) rs->buf + 1, reply_len - 1,
+				    myaddr, todo);
+    }
+
+  /* Reply describes memory byte by byte, each byte encoded as two hex
+     characters.  */
+  return hex2bin (rs->buf, myaddr, todo);
+}
+
 /* Read memory data directly from the remote machine.
    This does not use the data cache; the data cache uses this.
    MEMADDR is the address in the remote memory space.
    MYADDR is the address of the buffer in our space.
    LEN is the number of bytes.
 
+   If the target supports it, several requests for consecutive blocks
+   of memory are sent before reading the replies, so that a large
+   read costs about one round trip rather than one per packet.  This
+   needs the no-ack mode, as otherwise GDB waits for each packet to be
+   acknowledged before sending the next.
+
    Return the transferred status, error or OK (an
    'enum target_xfer_status' value).  Save the number of bytes
    transferred in *XFERED_LEN.  */
@@ -6725,37 +6818,73 @@ remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr, ULONGEST len,
 {
   struct remote_state *rs = get_remote_state ();
   int max_buf_size;		/* Max size of packet output buffer.  */
-  char *p;
+  int binary;
   int todo;
-  int i;
+  ULONGEST npackets, depth, i;
+  ULONGEST done;
+  int failed;
 
   max_buf_size = get_memory_read_packet_size ();
   /* The packet buffer will be large enough for the payload;
      get_memory_packet_size ensures this.  */
 
-  /* Number if bytes that will fit.  */
-  todo = min (len, max_buf_size / 2);
+  binary = packet_support (PACKET_x) == PACKET_ENABLE;
 
-  /* Construct "m"<memaddr>","<len>".  */
-  memaddr = remote_address_masked (memaddr);
-  p = rs->buf;
-  *p++ = 'm';
-  p += hexnumstr (p, (ULONGEST) memaddr);
-  *p++ = ',';
-  p += hexnumstr (p, (ULONGEST) todo);
-  *p = '\0';
-  putpkt (rs->buf);
-  getpkt (&rs->buf, &rs->buf_size, 0);
-  if (rs->buf[0] == 'E'
-      && isxdigit (rs->buf[1]) && isxdigit (rs->buf[2])
-      && rs->buf[3] == '\0')
+  /* Number if bytes that will fit.  A binary reply needs one byte for
+     its "b" prefix, and two for each byte that must be escaped; leave
+     room for some of those so that replies normally come back
+     whole.  */
+  if (binary)
+    todo = (max_buf_size - 1) - (max_buf_size - 1) / 8;
+  else
+    todo = max_buf_size / 2;
+
+  depth = 1;
+  if (rs->noack_mode
+      && packet_support (PACKET_memory_read_pipelining_feature) == PACKET_ENABLE
+      && remote_memory_read_pipeline_depth > 1)
+    depth = remote_memory_read_pipeline_depth;
+
+  npackets = (len + todo - 1) / todo;
+  if (npackets > depth)
+    npackets = depth;
+
+  for (i = 0; i < npackets; i++)
+    remote_send_memory_read (memaddr + i * todo,
+			      min (len - i * todo, todo), binary);
+
+  /* Every reply must be read, even after one came back short, so that
+     the next packet exchange stays in step.  */
+  done = 0;
+  failed = 0;
+  for (i = 0; i < npackets; i++)
+    {
+      int want = min (len - i * todo, todo);
+      int got;
+
+      got = remote_get_memory_read_reply (myaddr + i * todo, want, binary);
+      if (failed)
+	continue;
+
+      if (got < 0)
+	{
+	  if (i == 0)
+	    failed = -1;
+	  else
+	    failed = 1;
+	  continue;
+	}
+
+      done += got;
+      if (got < want)
+	failed = 1;
+    }
+
+  if (failed < 0)
     return TARGET_XFER_E_IO;
-  /* Reply describes memory byte by byte, each byte encoded as two hex
-     characters.  */
-  p = rs->buf;
-  i = hex2bin (p, myaddr, todo);
+
   /* Return what we have.  Let higher layers handle partial reads.  */
-  *xfered_len = (ULONGEST) i;
+  *xfered_len = done;
   return TARGET_XFER_OK;
 }
 
@@ -11883,6 +12012,17 @@ further restriction and ``limit'' to enable that restriction."),
 	   _("Show the maximum number of bytes per memory-read packet."),
 	   &remote_show_cmdlist);
 
+  add_setshow_zuinteger_cmd ("memory-read-pipeline-depth", no_class,
+			     &remote_memory_read_pipeline_depth, _("\
+Set the maximum number of memory read packets in flight at once."), _("\
+Show the maximum number of memory read packets in flight at once."), _("\
+Large memory reads are split into several packets.  If the remote\n\
+target supports it, up to this many of them are sent before waiting\n\
+for the replies.  A value of 0 or 1 disables pipelining.  The most\n\
+allowed is 64."),
+			     set_memory_read_pipeline_depth, NULL,
+			     &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zinteger_cmd ("hardware-watchpoint-limit", no_class,
 			    &remote_hw_watchpoint_limit, _("\
 Set the maximum number of target hardware watchpoints."), _("\
@@ -11924,6 +12064,13 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_X],
 			 "X", "binary-download", 1);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_x],
+			 "x", "binary-upload", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_memory_read_pipelining_feature],
+			 "memory-read-pipelining-feature",
+			 "memory-read-pipelining", 0);
+
   add_packet_config_cmd (&remote_protocol_packets[PACKET_vCont],
 			 "vCont", "verbose-resume", 0);
 
@@ -367,6 +367,13 @@ struct minimal_symbol
      the object file format may not carry that piece of information.  */
   unsigned int has_size : 1;
 
+  /* The msymbol_hash of the linkage name of this symbol, and the
+     msymbol_hash_iw of its search name.  Hash chain walks compare
+     these before comparing names.  */
+
+  unsigned int hash;
+  unsigned int demangled_hash;
+
   /* Minimal symbols with the same hash key are kept on a linked
      list.  This is the link.  */
 
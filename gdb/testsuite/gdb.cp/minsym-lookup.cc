@@ -0,0 +1,73 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2014 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Enough functions that the minimal symbol hash tables need more than
+   the minimum number of buckets.  */
+
+#define GEN(n) int gen_##n (int x) { return x + 1; }
+#define GEN10(n) GEN(n##0) GEN(n##1) GEN(n##2) GEN(n##3) GEN(n##4) \
+  GEN(n##5) GEN(n##6) GEN(n##7) GEN(n##8) GEN(n##9)
+#define GEN100(n) GEN10(n##0) GEN10(n##1) GEN10(n##2) GEN10(n##3) \
+  GEN10(n##4) GEN10(n##5) GEN10(n##6) GEN10(n##7) GEN10(n##8) GEN10(n##9)
+#define GEN1000(n) GEN100(n##0) GEN100(n##1) GEN100(n##2) GEN100(n##3) \
+  GEN100(n##4) GEN100(n##5) GEN100(n##6) GEN100(n##7) GEN100(n##8) \
+  GEN100(n##9)
+
+namespace minsym_ns
+{
+  int
+  func (int x)
+  {
+    return x;
+  }
+
+  int
+  func (const char *s)
+  {
+    return *s;
+  }
+
+  class K
+  {
+  public:
+    static int method (long l);
+  };
+
+  int
+  K::method (long l)
+  {
+    return l;
+  }
+
+  GEN1000 (1)
+  GEN1000 (2)
+  GEN1000 (3)
+}
+
+extern "C" int
+c_func (int x)
+{
+  return x;
+}
+
+int
+main ()
+{
+  return (minsym_ns::func (0) + minsym_ns::func ("")
+	  + minsym_ns::K::method (0) + minsym_ns::gen_1234 (0)
+	  + minsym_ns::gen_2000 (0) + c_func (0));
+}
@@ -0,0 +1,63 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2014 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Every byte value, including the ones that must be escaped in binary
+   packets: '#', '$', '}' and '*'.  */
+unsigned char all_bytes[256];
+
+/* Large enough to need several packets.  */
+unsigned char big[65536];
+
+/* The end of a page that is followed by an unmapped one.  The page
+   ends with the bytes in EDGE_BYTES.  */
+unsigned char *edge;
+const char edge_bytes[] = "0123456789ab$#}*";
+long page_size;
+
+static void
+done (void)
+{
+}
+
+int
+main (void)
+{
+  unsigned char *pages;
+  int i;
+
+  for (i = 0; i < sizeof (all_bytes); i++)
+    all_bytes[i] = i;
+
+  for (i = 0; i < sizeof (big); i++)
+    big[i] = (i * 7) ^ (i >> 8);
+
+  page_size = sysconf (_SC_PAGESIZE);
+  pages = mmap (NULL, 2 * page_size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED)
+    return 1;
+  munmap (pages + page_size, page_size);
+  edge = pages + page_size;
+  for (i = 0; i < 16; i++)
+    edge[i - 16] = edge_bytes[i];
+
+  done ();
+  return 0;
+}
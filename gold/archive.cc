@@ -192,10 +192,11 @@ const char Archive::arfmag[2] = { '`', '\n' };
 Archive::Archive(const std::string& name, Input_file* input_file,
                  bool is_thin_archive, Dirsearch* dirpath, Task* task)
   : Library_base(task), name_(name), input_file_(input_file), armap_(),
-    armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
+    armap_names_(), extended_names_(), armap_checked_(),
+    armap_hash_buckets_(), armap_hash_chain_(), seen_offsets_(),
     members_(), is_thin_archive_(is_thin_archive), included_member_(false),
     nested_archives_(), dirpath_(dirpath), num_members_(0),
-    included_all_members_(false)
+    included_all_members_(false), has_file_digest_(false)
 {
   this->no_export_ =
     parameters->options().check_excluded_libs(input_file->found_name());
@@ -834,17 +835,49 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
   return true;
 }
 
+// Build the hash table of archive map names.  The plugin calls
+// defines_symbol for each undefined symbol after it has claimed its
+// input files, so scanning the whole archive map each time would be
+// quadratic for large archives.
+
+void
+Archive::build_armap_hash()
+{
+  size_t armap_size = this->armap_.size();
+  size_t nbuckets = armap_size | 1;
+  this->armap_hash_buckets_.assign(nbuckets, 0);
+  this->armap_hash_chain_.assign(armap_size, 0);
+  for (size_t i = 0; i < armap_size; ++i)
+    {
+      const char* name = (this->armap_names_.data()
+			  + this->armap_[i].name_offset);
+      size_t len = strcspn(name, "@");
+      size_t bucket = string_hash<char>(name, len) % nbuckets;
+      this->armap_hash_chain_[i] = this->armap_hash_buckets_[bucket];
+      this->armap_hash_buckets_[bucket] = i + 1;
+    }
+}
+
 // Return whether the archive includes a member which defines the
 // symbol SYM.
 
 bool
-Archive::defines_symbol(Symbol* sym) const
+Archive::defines_symbol(Symbol* sym)
 {
+  if (this->armap_.empty())
+    return false;
+  if (this->armap_hash_buckets_.empty())
+    this->build_armap_hash();
+
   const char* symname = sym->name();
   size_t symname_len = strlen(symname);
-  size_t armap_size = this->armap_.size();
-  for (size_t i = 0; i < armap_size; ++i)
+  size_t bucket = (string_hash<char>(symname, symname_len)
+		   % this->armap_hash_buckets_.size());
+  for (unsigned int j = this->armap_hash_buckets_[bucket];
+       j != 0;
+       j = this->armap_hash_chain_[j - 1])
     {
+      size_t i = j - 1;
       if (this->armap_checked_[i])
 	continue;
       const char* archive_symname = (this->armap_names_.data()
@@ -1001,7 +1034,8 @@ Archive::include_member(Symbol_table* symtab, Layout* layout,
     {
       {
 	if (layout->incremental_inputs() != NULL)
-	  layout->incremental_inputs()->report_object(obj, 0, this, NULL);
+	  layout->incremental_inputs()->report_object(obj, 0, this, NULL,
+						      NULL);
 	Read_symbols_data sd;
 	obj->read_symbols(&sd);
 	obj->layout(symtab, layout, &sd);
@@ -1243,7 +1277,7 @@ Lib_group::include_member(Symbol_table* symtab, Layout* layout,
     {
       if (layout->incremental_inputs() != NULL)
 	layout->incremental_inputs()->report_object(obj, member.arg_serial_,
-						    this, NULL);
+						    this, NULL, NULL);
       obj->layout(symtab, layout, sd);
       obj->add_symbols(symtab, sd, layout);
     }
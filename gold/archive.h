@@ -84,6 +84,13 @@ class Library_base
   get_mtime()
   { return this->do_get_mtime(); }
 
+  // Get the digest of the contents of the archive file into DIGEST,
+  // which must hold file_digest_size bytes.  This is all zeroes if the
+  // digest is not known.
+  void
+  get_file_digest(unsigned char* digest)
+  { this->do_get_file_digest(digest); }
+
   // When we see a symbol in an archive we might decide to include the member,
   // not include the member or be undecided. This enum represents these
   // possibilities.
@@ -148,6 +155,10 @@ class Library_base
   virtual Timespec
   do_get_mtime() = 0;
 
+  // Get the digest of the contents of the archive file.
+  virtual void
+  do_get_file_digest(unsigned char* digest) = 0;
+
   // Iterator for unused global symbols in the library.
   virtual void
   do_for_all_unused_symbols(Symbol_visitor_base* v) const = 0;
@@ -191,6 +202,15 @@ class Archive : public Library_base
   void
   setup();
 
+  // Compute the digest of the contents of the archive file, for an
+  // incremental link.  The file must be locked.
+  void
+  compute_file_digest()
+  {
+    this->file().get_digest(this->file_digest_);
+    this->has_file_digest_ = true;
+  }
+
   // Get a reference to the underlying file.
   File_read&
   file()
@@ -246,7 +266,7 @@ class Archive : public Library_base
 
   // Return whether the archive defines the symbol.
   bool
-  defines_symbol(Symbol*) const;
+  defines_symbol(Symbol*);
 
   // Dump statistical information to stderr.
   static void
@@ -275,6 +295,16 @@ class Archive : public Library_base
   do_get_mtime()
   { return this->file().get_mtime(); }
 
+  // The digest of the contents of the archive file.
+  void
+  do_get_file_digest(unsigned char* digest)
+  {
+    if (this->has_file_digest_)
+      memcpy(digest, this->file_digest_, file_digest_size);
+    else
+      memset(digest, 0, file_digest_size);
+  }
+
   struct Archive_header;
 
   // Total number of archives seen.
@@ -365,6 +395,11 @@ class Archive : public Library_base
     off_t file_offset;
   };
 
+  // Build the hash table of archive map names used by
+  // defines_symbol.
+  void
+  build_armap_hash();
+
   // A simple hash code for off_t values.
   class Seen_hash
   {
@@ -389,6 +424,13 @@ class Archive : public Library_base
   // Track which symbols in the archive map are for elements which are
   // defined or which have already been included in the link.
   std::vector<bool> armap_checked_;
+  // A hash table of the names in the archive map, ignoring any
+  // version, built the first time defines_symbol is called.  Each
+  // bucket holds one more than the index in armap_ of the first
+  // entry with that hash code, or 0 if there is none; the chain
+  // links the remaining entries in the same way.
+  std::vector<unsigned int> armap_hash_buckets_;
+  std::vector<unsigned int> armap_hash_chain_;
   // Track which elements have been included by offset.
   Unordered_set<off_t, Seen_hash> seen_offsets_;
   // Table of objects whose symbols have been pre-read.
@@ -407,6 +449,10 @@ class Archive : public Library_base
   bool no_export_;
   // True if this library has been included as a --whole-archive.
   bool included_all_members_;
+  // Whether file_digest_ holds the digest of the archive file.
+  bool has_file_digest_;
+  // The digest of the archive file, for an incremental link.
+  unsigned char file_digest_[file_digest_size];
 };
 
 // This class is used to read an archive and pick out the desired
@@ -507,6 +553,11 @@ class Lib_group : public Library_base
   do_get_mtime()
   { return Timespec(0, 0); }
 
+  // Nor does it have a digest.
+  void
+  do_get_file_digest(unsigned char* digest)
+  { memset(digest, 0, file_digest_size); }
+
   // Iterator for unused global symbols in the library.
   void
   do_for_all_unused_symbols(Symbol_visitor_base*) const;
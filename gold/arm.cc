@@ -1673,8 +1673,11 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
   do_count_local_symbols(Stringpool_template<char>*,
 			 Stringpool_template<char>*);
 
+  // Relocate the stub tables and apply the Cortex-A8 workaround.
+  // This must wait until all the sections have been relocated, since
+  // the workaround changes relocated instructions.
   void
-  do_relocate_sections(
+  do_finish_relocate_sections(
       const Symbol_table* symtab, const Layout* layout,
       const unsigned char* pshdrs, Output_file* of,
       typename Sized_relobj_file<32, big_endian>::Views* pivews);
@@ -6435,27 +6438,22 @@ Arm_relobj<big_endian>::do_count_local_symbols(
     }
 }
 
-// Relocate sections.
+// Relocate the stub tables and apply the Cortex-A8 workaround, once
+// all the sections have been relocated.
 template<bool big_endian>
 void
-Arm_relobj<big_endian>::do_relocate_sections(
+Arm_relobj<big_endian>::do_finish_relocate_sections(
     const Symbol_table* symtab,
     const Layout* layout,
     const unsigned char* pshdrs,
-    Output_file* of,
+    Output_file*,
     typename Sized_relobj_file<32, big_endian>::Views* pviews)
 {
-  // Call parent to relocate sections.
-  Sized_relobj_file<32, big_endian>::do_relocate_sections(symtab, layout,
-							  pshdrs, of, pviews);
-
   // We do not generate stubs if doing a relocatable link.
   if (parameters->options().relocatable())
     return;
 
   // Relocate stub tables.
-  unsigned int shnum = this->shnum();
-
   Target_arm<big_endian>* arm_target =
     Target_arm<big_endian>::default_target();
 
@@ -6464,6 +6462,7 @@ Arm_relobj<big_endian>::do_relocate_sections(
   relinfo.layout = layout;
   relinfo.object = this;
 
+  unsigned int shnum = this->shnum();
   for (unsigned int i = 1; i < shnum; ++i)
     {
       Arm_input_section<big_endian>* arm_input_section =
@@ -11654,11 +11653,13 @@ Target_arm<big_endian>::do_relax(
 
   // Check all stub tables to see if any of them have their data sizes
   // or addresses alignments changed.  These are the only things that
-  // matter.
+  // matter.  Update every stub table which changed, not just the
+  // first one, so that a pass which adds stubs to many stub groups
+  // does not need a further pass for each of them.
   bool any_stub_table_changed = false;
   Unordered_set<const Output_section*> sections_needing_adjustment;
   for (Stub_table_iterator sp = this->stub_tables_.begin();
-       (sp != this->stub_tables_.end()) && !any_stub_table_changed;
+       sp != this->stub_tables_.end();
        ++sp)
     {
       if ((*sp)->update_data_size_and_addralign())
@@ -22,12 +22,15 @@
 
 #include "gold.h"
 
+#include <algorithm>
+
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
 #endif
 
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
@@ -40,9 +43,8 @@ namespace gold
 // (including not having zlib support in the library).  If it returns
 // true, it allocates memory for the compressed data using new, and
 // sets *COMPRESSED_DATA and *COMPRESSED_SIZE to appropriate values.
-// It also writes a header before COMPRESSED_DATA: 4 bytes saying
-// "ZLIB", and 8 bytes indicating the uncompressed size, in big-endian
-// order.
+// The result is a single zlib stream; the caller is responsible for
+// writing the header which precedes the first stream.
 
 static bool
 zlib_compress(const unsigned char* uncompressed_data,
@@ -50,9 +52,8 @@ zlib_compress(const unsigned char* uncompressed_data,
               unsigned char** compressed_data,
               unsigned long* compressed_size)
 {
-  const int header_size = 12;
   *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
-  *compressed_data = new unsigned char[*compressed_size + header_size];
+  *compressed_data = new unsigned char[*compressed_size];
 
   int compress_level;
   if (parameters->options().optimize() >= 1)
@@ -60,19 +61,13 @@ zlib_compress(const unsigned char* uncompressed_data,
   else
     compress_level = 1;
 
-  int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
+  int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data),
                      compressed_size,
                      reinterpret_cast<const Bytef*>(uncompressed_data),
                      uncompressed_size,
                      compress_level);
   if (rc == Z_OK)
-    {
-      memcpy(*compressed_data, "ZLIB", 4);
-      elfcpp::Swap_unaligned<64, true>::writeval(*compressed_data + 4,
-						 uncompressed_size);
-      *compressed_size += header_size;
-      return true;
-    }
+    return true;
   else
     {
       delete[] *compressed_data;
@@ -189,32 +184,230 @@ decompress_input_section(const unsigned char* compressed_data,
   return false;
 }
 
+// The size of the header which precedes the compressed data: 4 bytes
+// saying "ZLIB", and 8 bytes indicating the uncompressed size, in
+// big-endian order.
+
+static const unsigned int zlib_header_size = 12;
+
+// The amount of uncompressed data in each independently compressed
+// chunk.  This is a fixed size, rather than depending on the number
+// of threads, so that the output does not depend on the thread count.
+// Sections which are no larger than this are compressed as a single
+// stream, as before.
+
+static const unsigned long compress_chunk_size = 4 * 1024 * 1024;
+
+// A task which writes the data which does not come from input
+// sections into the postprocessing buffer of an
+// Output_compressed_section, so that the buffer is ready to be
+// compressed.
+
+class Prepare_compressed_section_task : public Task
+{
+ public:
+  Prepare_compressed_section_task(Output_compressed_section* os,
+				  Task_token* blocker,
+				  Task_token* prepare_blocker,
+				  Task_token* final_blocker)
+    : os_(os), blocker_(blocker), prepare_blocker_(prepare_blocker),
+      final_blocker_(final_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return this->blocker_->is_blocked() ? this->blocker_ : NULL; }
+
+  // Unblock PREPARE_BLOCKER_ and FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->prepare_blocker_);
+    tl->add(this, this->final_blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  { this->os_->prepare_for_compression(); }
+
+  std::string
+  get_name() const
+  {
+    return (std::string("Prepare_compressed_section_task ")
+	    + this->os_->name());
+  }
+
+ private:
+  Output_compressed_section* os_;
+  Task_token* blocker_;
+  Task_token* prepare_blocker_;
+  Task_token* final_blocker_;
+};
+
+// A task which compresses one chunk of an Output_compressed_section.
+
+class Compress_chunk_task : public Task
+{
+ public:
+  Compress_chunk_task(Output_compressed_section* os, unsigned int chunk,
+		      Task_token* prepare_blocker, Task_token* final_blocker)
+    : os_(os), chunk_(chunk), prepare_blocker_(prepare_blocker),
+      final_blocker_(final_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->prepare_blocker_->is_blocked())
+      return this->prepare_blocker_;
+    return NULL;
+  }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  std::string
+  get_name() const
+  { return std::string("Compress_chunk_task ") + this->os_->name(); }
+
+ private:
+  Output_compressed_section* os_;
+  unsigned int chunk_;
+  Task_token* prepare_blocker_;
+  Task_token* final_blocker_;
+};
+
 // Class Output_compressed_section.
 
-// Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+Output_compressed_section::~Output_compressed_section()
+{
+  for (Chunk_list::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    delete[] p->data;
+  delete this->prepare_blocker_;
+}
+
+// Set up the list of chunks to compress, and return the number of
+// chunks.  This returns zero if we are not going to compress the
+// section.
+
+unsigned int
+Output_compressed_section::set_up_chunks()
+{
+  gold_assert(this->chunks_.empty());
+  if (strcmp(this->options_->compress_debug_sections(), "zlib") != 0)
+    return 0;
+  const unsigned long uncompressed_size = this->postprocessing_buffer_size();
+  unsigned long count = ((uncompressed_size + compress_chunk_size - 1)
+			 / compress_chunk_size);
+  // An empty section is still compressed, to a single empty stream.
+  if (count == 0)
+    count = 1;
+  this->chunks_.resize(count);
+  return count;
+}
+
+// Set up the chunks to compress, and return the number of tasks which
+// queue_compression_tasks will queue.  This must be called before
+// queue_compression_tasks, so that the caller can add all the
+// blockers before any task runs.
+
+unsigned int
+Output_compressed_section::set_up_compression_tasks()
+{
+  return 1 + this->set_up_chunks();
+}
+
+// Queue the tasks to compress the section.  The caller has already
+// added set_up_compression_tasks() blockers to NEXT_BLOCKER.
+
+void
+Output_compressed_section::queue_compression_tasks(Workqueue* workqueue,
+						   Task_token* blocker,
+						   Task_token* next_blocker)
+{
+  gold_assert(this->prepare_blocker_ == NULL);
+  this->prepare_blocker_ = new Task_token(true);
+  this->prepare_blocker_->add_blocker();
+  workqueue->queue(new Prepare_compressed_section_task(this, blocker,
+						       this->prepare_blocker_,
+						       next_blocker));
+  for (unsigned int i = 0; i < this->chunks_.size(); ++i)
+    workqueue->queue(new Compress_chunk_task(this, i, this->prepare_blocker_,
+					     next_blocker));
+}
+
+// Compress chunk I.
+
+void
+Output_compressed_section::compress_chunk(unsigned int i)
+{
+  gold_assert(i < this->chunks_.size());
+  const unsigned long uncompressed_size = this->postprocessing_buffer_size();
+  const unsigned long offset = i * compress_chunk_size;
+  gold_assert(offset <= uncompressed_size);
+  const unsigned long size = std::min(compress_chunk_size,
+				      uncompressed_size - offset);
+  Chunk* chunk = &this->chunks_[i];
+  if (!zlib_compress(this->postprocessing_buffer() + offset, size,
+		     &chunk->data, &chunk->size))
+    {
+      chunk->data = NULL;
+      chunk->size = 0;
+    }
+}
+
+// Set the final data size of a compressed section.  The section data
+// has normally been compressed by the tasks queued by
+// queue_compression_tasks; if those tasks were not used, we compress
+// it here.
 
 void
 Output_compressed_section::set_final_data_size()
 {
   off_t uncompressed_size = this->postprocessing_buffer_size();
 
-  // (Try to) compress the data.
-  unsigned long compressed_size;
-  unsigned char* uncompressed_data = this->postprocessing_buffer();
+  if (this->prepare_blocker_ == NULL)
+    {
+      // At this point the contents of all regular input sections will
+      // have been copied into the postprocessing buffer, and
+      // relocations will have been applied.  Now we need to copy in
+      // the contents of anything other than a regular input section.
+      this->prepare_for_compression();
+      unsigned int count = this->set_up_chunks();
+      for (unsigned int i = 0; i < count; ++i)
+	this->compress_chunk(i);
+    }
 
-  // At this point the contents of all regular input sections will
-  // have been copied into the postprocessing buffer, and relocations
-  // will have been applied.  Now we need to copy in the contents of
-  // anything other than a regular input section.
-  this->write_to_postprocessing_buffer();
+  bool success = !this->chunks_.empty();
+  unsigned long compressed_size = zlib_header_size;
+  for (Chunk_list::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (p->data == NULL)
+	{
+	  success = false;
+	  break;
+	}
+      compressed_size += p->size;
+    }
 
-  bool success = false;
-  if (strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
-    success = zlib_compress(uncompressed_data, uncompressed_size,
-                            &this->data_, &compressed_size);
   if (success)
     {
+      this->uncompressed_size_ = uncompressed_size;
+      this->compressed_ = true;
       // This converts .debug_foo to .zdebug_foo
       this->new_section_name_ = std::string(".z") + (this->name() + 1);
       this->set_name(this->new_section_name_.c_str());
@@ -223,7 +416,13 @@ Output_compressed_section::set_final_data_size()
   else
     {
       gold_warning(_("not compressing section data: zlib error"));
-      gold_assert(this->data_ == NULL);
+      for (Chunk_list::iterator p = this->chunks_.begin();
+	   p != this->chunks_.end();
+	   ++p)
+	{
+	  delete[] p->data;
+	  p->data = NULL;
+	}
       this->set_data_size(uncompressed_size);
     }
 }
@@ -237,10 +436,26 @@ Output_compressed_section::do_write(Output_file* of)
   off_t offset = this->offset();
   off_t data_size = this->data_size();
   unsigned char* view = of->get_output_view(offset, data_size);
-  if (this->data_ == NULL)
+  if (!this->compressed_)
     memcpy(view, this->postprocessing_buffer(), data_size);
   else
-    memcpy(view, this->data_, data_size);
+    {
+      unsigned char* pov = view;
+      memcpy(pov, "ZLIB", 4);
+      elfcpp::Swap_unaligned<64, true>::writeval(pov + 4,
+						 this->uncompressed_size_);
+      pov += zlib_header_size;
+      for (Chunk_list::iterator p = this->chunks_.begin();
+	   p != this->chunks_.end();
+	   ++p)
+	{
+	  memcpy(pov, p->data, p->size);
+	  pov += p->size;
+	  delete[] p->data;
+	  p->data = NULL;
+	}
+      gold_assert(pov - view == data_size);
+    }
   of->write_output_view(offset, data_size, view);
 }
 
@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Task_token;
+class Workqueue;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -53,6 +56,12 @@ decompress_input_section(const unsigned char*, unsigned long, unsigned char*,
 // a regular Output_section which computes its contents into a buffer
 // and then postprocesses it.
 
+// Large sections are compressed as a series of independent zlib
+// streams, one per fixed size chunk of the uncompressed data, so that
+// the chunks can be compressed in parallel.  The streams are simply
+// concatenated after the usual header; readers already handle this
+// by inflating in a loop.
+
 class Output_compressed_section : public Output_section
 {
  public:
@@ -60,9 +69,39 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), chunks_(), uncompressed_size_(0),
+      compressed_(false), prepare_blocker_(NULL)
   { this->set_requires_postprocessing(); }
 
+  ~Output_compressed_section();
+
+  // Divide the section contents into chunks to compress, and return
+  // the number of tasks which queue_compression_tasks will queue.
+  // The caller must add this many blockers to the NEXT_BLOCKER it
+  // passes to queue_compression_tasks.
+  unsigned int
+  set_up_compression_tasks();
+
+  // Queue the tasks which compress the section contents.  The tasks
+  // wait until BLOCKER is unblocked, at which point the input
+  // sections have been written into the postprocessing buffer.  Each
+  // task unblocks NEXT_BLOCKER once when done.
+  void
+  queue_compression_tasks(Workqueue*, Task_token* blocker,
+			  Task_token* next_blocker);
+
+  // Write the data which does not come from input sections into the
+  // postprocessing buffer.  This must be done before any chunk is
+  // compressed.
+  void
+  prepare_for_compression()
+  { this->write_to_postprocessing_buffer(); }
+
+  // Compress chunk I of the section contents.  This may be called
+  // from several threads at once, for different chunks.
+  void
+  compress_chunk(unsigned int i);
+
  protected:
   // Set the final data size.
   void
@@ -73,10 +112,38 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // A compressed chunk of the section contents.
+  struct Chunk
+  {
+    Chunk()
+      : data(NULL), size(0)
+    { }
+
+    // The compressed data, allocated with new[], or NULL if
+    // compression failed.
+    unsigned char* data;
+    // The size of the compressed data.
+    unsigned long size;
+  };
+
+  typedef std::vector<Chunk> Chunk_list;
+
+  // Set up the list of chunks to compress.  Return the number of
+  // chunks.
+  unsigned int
+  set_up_chunks();
+
   // The options--this includes the compression type.
   const General_options* options_;
-  // The compressed data.
-  unsigned char* data_;
+  // The compressed chunks.
+  Chunk_list chunks_;
+  // The size of the data before compression.
+  uint64_t uncompressed_size_;
+  // Whether the data was compressed successfully.
+  bool compressed_;
+  // A blocker which is released once the postprocessing buffer is
+  // ready to be compressed.
+  Task_token* prepare_blocker_;
   // The new section name if we do compress.
   std::string new_section_name_;
 };
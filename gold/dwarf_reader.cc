@@ -2256,6 +2256,34 @@ Sized_dwarf_line_info<size, big_endian>::format_file_lineno(
 
 // Dwarf_line_info routines.
 
+// Return a new line number reader for OBJECT.
+
+Dwarf_line_info*
+Dwarf_line_info::make_line_info(Object* object, unsigned int read_shndx)
+{
+  switch (parameters->size_and_endianness())
+    {
+#ifdef HAVE_TARGET_32_LITTLE
+    case Parameters::TARGET_32_LITTLE:
+      return new Sized_dwarf_line_info<32, false>(object, read_shndx);
+#endif
+#ifdef HAVE_TARGET_32_BIG
+    case Parameters::TARGET_32_BIG:
+      return new Sized_dwarf_line_info<32, true>(object, read_shndx);
+#endif
+#ifdef HAVE_TARGET_64_LITTLE
+    case Parameters::TARGET_64_LITTLE:
+      return new Sized_dwarf_line_info<64, false>(object, read_shndx);
+#endif
+#ifdef HAVE_TARGET_64_BIG
+    case Parameters::TARGET_64_BIG:
+      return new Sized_dwarf_line_info<64, true>(object, read_shndx);
+#endif
+    default:
+      gold_unreachable();
+    }
+}
+
 static unsigned int next_generation_count = 0;
 
 struct Addr2line_cache_entry
@@ -2308,27 +2336,7 @@ Dwarf_line_info::one_addr2line(Object* object,
   // cache.
   if (lineinfo == NULL)
   {
-    switch (parameters->size_and_endianness())
-      {
-#ifdef HAVE_TARGET_32_LITTLE
-        case Parameters::TARGET_32_LITTLE:
-          lineinfo = new Sized_dwarf_line_info<32, false>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_32_BIG
-        case Parameters::TARGET_32_BIG:
-          lineinfo = new Sized_dwarf_line_info<32, true>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_64_LITTLE
-        case Parameters::TARGET_64_LITTLE:
-          lineinfo = new Sized_dwarf_line_info<64, false>(object, shndx); break;
-#endif
-#ifdef HAVE_TARGET_64_BIG
-        case Parameters::TARGET_64_BIG:
-          lineinfo = new Sized_dwarf_line_info<64, true>(object, shndx); break;
-#endif
-        default:
-          gold_unreachable();
-      }
+    lineinfo = Dwarf_line_info::make_line_info(object, shndx);
     addr2line_cache.push_back(Addr2line_cache_entry(object, shndx, lineinfo));
   }
 
@@ -966,6 +966,15 @@ class Dwarf_line_info
             std::vector<std::string>* other_lines)
   { return this->do_addr2line(shndx, offset, other_lines); }
 
+  // Return a new line number reader for OBJECT, using the size and
+  // endianness of the target.  If READ_SHNDX is not -1U, only read
+  // the line information for that section.  The caller must hold the
+  // lock on OBJECT while the reader is constructed.  The reader does
+  // not use any shared state, so readers for different objects may
+  // be used in different threads.
+  static Dwarf_line_info*
+  make_line_info(Object* object, unsigned int read_shndx);
+
   // A helper function for a single addr2line lookup.  It also keeps a
   // cache of the last CACHE_SIZE Dwarf_line_info objects it created;
   // set to 0 not to cache at all.  The larger CACHE_SIZE is, the more
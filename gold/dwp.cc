@@ -28,6 +28,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <vector>
 #include <algorithm>
@@ -41,10 +43,12 @@
 #include "dwarf.h"
 #include "dirsearch.h"
 #include "fileread.h"
+#include "descriptors.h"
 #include "object.h"
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -99,6 +103,28 @@ struct Unit_set
   { }
 };
 
+// A compilation unit or type unit in a .debug_info.dwo or
+// .debug_types.dwo input section.
+
+struct Dwo_unit
+{
+  // The input section index.
+  unsigned int shndx;
+  // The offset and length of the unit within the input section.
+  section_offset_type offset;
+  section_size_type length;
+  // The dwo_id of a compilation unit, or the type signature of a
+  // type unit.
+  uint64_t signature;
+
+  Dwo_unit(unsigned int sh, section_offset_type o, section_size_type l,
+	   uint64_t sig)
+    : shndx(sh), offset(o), length(l), signature(sig)
+  { }
+};
+
+typedef std::vector<Dwo_unit> Unit_list;
+
 // An input file.
 // This class may represent a .dwo file, a .dwp file
 // produced by an earlier run, or an executable file whose
@@ -109,8 +135,16 @@ class Dwo_file
  public:
   Dwo_file(const char* name)
     : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+      sect_offsets_(), str_offset_map_(), machine_(0), size_(0),
+      big_endian_(false), osabi_(0), abiversion_(0), section_sizes_(),
+      debug_types_(), debug_str_(0), debug_cu_index_(0), debug_tu_index_(0),
+      strings_(NULL), strings_len_(0), string_hashes_(), cu_index_(NULL),
+      cu_index_len_(0), tu_index_(NULL), tu_index_len_(0), units_(),
+      contributions_()
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -119,10 +153,25 @@ class Dwo_file
   void
   read_executable(File_list* files);
 
-  // Read the input file and send its contents to OUTPUT_FILE.
+  // Read the input file and collect the sections, strings, and units
+  // that it will contribute to the output file.  This only looks at
+  // this input file, so the input files may be scanned in parallel.
+  // The input file is closed again before returning.
+  void
+  scan();
+
+  // Send the contents found by scan() to OUTPUT_FILE.  This assigns
+  // the output offsets of this file's contributions, which depend on
+  // the earlier input files, so the input files must be read in order.
   void
   read(Dwp_output_file* output_file);
 
+  // Copy this file's contributions into OUTPUT_FILE, once all the
+  // input files have been read and the output file has been laid
+  // out.  The input files may be written in parallel.
+  void
+  write(Dwp_output_file* output_file);
+
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
   // were found.
@@ -144,16 +193,43 @@ class Dwo_file
     { return i1.first < i2.first; }
   };
 
+  // A contribution from this file to an output section.
+  struct Contribution
+  {
+    // The input section index.
+    unsigned int shndx;
+    // The output section.
+    elfcpp::DW_SECT section_id;
+    // The offset of the contribution within the input section.
+    section_offset_type input_offset;
+    // The offset of the contribution within the output section.
+    section_offset_type output_offset;
+    // The size of the contribution.
+    section_size_type size;
+  };
+
+  // A less-than comparison routine for sorting contributions by
+  // input section.
+  struct Contribution_compare
+  {
+    bool
+    operator()(const Contribution& c1, const Contribution& c2) const
+    { return c1.shndx < c2.shndx; }
+  };
+
   // Create a Sized_relobj_dwo of the given size and endianness,
   // and record the target info.  P is a pointer to the ELF header
   // in memory.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object();
 
   template <int size, bool big_endian>
   Relobj*
-  sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+  sized_make_object(const unsigned char* p, Input_file* input_file);
+
+  // Close the input file.
+  void
+  close();
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -177,16 +253,25 @@ class Dwo_file
   section_contents(unsigned int shndx, section_size_type* plen, bool* is_new)
   { return this->obj_->decompressed_section_contents(shndx, plen, is_new); }
 
-  // Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
-  // and process the CU or TU sets.
+  // Return the size of a section after decompression.
+  section_size_type
+  uncompressed_section_size(unsigned int shndx);
+
+  // Return a copy of the contents of a section, decompressed if
+  // necessary.  Set *PLEN to the size.
+  unsigned char*
+  copy_section_contents(unsigned int shndx, section_size_type* plen);
+
+  // Process the CU or TU sets in the saved contents of the
+  // .debug_cu_index or .debug_tu_index section of a .dwp file.
   void
-  read_unit_index(unsigned int, unsigned int *, Dwp_output_file*,
-		  bool is_tu_index);
+  read_unit_index(const unsigned char*, section_size_type, unsigned int *,
+		  Dwp_output_file*, bool is_tu_index);
 
   template <bool big_endian>
   void
-  sized_read_unit_index(unsigned int, unsigned int *, Dwp_output_file*,
-			bool is_tu_index);
+  sized_read_unit_index(const unsigned char*, section_size_type,
+			unsigned int *, Dwp_output_file*, bool is_tu_index);
 
   // Verify the .debug_cu_index section of a .dwp file, comparing it
   // against the list of .dwo files referenced by the corresponding
@@ -198,9 +283,20 @@ class Dwo_file
   bool
   sized_verify_dwo_list(unsigned int, const File_list& files);
 
+  // Save the input string table section and hash its strings.
+  void
+  scan_strings(unsigned int);
+
   // Merge the input string table section into the output file.
   void
-  add_strings(Dwp_output_file*, unsigned int);
+  add_strings(Dwp_output_file*);
+
+  // Add a contribution from an input section to the output file, and
+  // return its offset within the output section.
+  section_offset_type
+  add_contribution(Dwp_output_file* output_file, unsigned int shndx,
+		   elfcpp::DW_SECT section_id,
+		   section_offset_type input_offset, section_size_type len);
 
   // Copy a section from the input file to the output file.
   Section_bounds
@@ -208,11 +304,11 @@ class Dwo_file
 	       elfcpp::DW_SECT section_id);
 
   // Remap the string offsets in the .debug_str_offsets.dwo section.
-  const unsigned char*
+  unsigned char*
   remap_str_offsets(const unsigned char* contents, section_size_type len);
 
   template <bool big_endian>
-  const unsigned char*
+  unsigned char*
   sized_remap_str_offsets(const unsigned char* contents, section_size_type len);
 
   // Remap a single string offsets from an offset in the input string table
@@ -221,10 +317,11 @@ class Dwo_file
   remap_str_offset(section_offset_type val);
 
   // Add a set of .debug_info.dwo or .debug_types.dwo and related sections
-  // to OUTPUT_FILE.
+  // to OUTPUT_FILE.  *PUNIT points to the first unit of the section in
+  // units_, and is advanced past the units of the section.
   void
   add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
-	       bool is_debug_types);
+	       bool is_debug_types, Unit_list::const_iterator* punit);
 
   // The filename.
   const char* name_;
@@ -238,6 +335,40 @@ class Dwo_file
   std::vector<Section_bounds> sect_offsets_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
+  // ELF header parameters.
+  int machine_;
+  int size_;
+  bool big_endian_;
+  int osabi_;
+  int abiversion_;
+  // The uncompressed sizes of the sections which are copied whole.
+  std::vector<section_size_type> section_sizes_;
+  // The debug sections found by scan(), indexed by DW_SECT.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  // The .debug_types.dwo sections.
+  std::vector<unsigned int> debug_types_;
+  // The .debug_str.dwo section.
+  unsigned int debug_str_;
+  // The .debug_cu_index and .debug_tu_index sections of a .dwp file.
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // A copy of the contents of the .debug_str.dwo section, from
+  // scan() until add_strings() has added them to the output file.
+  unsigned char* strings_;
+  section_size_type strings_len_;
+  // The hash code of each string in strings_, in order.
+  std::vector<size_t> string_hashes_;
+  // Copies of the contents of the .debug_cu_index and .debug_tu_index
+  // sections of a .dwp file.
+  unsigned char* cu_index_;
+  section_size_type cu_index_len_;
+  unsigned char* tu_index_;
+  section_size_type tu_index_len_;
+  // The units in the .debug_info.dwo and .debug_types.dwo sections
+  // of a .dwo file, in order.
+  Unit_list units_;
+  // The contributions of this file to the output file.
+  std::vector<Contribution> contributions_;
 };
 
 // An ELF input file.
@@ -439,8 +570,8 @@ class Sized_relobj_dwo : public Sized_relobj<size, big_endian>
   { gold_unreachable(); }
 
   // Relocate the input sections and write out the local symbols.
-  void
-  do_relocate(const Symbol_table*, const Layout*, Output_file*)
+  Task_token*
+  do_relocate(const Symbol_table*, const Layout*, Output_file*, Workqueue*)
   { gold_unreachable(); }
 
  private:
@@ -457,7 +588,7 @@ class Dwp_output_file
  public:
   Dwp_output_file(const char* name)
     : name_(name), machine_(0), size_(0), big_endian_(false), osabi_(0),
-      abiversion_(0), fd_(NULL), next_file_offset_(0), shnum_(1), sections_(),
+      abiversion_(0), fd_(-1), next_file_offset_(0), shnum_(1), sections_(),
       section_id_map_(), shoff_(0), shstrndx_(0), have_strings_(false),
       stringpool_(), shstrtab_(), cu_index_(), tu_index_(), last_type_sig_(0),
       last_tu_slot_(0)
@@ -473,12 +604,14 @@ class Dwp_output_file
 
   // Add a string to the debug strings section.
   section_offset_type
-  add_string(const char* str, size_t len);
+  add_string(const char* str, size_t len, size_t hash_code);
 
-  // Add a section to the output file, and return the new section offset.
+  // Add a contribution of LEN bytes to a section of the output file,
+  // and return its offset within the output section.  The contents
+  // are written later by write_contribution.
   section_offset_type
-  add_contribution(elfcpp::DW_SECT section_id, const unsigned char* contents,
-		   section_size_type len, int align);
+  add_contribution(elfcpp::DW_SECT section_id, section_size_type len,
+		   int align);
 
   // Add a set of .debug_info and related sections to the output file.
   void
@@ -492,20 +625,24 @@ class Dwp_output_file
   void
   add_tu_set(Unit_set* tu_set);
 
+  // Assign file offsets to the sections which hold the contributions
+  // of the input files.  This is called after all the input files
+  // have been read.
+  void
+  layout_sections();
+
+  // Write the contents of a contribution at OFFSET within an output
+  // section.  This may be called from several threads at once.
+  void
+  write_contribution(elfcpp::DW_SECT section_id, section_offset_type offset,
+		     const unsigned char* contents, section_size_type len);
+
   // Finalize the file, write the string tables and index sections,
   // and close the file.
   void
   finalize();
 
  private:
-  // Contributions to output sections.
-  struct Contribution
-  {
-    section_offset_type output_offset;
-    section_size_type size;
-    const unsigned char* contents;
-  };
-
   // Sections in the output file.
   struct Section
   {
@@ -513,10 +650,9 @@ class Dwp_output_file
     off_t offset;
     section_size_type size;
     int align;
-    std::vector<Contribution> contributions;
 
     Section(const char* n, int a)
-      : name(n), offset(0), size(0), align(a), contributions()
+      : name(n), offset(0), size(0), align(a)
     { }
   };
 
@@ -613,6 +749,11 @@ class Dwp_output_file
   unsigned int
   add_output_section(const char* section_name, int align);
 
+  // Write LEN bytes from CONTENTS at file offset OFFSET.  Return
+  // false on error.
+  bool
+  write_to_file(off_t offset, const unsigned char* contents, size_t len);
+
   // Write a new section to the output file.
   void
   write_new_section(const char* section_name, const unsigned char* contents,
@@ -626,23 +767,21 @@ class Dwp_output_file
   void
   sized_write_ehdr();
 
-  // Write a section header.
-  void
-  write_shdr(const char* name, unsigned int type, unsigned int flags,
-	     uint64_t addr, off_t offset, section_size_type sect_size,
-	     unsigned int link, unsigned int info,
-	     unsigned int align, unsigned int ent_size);
+  // Write a section header at file offset SHDR_OFFSET, and return
+  // the file offset of the next section header.
+  off_t
+  write_shdr(off_t shdr_offset, const char* name, unsigned int type,
+	     unsigned int flags, uint64_t addr, off_t offset,
+	     section_size_type sect_size, unsigned int link,
+	     unsigned int info, unsigned int align, unsigned int ent_size);
 
   template<unsigned int size, bool big_endian>
-  void
-  sized_write_shdr(const char* name, unsigned int type, unsigned int flags,
-		   uint64_t addr, off_t offset, section_size_type sect_size,
-		   unsigned int link, unsigned int info,
-		   unsigned int align, unsigned int ent_size);
-
-  // Write the contributions to an output section.
-  void
-  write_contributions(const Section& sect);
+  off_t
+  sized_write_shdr(off_t shdr_offset, const char* name, unsigned int type,
+		   unsigned int flags, uint64_t addr, off_t offset,
+		   section_size_type sect_size, unsigned int link,
+		   unsigned int info, unsigned int align,
+		   unsigned int ent_size);
 
   // Write a CU or TU index section.
   template<bool big_endian>
@@ -658,7 +797,7 @@ class Dwp_output_file
   int osabi_;
   int abiversion_;
   // The output file descriptor.
-  FILE* fd_;
+  int fd_;
   // Next available file offset.
   off_t next_file_offset_;
   // The number of sections.
@@ -719,23 +858,23 @@ class Dwo_name_info_reader : public Dwarf_info_reader
   File_list* files_;
 };
 
-// A specialization of Dwarf_info_reader, for reading DWARF CUs and TUs
-// and adding them to the output file.
+// A specialization of Dwarf_info_reader, for finding the DWARF CUs
+// and TUs in a section.
 
 class Unit_reader : public Dwarf_info_reader
 {
  public:
   Unit_reader(bool is_type_unit, Relobj* object, unsigned int shndx)
     : Dwarf_info_reader(is_type_unit, object, NULL, 0, shndx, 0, 0),
-      output_file_(NULL), sections_(NULL)
+      shndx_(shndx), units_(NULL)
   { }
 
   ~Unit_reader()
   { }
 
-  // Read the CUs or TUs and add them to the output file.
+  // Read the CUs or TUs and append them to UNITS.
   void
-  add_units(Dwp_output_file*, unsigned int debug_abbrev, Section_bounds*);
+  get_units(unsigned int debug_abbrev, Unit_list* units);
 
  protected:
   // Visit a compilation unit.
@@ -748,8 +887,70 @@ class Unit_reader : public Dwarf_info_reader
 		  uint64_t signature, Dwarf_die*);
 
  private:
+  // The section being read.
+  unsigned int shndx_;
+  // The list of units to populate.
+  Unit_list* units_;
+};
+
+// A task to scan an input file.
+
+class Dwo_scan_task : public Task
+{
+ public:
+  Dwo_scan_task(Dwo_file* dwo_file)
+    : dwo_file_(dwo_file)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->scan(); }
+
+  std::string
+  get_name() const
+  { return "Dwo_scan_task"; }
+
+ private:
+  Dwo_file* dwo_file_;
+};
+
+// A task to write the contributions of an input file to the output
+// file.
+
+class Dwo_write_task : public Task
+{
+ public:
+  Dwo_write_task(Dwo_file* dwo_file, Dwp_output_file* output_file)
+    : dwo_file_(dwo_file), output_file_(output_file)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->write(this->output_file_); }
+
+  std::string
+  get_name() const
+  { return "Dwo_write_task"; }
+
+ private:
+  Dwo_file* dwo_file_;
   Dwp_output_file* output_file_;
-  Section_bounds* sections_;
 };
 
 // Return the name of a DWARF .dwo section.
@@ -845,11 +1046,27 @@ Sized_relobj_dwo<size, big_endian>::do_decompressed_section_contents(
 // Class Dwo_file.
 
 Dwo_file::~Dwo_file()
+{
+  this->close();
+  if (this->strings_ != NULL)
+    delete[] this->strings_;
+  if (this->cu_index_ != NULL)
+    delete[] this->cu_index_;
+  if (this->tu_index_ != NULL)
+    delete[] this->tu_index_;
+}
+
+// Close the input file.
+
+void
+Dwo_file::close()
 {
   if (this->obj_ != NULL)
     delete this->obj_;
+  this->obj_ = NULL;
   if (this->input_file_ != NULL)
     delete this->input_file_;
+  this->input_file_ = NULL;
 }
 
 // Read the input executable file and extract the list of .dwo files
@@ -858,7 +1075,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -898,25 +1115,18 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Read the input file and collect the sections, strings, and units
+// that it will contribute to the output file.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::scan()
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
-
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
+  this->section_sizes_.resize(shnum);
 
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
@@ -936,64 +1146,206 @@ Dwo_file::read(Dwp_output_file* output_file)
       else
 	continue;
       if (strcmp(suffix, "info.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_INFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LINE] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LINE] = i;
       else if (strcmp(suffix, "loc.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_LOC] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACINFO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACINFO] = i;
       else if (strcmp(suffix, "macro.dwo") == 0)
-	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
+	this->debug_shndx_[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
+    }
+
+  // Record the sizes of the sections which are copied whole.
+  for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+    {
+      unsigned int shndx = this->debug_shndx_[i];
+      if (shndx > 0)
+	this->section_sizes_[shndx] = this->uncompressed_section_size(shndx);
     }
 
+  // Save the input string table.
+  this->scan_strings(this->debug_str_);
+
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
+    {
+      // This is a .dwp file.  Save the index sections; the units are
+      // found from the indexes when the file is read.
+      if (this->debug_cu_index_ > 0)
+	this->cu_index_ = this->copy_section_contents(this->debug_cu_index_,
+						      &this->cu_index_len_);
+      if (this->debug_tu_index_ > 0)
+	{
+	  if (this->debug_types_.size() > 1)
+	    gold_fatal(_("%s: .dwp file must have no more than one "
+			 ".debug_types.dwo section"), this->name_);
+	  this->tu_index_ = this->copy_section_contents(this->debug_tu_index_,
+							&this->tu_index_len_);
+	}
+    }
+  else if (this->debug_shndx_[elfcpp::DW_SECT_INFO] > 0
+	   || !this->debug_types_.empty())
+    {
+      // This is a .dwo file.  Parse the .debug_info.dwo section and each
+      // .debug_types.dwo section to find the compilation and type units.
+      unsigned int debug_abbrev = this->debug_shndx_[elfcpp::DW_SECT_ABBREV];
+      if (debug_abbrev == 0)
+	gold_fatal(_("%s: no .debug_abbrev.dwo section found"), this->name_);
+
+      if (this->debug_shndx_[elfcpp::DW_SECT_INFO] > 0)
+	{
+	  Unit_reader reader(false, this->obj_,
+			     this->debug_shndx_[elfcpp::DW_SECT_INFO]);
+	  reader.get_units(debug_abbrev, &this->units_);
+	}
+      for (std::vector<unsigned int>::const_iterator tp =
+	     this->debug_types_.begin();
+	   tp != this->debug_types_.end();
+	   ++tp)
+	{
+	  Unit_reader reader(true, this->obj_, *tp);
+	  reader.get_units(debug_abbrev, &this->units_);
+	}
+    }
+
+  // Don't keep the input file open.  We open it again to write the
+  // contributions once the output file has been laid out.
+  this->close();
+}
+
+// Send the contents found by scan() to OUTPUT_FILE.
+
+void
+Dwo_file::read(Dwp_output_file* output_file)
+{
+  output_file->record_target_info(this->name_, this->machine_, this->size_,
+				  this->big_endian_, this->osabi_,
+				  this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
-        {
-	  if (debug_types.size() > 1)
-	    gold_fatal(_("%s: .dwp file must have no more than one "
-			 ".debug_types.dwo section"), this->name_);
-          if (debug_types.size() == 1)
-            debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
-          else
-            debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+      if (this->cu_index_ != NULL)
+	{
+	  this->read_unit_index(this->cu_index_, this->cu_index_len_,
+				debug_shndx, output_file, false);
+	  delete[] this->cu_index_;
+	  this->cu_index_ = NULL;
+	}
+      if (this->tu_index_ != NULL)
+	{
+	  if (this->debug_types_.size() == 1)
+	    debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
+	  else
+	    debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
+	  this->read_unit_index(this->tu_index_, this->tu_index_len_,
+				debug_shndx, output_file, true);
+	  delete[] this->tu_index_;
+	  this->tu_index_ = NULL;
 	}
       return;
     }
 
   // If we found no index sections, this is a .dwo file.
+  Unit_list::const_iterator unit = this->units_.begin();
   if (debug_shndx[elfcpp::DW_SECT_INFO] > 0)
-    this->add_unit_set(output_file, debug_shndx, false);
+    this->add_unit_set(output_file, debug_shndx, false, &unit);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
-       tp != debug_types.end();
+  for (std::vector<unsigned int>::const_iterator tp =
+	 this->debug_types_.begin();
+       tp != this->debug_types_.end();
        ++tp)
     {
       debug_shndx[elfcpp::DW_SECT_TYPES] = *tp;
-      this->add_unit_set(output_file, debug_shndx, true);
+      this->add_unit_set(output_file, debug_shndx, true, &unit);
     }
+  gold_assert(unit == this->units_.end());
+
+  // We no longer need the list of units.
+  Unit_list().swap(this->units_);
+}
+
+// Copy this file's contributions into OUTPUT_FILE.  Each contribution
+// is written directly from the input file's view of the section, so
+// the contents are not held in memory.
+
+void
+Dwo_file::write(Dwp_output_file* output_file)
+{
+  if (this->contributions_.empty())
+    return;
+
+  this->obj_ = this->make_object();
+
+  // Sort the contributions by input section, so that we get the
+  // contents of each section only once.
+  std::stable_sort(this->contributions_.begin(), this->contributions_.end(),
+		   Contribution_compare());
+
+  unsigned int shndx = 0;
+  const unsigned char* contents = NULL;
+  section_size_type len = 0;
+  bool is_new = false;
+  for (std::vector<Contribution>::const_iterator p =
+	 this->contributions_.begin();
+       p != this->contributions_.end();
+       ++p)
+    {
+      if (p->size == 0)
+	continue;
+
+      if (p->shndx != shndx)
+	{
+	  if (is_new)
+	    delete[] contents;
+	  shndx = p->shndx;
+	  contents = this->section_contents(shndx, &len, &is_new);
+	}
+
+      if (p->input_offset < 0
+	  || static_cast<section_size_type>(p->input_offset) > len
+	  || p->size > len - p->input_offset)
+	gold_fatal(_("%s: section %s is corrupt"), this->name_,
+		   this->section_name(shndx).c_str());
+
+      const unsigned char* data = contents + p->input_offset;
+      if (p->section_id == elfcpp::DW_SECT_STR_OFFSETS)
+	{
+	  unsigned char* remapped = this->remap_str_offsets(data, p->size);
+	  output_file->write_contribution(p->section_id, p->output_offset,
+					  remapped, p->size);
+	  delete[] remapped;
+	}
+      else
+	output_file->write_contribution(p->section_id, p->output_offset,
+					data, p->size);
+    }
+  if (is_new)
+    delete[] contents;
+
+  this->close();
 }
 
 // Verify a .dwp file given a list of .dwo files referenced by the
@@ -1003,7 +1355,7 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object();
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -1042,7 +1394,7 @@ Dwo_file::verify(const File_list& files)
 // and record the target info.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object()
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
@@ -1076,15 +1428,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
-	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<32, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
-	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<32, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1093,15 +1443,13 @@ Dwo_file::make_object(Dwp_output_file* output_file)
     {
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
-	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+	return this->sized_make_object<64, true>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
-	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+	return this->sized_make_object<64, false>(elf_header, input_file);
 #else
 	gold_unreachable();
 #endif
@@ -1115,39 +1463,70 @@ Dwo_file::make_object(Dwp_output_file* output_file)
 
 template <int size, bool big_endian>
 Relobj*
-Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
-  if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_e_ident()[elfcpp::EI_OSABI],
-	ehdr.get_e_ident()[elfcpp::EI_ABIVERSION]);
+  this->machine_ = ehdr.get_e_machine();
+  this->size_ = size;
+  this->big_endian_ = big_endian;
+  this->osabi_ = ehdr.get_e_ident()[elfcpp::EI_OSABI];
+  this->abiversion_ = ehdr.get_e_ident()[elfcpp::EI_ABIVERSION];
   return obj;
 }
 
-// Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
-// and process the CU or TU sets.
+// Return the size of a section after decompression.
+
+section_size_type
+Dwo_file::uncompressed_section_size(unsigned int shndx)
+{
+  if (!this->is_compressed_[shndx])
+    return convert_to_section_size_type(this->obj_->section_size(shndx));
+
+  section_size_type len;
+  const unsigned char* contents = this->obj_->section_contents(shndx, &len,
+							       false);
+  return convert_to_section_size_type(get_uncompressed_size(contents, len));
+}
+
+// Return a copy of the contents of a section, decompressed if
+// necessary.  Set *PLEN to the size.  The caller must delete the copy.
+
+unsigned char*
+Dwo_file::copy_section_contents(unsigned int shndx, section_size_type* plen)
+{
+  bool is_new;
+  const unsigned char* contents = this->section_contents(shndx, plen, &is_new);
+  if (is_new)
+    return const_cast<unsigned char*>(contents);
+  unsigned char* copy = new unsigned char[*plen];
+  memcpy(copy, contents, *plen);
+  return copy;
+}
+
+// Process the CU or TU sets in the saved contents of the .debug_cu_index
+// or .debug_tu_index section of a .dwp file.
 
 void
-Dwo_file::read_unit_index(unsigned int shndx, unsigned int *debug_shndx,
+Dwo_file::read_unit_index(const unsigned char* contents,
+			  section_size_type index_len,
+			  unsigned int *debug_shndx,
 			  Dwp_output_file* output_file, bool is_tu_index)
 {
-  if (this->obj_->is_big_endian())
-    this->sized_read_unit_index<true>(shndx, debug_shndx, output_file,
-				      is_tu_index);
+  if (this->big_endian_)
+    this->sized_read_unit_index<true>(contents, index_len, debug_shndx,
+				      output_file, is_tu_index);
   else
-    this->sized_read_unit_index<false>(shndx, debug_shndx, output_file,
-				       is_tu_index);
+    this->sized_read_unit_index<false>(contents, index_len, debug_shndx,
+				       output_file, is_tu_index);
 }
 
 template <bool big_endian>
 void
-Dwo_file::sized_read_unit_index(unsigned int shndx,
+Dwo_file::sized_read_unit_index(const unsigned char* contents,
+				section_size_type index_len,
 				unsigned int *debug_shndx,
 				Dwp_output_file* output_file,
 				bool is_tu_index)
@@ -1156,13 +1535,9 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 			       ? elfcpp::DW_SECT_TYPES
 			       : elfcpp::DW_SECT_INFO);
   unsigned int info_shndx = debug_shndx[info_sect];
-
-  gold_assert(shndx > 0);
-
-  section_size_type index_len;
-  bool index_is_new;
-  const unsigned char* contents =
-      this->section_contents(shndx, &index_len, &index_is_new);
+  const char* index_name = (is_tu_index
+			    ? ".debug_tu_index"
+			    : ".debug_cu_index");
 
   unsigned int version =
       elfcpp::Swap_unaligned<32, big_endian>::readval(contents);
@@ -1172,7 +1547,7 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
   // produced by an earlier version of the tool.
   if (version != 2)
     gold_fatal(_("%s: section %s has unsupported version number %d"),
-	       this->name_, this->section_name(shndx).c_str(), version);
+	       this->name_, index_name, version);
 
   unsigned int ncols =
       elfcpp::Swap_unaligned<32, big_endian>::readval(contents
@@ -1197,8 +1572,7 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
   const unsigned char* pend = psizes + nused * ncols * sizeof(uint32_t);
 
   if (pend > contents + index_len)
-    gold_fatal(_("%s: section %s is corrupt"), this->name_,
-	       this->section_name(shndx).c_str());
+    gold_fatal(_("%s: section %s is corrupt"), this->name_, index_name);
 
   // Copy the related sections and track the section offsets and sizes.
   Section_bounds sections[elfcpp::DW_SECT_MAX + 1];
@@ -1209,12 +1583,6 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 					 static_cast<elfcpp::DW_SECT>(i));
     }
 
-  // Get the contents of the .debug_info.dwo or .debug_types.dwo section.
-  section_size_type info_len;
-  bool info_is_new;
-  const unsigned char* info_contents =
-      this->section_contents(info_shndx, &info_len, &info_is_new);
-
   // Loop over the slots of the hash table.
   for (unsigned int i = 0; i < nslots; ++i)
     {
@@ -1250,22 +1618,11 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 	      psrow += sizeof(uint32_t);
 	    }
 
-	  const unsigned char* unit_start =
-	      info_contents + unit_set->sections[info_sect].offset;
+	  section_offset_type unit_start = unit_set->sections[info_sect].offset;
 	  section_size_type unit_length = unit_set->sections[info_sect].size;
-
-	  // Dwp_output_file::add_contribution writes the .debug_info.dwo
-	  // section directly to the output file, so we only need to
-	  // duplicate contributions for .debug_types.dwo section.
-	  if (is_tu_index)
-	    {
-	      unsigned char *copy = new unsigned char[unit_length];
-	      memcpy(copy, unit_start, unit_length);
-	      unit_start = copy;
-	    }
 	  section_offset_type off =
-	      output_file->add_contribution(info_sect, unit_start,
-					    unit_length, 1);
+	      this->add_contribution(output_file, info_shndx, info_sect,
+				     unit_start, unit_length);
 	  unit_set->sections[info_sect].offset = off;
 	  if (is_tu_index)
 	    output_file->add_tu_set(unit_set);
@@ -1275,11 +1632,6 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
       phash += sizeof(uint64_t);
       pindex += sizeof(uint32_t);
     }
-
-  if (index_is_new)
-    delete[] contents;
-  if (info_is_new)
-    delete[] info_contents;
 }
 
 // Verify the .debug_cu_index section of a .dwp file, comparing it
@@ -1378,15 +1730,17 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
   return nmissing == 0;
 }
 
-// Merge the input string table section into the output file.
+// Save the input string table section, and compute the hash code of
+// each string, so that the strings can be added to the output string
+// pool quickly.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::scan_strings(unsigned int debug_str)
 {
   section_size_type len;
-  bool is_new;
-  const unsigned char* pdata = this->section_contents(debug_str, &len, &is_new);
-  const char* p = reinterpret_cast<const char*>(pdata);
+  this->strings_ = this->copy_section_contents(debug_str, &len);
+  this->strings_len_ = len;
+  const char* p = reinterpret_cast<const char*>(this->strings_);
   const char* pend = p + len;
 
   // Check that the last string is null terminated.
@@ -1396,34 +1750,70 @@ Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
 	       this->name_,
 	       this->section_name(debug_str).c_str());
 
-  // Count the number of strings in the section, and size the map.
-  size_t count = 0;
-  for (const char* pt = p; pt < pend; pt += strlen(pt) + 1)
-    ++count;
-  this->str_offset_map_.reserve(count + 1);
+  while (p < pend)
+    {
+      size_t len = strlen(p);
+      this->string_hashes_.push_back(Stringpool::hash_string(p, len));
+      p += len + 1;
+    }
+}
+
+// Merge the input string table section into the output file.
+
+void
+Dwo_file::add_strings(Dwp_output_file* output_file)
+{
+  const char* p = reinterpret_cast<const char*>(this->strings_);
+  const char* pend = p + this->strings_len_;
+
+  this->str_offset_map_.reserve(this->string_hashes_.size() + 1);
 
   // Add the strings to the output string table, and record the new offsets
   // in the map.
+  std::vector<size_t>::const_iterator hash = this->string_hashes_.begin();
   section_offset_type i = 0;
   section_offset_type new_offset;
   while (p < pend)
     {
       size_t len = strlen(p);
-      new_offset = output_file->add_string(p, len);
+      gold_assert(hash != this->string_hashes_.end());
+      new_offset = output_file->add_string(p, len, *hash);
       this->str_offset_map_.push_back(std::make_pair(i, new_offset));
       p += len + 1;
       i += len + 1;
+      ++hash;
     }
   new_offset = 0;
   this->str_offset_map_.push_back(std::make_pair(i, new_offset));
-  if (is_new)
-    delete[] pdata;
+  std::vector<size_t>().swap(this->string_hashes_);
+
+  // The output string pool has its own copies of the strings.
+  delete[] this->strings_;
+  this->strings_ = NULL;
+  this->strings_len_ = 0;
+}
+
+// Add a contribution of LEN bytes at INPUT_OFFSET in input section SHNDX
+// to OUTPUT_FILE, and return its offset within the output section.  The
+// contents are copied by write().
+
+section_offset_type
+Dwo_file::add_contribution(Dwp_output_file* output_file, unsigned int shndx,
+			   elfcpp::DW_SECT section_id,
+			   section_offset_type input_offset,
+			   section_size_type len)
+{
+  section_offset_type off = output_file->add_contribution(section_id, len, 1);
+  Contribution contrib = { shndx, section_id, input_offset, off, len };
+  this->contributions_.push_back(contrib);
+  return off;
 }
 
 // Copy a section from the input file to the output file.
 // Return the offset and length of this input section's contribution
-// in the output section.  If copying .debug_str_offsets.dwo, remap
-// the string offsets for the output string table.
+// in the output section.  If copying .debug_str_offsets.dwo, the
+// string offsets are remapped for the output string table when the
+// contents are written.
 
 Section_bounds
 Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
@@ -1434,32 +1824,9 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   if (this->sect_offsets_[shndx].size > 0)
     return this->sect_offsets_[shndx];
 
-  // Get the section contents. Upon return, if IS_NEW is true, the memory
-  // has been allocated via new; if false, the memory is part of the mapped
-  // input file, and we will need to duplicate it so that it will persist
-  // after we close the input file.
-  section_size_type len;
-  bool is_new;
-  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
-
-  if (section_id == elfcpp::DW_SECT_STR_OFFSETS)
-    {
-      const unsigned char* remapped = this->remap_str_offsets(contents, len);
-      if (is_new)
-	delete[] contents;
-      contents = remapped;
-    }
-  else if (!is_new)
-    {
-      unsigned char* copy = new unsigned char[len];
-      memcpy(copy, contents, len);
-      contents = copy;
-    }
-
-  // Add the contents of the input section to the output section.
-  // The output file takes ownership of the memory pointed to by CONTENTS.
-  section_offset_type off = output_file->add_contribution(section_id, contents,
-							  len, 1);
+  section_size_type len = this->section_sizes_[shndx];
+  section_offset_type off = this->add_contribution(output_file, shndx,
+						   section_id, 0, len);
 
   // Store the output section bounds.
   Section_bounds bounds(off, len);
@@ -1468,8 +1835,10 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   return bounds;
 }
 
-// Remap the 
-const unsigned char*
+// Remap the string offsets in the .debug_str_offsets.dwo section.
+// Return a new buffer, which the caller must delete.
+
+unsigned char*
 Dwo_file::remap_str_offsets(const unsigned char* contents,
 			    section_size_type len)
 {
@@ -1477,14 +1846,14 @@ Dwo_file::remap_str_offsets(const unsigned char* contents,
     gold_fatal(_("%s: .debug_str_offsets.dwo section size not a multiple of 4"),
 	       this->name_);
 
-  if (this->obj_->is_big_endian())
+  if (this->big_endian_)
     return this->sized_remap_str_offsets<true>(contents, len);
   else
     return this->sized_remap_str_offsets<false>(contents, len);
 }
 
 template <bool big_endian>
-const unsigned char*
+unsigned char*
 Dwo_file::sized_remap_str_offsets(const unsigned char* contents,
 				  section_size_type len)
 {
@@ -1530,11 +1899,12 @@ Dwo_file::remap_str_offset(section_offset_type val)
 
 void
 Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
-		       bool is_debug_types)
+		       bool is_debug_types, Unit_list::const_iterator* punit)
 {
-  unsigned int shndx = (is_debug_types
-			? debug_shndx[elfcpp::DW_SECT_TYPES]
-			: debug_shndx[elfcpp::DW_SECT_INFO]);
+  elfcpp::DW_SECT info_sect = (is_debug_types
+			       ? elfcpp::DW_SECT_TYPES
+			       : elfcpp::DW_SECT_INFO);
+  unsigned int shndx = debug_shndx[info_sect];
 
   gold_assert(shndx != 0);
 
@@ -1550,11 +1920,29 @@ Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
 					 static_cast<elfcpp::DW_SECT>(i));
     }
 
-  // Parse the .debug_info or .debug_types section and add each compilation
-  // or type unit to the output file, along with the contributions to the
-  // related sections.
-  Unit_reader reader(is_debug_types, this->obj_, shndx);
-  reader.add_units(output_file, debug_shndx[elfcpp::DW_SECT_ABBREV], sections);
+  // Add each compilation or type unit found in the .debug_info or
+  // .debug_types section by scan() to the output file, along with the
+  // contributions to the related sections.
+  Unit_list::const_iterator& p(*punit);
+  for (; p != this->units_.end() && p->shndx == shndx; ++p)
+    {
+      if (is_debug_types && output_file->lookup_tu(p->signature))
+	continue;
+
+      Unit_set* unit_set = new Unit_set();
+      unit_set->signature = p->signature;
+      for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+	unit_set->sections[i] = sections[i];
+
+      section_offset_type off = this->add_contribution(output_file, shndx,
+						       info_sect, p->offset,
+						       p->length);
+      unit_set->sections[info_sect] = Section_bounds(off, p->length);
+      if (is_debug_types)
+	output_file->add_tu_set(unit_set);
+      else
+	output_file->add_cu_set(unit_set);
+    }
 }
 
 // Class Dwp_output_file.
@@ -1585,25 +1973,22 @@ Dwp_output_file::record_target_info(const char*, int machine,
   else
     gold_unreachable();
 
-  this->fd_ = ::fopen(this->name_, "wb");
-  if (this->fd_ == NULL)
-    gold_fatal(_("%s: %s"), this->name_, strerror(errno));
-
-  // Write zeroes for the ELF header initially.  We'll write
-  // the actual header during finalize().
-  static const char buf[elfcpp::Elf_sizes<64>::ehdr_size] = { 0 };
-  if (::fwrite(buf, 1, this->next_file_offset_, this->fd_)
-      < (size_t) this->next_file_offset_)
+  // We'll write the actual ELF header during finalize().
+  this->fd_ = open_descriptor(-1, this->name_, O_WRONLY | O_CREAT | O_TRUNC,
+			      0666);
+  if (this->fd_ < 0)
     gold_fatal(_("%s: %s"), this->name_, strerror(errno));
 }
 
-// Add a string to the debug strings section.
+// Add a string to the debug strings section.  HASH_CODE is the hash
+// code of the string, from Stringpool::hash_string.  The string is
+// copied, so the input string table may be freed afterwards.
 
 section_offset_type
-Dwp_output_file::add_string(const char* str, size_t len)
+Dwp_output_file::add_string(const char* str, size_t len, size_t hash_code)
 {
   Stringpool::Key key;
-  this->stringpool_.add_with_length(str, len, true, &key);
+  this->stringpool_.add_prehashed(str, len, hash_code, true, &key);
   this->have_strings_ = true;
   // We aren't supposed to call get_offset() until after
   // calling set_string_offsets(), but the offsets will
@@ -1631,14 +2016,13 @@ Dwp_output_file::add_output_section(const char* section_name, int align)
 
 // Add a contribution to a section in the output file, and return the offset
 // of the contribution within the output section.  The .debug_info.dwo section
-// is expected to be the largest one, so we will write the contents of this
-// section directly to the output file as we receive contributions, allowing
-// us to free that memory as soon as possible. We will save the remaining
-// contributions until we finalize the layout of the output file.
+// is expected to be the largest one, so we place it in the output file as we
+// receive contributions.  We lay out the remaining sections after all the
+// input files have been read.  The contents of all contributions are
+// written later, by write_contribution.
 
 section_offset_type
 Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
-				  const unsigned char* contents,
 				  section_size_type len,
 				  int align)
 {
@@ -1662,8 +2046,7 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
 
   if (section_id == elfcpp::DW_SECT_INFO)
     {
-      // Write the .debug_info.dwo section directly.
-      // We do not need to free the memory in this case.
+      // Place the .debug_info.dwo section directly.
       off_t file_offset = this->next_file_offset_;
       gold_assert(this->size_ > 0 && file_offset > 0);
 
@@ -1685,27 +2068,58 @@ Dwp_output_file::add_contribution(elfcpp::DW_SECT section_id,
 
       section_offset = file_offset - section.offset;
       section.size = file_offset + len - section.offset;
-
-      ::fseek(this->fd_, file_offset, SEEK_SET);
-      if (::fwrite(contents, 1, len, this->fd_) < len)
-	gold_fatal(_("%s: error writing section '%s'"), this->name_,
-		   section_name);
       this->next_file_offset_ = file_offset + len;
     }
   else
     {
-      // Collect the contributions and keep track of the total size.
+      // Keep track of the total size.
       if (align > section.align)
 	section.align = align;
       section_offset = align_offset(section.size, align);
       section.size = section_offset + len;
-      Contribution contrib = { section_offset, len, contents };
-      section.contributions.push_back(contrib);
     }
 
   return section_offset;
 }
 
+// Assign file offsets to the sections which hold the contributions of
+// the input files.
+
+void
+Dwp_output_file::layout_sections()
+{
+  for (unsigned int i = 0; i < this->sections_.size(); i++)
+    {
+      Section& sect = this->sections_[i];
+      // If the offset has already been assigned, the section has
+      // been placed.
+      if (sect.offset > 0 || sect.size == 0)
+	continue;
+      off_t file_offset = this->next_file_offset_;
+      file_offset = align_offset(file_offset, sect.align);
+      sect.offset = file_offset;
+      this->next_file_offset_ = file_offset + sect.size;
+    }
+}
+
+// Write the contents of a contribution at OFFSET within an output section.
+
+void
+Dwp_output_file::write_contribution(elfcpp::DW_SECT section_id,
+				    section_offset_type offset,
+				    const unsigned char* contents,
+				    section_size_type len)
+{
+  gold_assert(static_cast<size_t>(section_id) < this->section_id_map_.size());
+  unsigned int shndx = this->section_id_map_[section_id];
+  gold_assert(shndx > 0);
+  const Section& section = this->sections_[shndx - 1];
+  gold_assert(section.offset > 0 && offset + len <= section.size);
+  if (!this->write_to_file(section.offset + offset, contents, len))
+    gold_fatal(_("%s: error writing section '%s'"), this->name_,
+	       section.name);
+}
+
 // Add a set of .debug_info and related sections to the output file.
 
 void
@@ -1856,20 +2270,6 @@ Dwp_output_file::finalize()
 {
   unsigned char* buf;
 
-  // Write the accumulated output sections.
-  for (unsigned int i = 0; i < this->sections_.size(); i++)
-    {
-      Section& sect = this->sections_[i];
-      // If the offset has already been assigned, the section has been written.
-      if (sect.offset > 0 || sect.size == 0)
-	continue;
-      off_t file_offset = this->next_file_offset_;
-      file_offset = align_offset(file_offset, sect.align);
-      sect.offset = file_offset;
-      this->write_contributions(sect);
-      this->next_file_offset_ = file_offset + sect.size;
-    }
-
   // Write the debug string table.
   if (this->have_strings_)
     {
@@ -1905,8 +2305,7 @@ Dwp_output_file::finalize()
   buf = new unsigned char[shstrtab_len];
   this->shstrtab_.write_to_buffer(buf, shstrtab_len);
   off_t shstrtab_off = file_offset;
-  ::fseek(this->fd_, file_offset, 0);
-  if (::fwrite(buf, 1, shstrtab_len, this->fd_) < shstrtab_len)
+  if (!this->write_to_file(file_offset, buf, shstrtab_len))
     gold_fatal(_("%s: error writing section '.shstrtab'"), this->name_);
   delete[] buf;
   file_offset += shstrtab_len;
@@ -1916,48 +2315,56 @@ Dwp_output_file::finalize()
   // .shstrtab section header.
   file_offset = align_offset(file_offset, this->size_ == 32 ? 4 : 8);
   this->shoff_ = file_offset;
-  ::fseek(this->fd_, file_offset, 0);
   section_size_type sh0_size = 0;
   unsigned int sh0_link = 0;
   if (this->shnum_ >= elfcpp::SHN_LORESERVE)
     sh0_size = this->shnum_;
   if (this->shstrndx_ >= elfcpp::SHN_LORESERVE)
     sh0_link = this->shstrndx_;
-  this->write_shdr(NULL, 0, 0, 0, 0, sh0_size, sh0_link, 0, 0, 0);
+  file_offset = this->write_shdr(file_offset, NULL, 0, 0, 0, 0, sh0_size,
+				 sh0_link, 0, 0, 0);
   for (unsigned int i = 0; i < this->sections_.size(); ++i)
     {
       Section& sect = this->sections_[i];
-      this->write_shdr(sect.name, elfcpp::SHT_PROGBITS, 0, 0, sect.offset,
-		       sect.size, 0, 0, sect.align, 0);
+      file_offset = this->write_shdr(file_offset, sect.name,
+				     elfcpp::SHT_PROGBITS, 0, 0, sect.offset,
+				     sect.size, 0, 0, sect.align, 0);
     }
-  this->write_shdr(shstrtab_name, elfcpp::SHT_STRTAB, 0, 0,
+  this->write_shdr(file_offset, shstrtab_name, elfcpp::SHT_STRTAB, 0, 0,
 		   shstrtab_off, shstrtab_len, 0, 0, 1, 0);
 
   // Write the ELF header.
   this->write_ehdr();
 
   // Close the file.
-  if (this->fd_ != NULL)
+  if (this->fd_ >= 0)
     {
-      if (::fclose(this->fd_) != 0)
+      if (::close(this->fd_) != 0)
 	gold_fatal(_("%s: %s"), this->name_, strerror(errno));
     }
-  this->fd_ = NULL;
+  this->fd_ = -1;
 }
 
-// Write the contributions to an output section.
+// Write LEN bytes from CONTENTS at file offset OFFSET.  Return false
+// on error.  This uses pwrite, so several threads may write to
+// different parts of the file at once.
 
-void
-Dwp_output_file::write_contributions(const Section& sect)
+bool
+Dwp_output_file::write_to_file(off_t offset, const unsigned char* contents,
+			       size_t len)
 {
-  for (unsigned int i = 0; i < sect.contributions.size(); ++i)
+  while (len > 0)
     {
-      const Contribution& c = sect.contributions[i];
-      ::fseek(this->fd_, sect.offset + c.output_offset, SEEK_SET);
-      if (::fwrite(c.contents, 1, c.size, this->fd_) < c.size)
-	gold_fatal(_("%s: error writing section '%s'"), this->name_, sect.name);
-      delete[] c.contents;
+      ssize_t written = ::pwrite(this->fd_, contents, len, offset);
+      if (written < 0 && errno == EINTR)
+	continue;
+      if (written <= 0)
+	return false;
+      contents += written;
+      offset += written;
+      len -= written;
     }
+  return true;
 }
 
 // Write a new section to the output file.
@@ -1976,8 +2383,7 @@ Dwp_output_file::write_new_section(const char* section_name,
   file_offset = align_offset(file_offset, align);
   section.offset = file_offset;
   section.size = len;
-  ::fseek(this->fd_, file_offset, SEEK_SET);
-  if (::fwrite(contents, 1, len, this->fd_) < len)
+  if (!this->write_to_file(file_offset, contents, len))
     gold_fatal(_("%s: error writing section '%s'"), this->name_, section_name);
   this->next_file_offset_ = file_offset + len;
 }
@@ -2155,16 +2561,17 @@ Dwp_output_file::sized_write_ehdr()
 		      ? this->shstrndx_
 		      : static_cast<unsigned int>(elfcpp::SHN_XINDEX));
 
-  ::fseek(this->fd_, 0, 0);
-  if (::fwrite(buf, 1, ehdr_size, this->fd_) < ehdr_size)
+  if (!this->write_to_file(0, buf, ehdr_size))
     gold_fatal(_("%s: error writing ELF header"), this->name_);
 }
 
-// Write a section header.
+// Write a section header at file offset SHDR_OFFSET, and return the
+// file offset of the next section header.
 
-void
-Dwp_output_file::write_shdr(const char* name, unsigned int type,
-			    unsigned int flags, uint64_t addr, off_t offset,
+off_t
+Dwp_output_file::write_shdr(off_t shdr_offset, const char* name,
+			    unsigned int type, unsigned int flags,
+			    uint64_t addr, off_t offset,
 			    section_size_type sect_size, unsigned int link,
 			    unsigned int info, unsigned int align,
 			    unsigned int ent_size)
@@ -2172,34 +2579,35 @@ Dwp_output_file::write_shdr(const char* name, unsigned int type,
   if (this->size_ == 32)
     {
       if (this->big_endian_)
-	return this->sized_write_shdr<32, true>(name, type, flags, addr,
-						offset, sect_size, link, info,
-						align, ent_size);
+	return this->sized_write_shdr<32, true>(shdr_offset, name, type, flags,
+						addr, offset, sect_size, link,
+						info, align, ent_size);
       else
-	return this->sized_write_shdr<32, false>(name, type, flags, addr,
-						 offset, sect_size, link, info,
-						 align, ent_size);
+	return this->sized_write_shdr<32, false>(shdr_offset, name, type, flags,
+						 addr, offset, sect_size, link,
+						 info, align, ent_size);
     }
   else if (this->size_ == 64)
     {
       if (this->big_endian_)
-	return this->sized_write_shdr<64, true>(name, type, flags, addr,
-						offset, sect_size, link, info,
-						align, ent_size);
+	return this->sized_write_shdr<64, true>(shdr_offset, name, type, flags,
+						addr, offset, sect_size, link,
+						info, align, ent_size);
       else
-	return this->sized_write_shdr<64, false>(name, type, flags, addr,
-						 offset, sect_size, link, info,
-						 align, ent_size);
+	return this->sized_write_shdr<64, false>(shdr_offset, name, type, flags,
+						 addr, offset, sect_size, link,
+						 info, align, ent_size);
     }
   else
     gold_unreachable();
 }
 
 template<unsigned int size, bool big_endian>
-void
-Dwp_output_file::sized_write_shdr(const char* name, unsigned int type,
-				  unsigned int flags, uint64_t addr,
-				  off_t offset, section_size_type sect_size,
+off_t
+Dwp_output_file::sized_write_shdr(off_t shdr_offset, const char* name,
+				  unsigned int type, unsigned int flags,
+				  uint64_t addr, off_t offset,
+				  section_size_type sect_size,
 				  unsigned int link, unsigned int info,
 				  unsigned int align, unsigned int ent_size)
 {
@@ -2217,8 +2625,9 @@ Dwp_output_file::sized_write_shdr(const char* name, unsigned int type,
   shdr.put_sh_info(info);
   shdr.put_sh_addralign(align);
   shdr.put_sh_entsize(ent_size);
-  if (::fwrite(buf, 1, shdr_size, this->fd_) < shdr_size)
+  if (!this->write_to_file(shdr_offset, buf, shdr_size))
     gold_fatal(_("%s: error writing section header table"), this->name_);
+  return shdr_offset + shdr_size;
 }
 
 // Class Dwo_name_info_reader.
@@ -2238,15 +2647,12 @@ Dwo_name_info_reader::visit_compilation_unit(off_t, off_t, Dwarf_die* die)
 
 // Class Unit_reader.
 
-// Read the CUs or TUs and add them to the output file.
+// Read the CUs or TUs and append them to UNITS.
 
 void
-Unit_reader::add_units(Dwp_output_file* output_file,
-		       unsigned int debug_abbrev,
-		       Section_bounds* sections)
+Unit_reader::get_units(unsigned int debug_abbrev, Unit_list* units)
 {
-  this->output_file_ = output_file;
-  this->sections_ = sections;
+  this->units_ = units;
   this->set_abbrev_shndx(debug_abbrev);
   this->parse();
 }
@@ -2254,52 +2660,28 @@ Unit_reader::add_units(Dwp_output_file* output_file,
 // Visit a compilation unit.
 
 void
-Unit_reader::visit_compilation_unit(off_t, off_t cu_length, Dwarf_die* die)
+Unit_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
+				    Dwarf_die* die)
 {
   if (cu_length == 0)
     return;
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  // Dwp_output_file::add_contribution writes the .debug_info.dwo section
-  // directly to the output file, so we do not need to duplicate the
-  // section contents, and add_contribution does not need to free the memory.
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_INFO,
-					   this->buffer_at_offset(0),
-					   cu_length, 1);
-  Section_bounds bounds(off, cu_length);
-  unit_set->sections[elfcpp::DW_SECT_INFO] = bounds;
-  this->output_file_->add_cu_set(unit_set);
+  uint64_t dwo_id = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
+  this->units_->push_back(Dwo_unit(this->shndx_, cu_offset, cu_length,
+				   dwo_id));
 }
 
 // Visit a type unit.
 
 void
-Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
+Unit_reader::visit_type_unit(off_t tu_offset, off_t tu_length, off_t,
 			     uint64_t signature, Dwarf_die*)
 {
   if (tu_length == 0)
     return;
-  if (this->output_file_->lookup_tu(signature))
-    return;
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = signature;
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  unsigned char* contents = new unsigned char[tu_length];
-  memcpy(contents, this->buffer_at_offset(0), tu_length);
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_TYPES, contents,
-					   tu_length, 1);
-  Section_bounds bounds(off, tu_length);
-  unit_set->sections[elfcpp::DW_SECT_TYPES] = bounds;
-  this->output_file_->add_tu_set(unit_set);
+  this->units_->push_back(Dwo_unit(this->shndx_, tu_offset, tu_length,
+				   signature));
 }
 
 }; // End namespace gold
@@ -2310,6 +2692,8 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS = 0x102,
+  THREAD_COUNT = 0x103,
 };
 
 struct option dwp_options[] =
@@ -2317,6 +2701,8 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "threads", no_argument, NULL, THREADS },
+    { "thread-count", required_argument, NULL, THREAD_COUNT },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2333,6 +2719,10 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --threads                Read and write files"
+					   " in parallel\n"));
+  fprintf(fd, _("  --thread-count COUNT     Number of threads to use"
+					   " (implies --threads)\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2381,9 +2771,11 @@ main(int argc, char** argv)
   Errors errors(program_name);
   set_parameters_errors(&errors);
 
-  // Initialize gold's global options.  We don't use these in
+  // Initialize gold's global options.  We don't use most of these in
   // this program, but they need to be initialized so that
-  // functions we call from libgold work properly.
+  // functions we call from libgold work properly.  We set the
+  // threading options ourselves, since libgold needs to know
+  // whether to use threads.
   General_options options;
   set_parameters_options(&options);
 
@@ -2415,6 +2807,21 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	  case THREAD_COUNT:
+#ifdef ENABLE_THREADS
+	    {
+	      int thread_count = options.thread_count();
+	      if (c == THREAD_COUNT)
+		options::parse_uint("--thread-count", optarg, &thread_count);
+	      options.set_thread_options(true, thread_count);
+	    }
+#else
+	    gold_warning(_("ignoring --threads: "
+			   "%s was compiled without thread support"),
+			 program_name);
+#endif
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2454,16 +2861,60 @@ main(int argc, char** argv)
       return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-  // Process each file, adding its contents to the output file.
-  Dwp_output_file output_file(output_filename.c_str());
+  // With --threads, use one thread per processor unless told otherwise.
+  int thread_count = 1;
+  if (options.threads())
+    {
+      thread_count = options.thread_count();
+#ifdef _SC_NPROCESSORS_ONLN
+      if (thread_count == 0)
+	thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+      if (thread_count <= 0)
+	thread_count = 1;
+    }
+  Workqueue workqueue(options);
+  workqueue.set_thread_count(thread_count);
+
+  // Scan the input files.  Each file is scanned on its own, so with
+  // --threads the files are scanned in parallel.
+  std::vector<Dwo_file*> dwo_files;
+  dwo_files.reserve(files.size());
   for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+    {
+      Dwo_file* dwo_file = new Dwo_file(f->dwo_name.c_str());
+      dwo_files.push_back(dwo_file);
+      workqueue.queue(new Dwo_scan_task(dwo_file));
+    }
+  workqueue.process(0);
+
+  // Process each file, adding its contents to the output file.  This
+  // merges the string tables and indexes, so it is done in order.
+  Dwp_output_file output_file(output_filename.c_str());
+  for (std::vector<Dwo_file*>::const_iterator p = dwo_files.begin();
+       p != dwo_files.end();
+       ++p)
     {
       if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+	fprintf(stderr, "%s\n", files[p - dwo_files.begin()].dwo_name.c_str());
+      (*p)->read(&output_file);
     }
+
+  // Copy the contributions of each file to their places in the output
+  // file.
+  output_file.layout_sections();
+  for (std::vector<Dwo_file*>::const_iterator p = dwo_files.begin();
+       p != dwo_files.end();
+       ++p)
+    workqueue.queue(new Dwo_write_task(*p, &output_file));
+  workqueue.process(0);
+
   output_file.finalize();
 
+  for (std::vector<Dwo_file*>::const_iterator p = dwo_files.begin();
+       p != dwo_files.end();
+       ++p)
+    delete *p;
+
   return EXIT_SUCCESS;
 }
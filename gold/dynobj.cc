@@ -1013,6 +1013,18 @@ Dynobj::gnu_hash(const char* name)
   return h;
 }
 
+// Likewise, for a string which is not null terminated.
+
+uint32_t
+Dynobj::gnu_hash(const char* name, size_t len)
+{
+  const unsigned char* nameu = reinterpret_cast<const unsigned char*>(name);
+  uint32_t h = 5381;
+  for (size_t i = 0; i < len; ++i)
+    h = (h << 5) + h + nameu[i];
+  return h;
+}
+
 // Create a GNU hash table, setting *PPHASH and *PHASHLEN.  GNU hash
 // tables are an extension to ELF which are recognized by the GNU
 // dynamic linker.  They are referenced using dynamic tag DT_GNU_HASH.
@@ -1055,8 +1067,12 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 	unhashed_dynsyms.push_back(sym);
       else
 	{
+	  // The hash code is usually computed when the symbols are
+	  // read, which is done in parallel.
 	  hashed_dynsyms.push_back(sym);
-	  dynsym_hashvals.push_back(Dynobj::gnu_hash(sym->name()));
+	  dynsym_hashvals.push_back(sym->has_gnu_hash()
+				    ? sym->gnu_hash()
+				    : Dynobj::gnu_hash(sym->name()));
 	}
     }
 
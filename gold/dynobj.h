@@ -76,6 +76,14 @@ class Dynobj : public Object
   static uint32_t
   elf_hash(const char*);
 
+  // Compute the GNU hash code for a string.
+  static uint32_t
+  gnu_hash(const char*);
+
+  // Compute the GNU hash code for a string of length LEN.
+  static uint32_t
+  gnu_hash(const char*, size_t len);
+
   // Create a standard ELF hash table, setting *PPHASH and *PHASHLEN.
   // DYNSYMS is the global dynamic symbols.  LOCAL_DYNSYM_COUNT is the
   // number of local dynamic symbols, which is the index of the first
@@ -112,10 +120,6 @@ class Dynobj : public Object
   { this->needed_.push_back(std::string(s)); }
 
  private:
-  // Compute the GNU hash code for a string.
-  static uint32_t
-  gnu_hash(const char*);
-
   // Compute the number of hash buckets to use.
   static unsigned int
   compute_bucket_count(const std::vector<uint32_t>& hashcodes,
@@ -188,8 +188,7 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
       this->get_fde_addresses<size, big_endian>(of, &this->fde_offsets_,
 						&fde_addresses);
 
-      std::sort(fde_addresses.begin(), fde_addresses.end(),
-		Fde_address_compare<size>());
+      fde_addresses.sort();
 
       typename elfcpp::Elf_types<size>::Elf_Addr output_address;
       output_address = this->address();
@@ -212,6 +211,58 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
   of->write_output_view(off, oview_size, oview);
 }
 
+// Sort the FDE addresses by PC.  A large C++ program can have
+// millions of FDEs, so rather than std::sort we use a least
+// significant digit radix sort, one byte at a time.  Bytes which are
+// the same in every PC, such as the high bytes of the addresses in
+// most programs, are skipped.  The sort is stable, so FDEs with the
+// same PC stay in the order in which they appear in .eh_frame.
+
+template<int size>
+void
+Eh_frame_hdr::Fde_addresses<size>::sort()
+{
+  const size_t count = this->fde_addresses_.size();
+  if (count < 2)
+    return;
+
+  // Count the number of times each value of each byte appears.
+  const int digits = size / 8;
+  std::vector<size_t> counts(digits * 256, 0);
+  for (iterator p = this->fde_addresses_.begin();
+       p != this->fde_addresses_.end();
+       ++p)
+    {
+      Address pc = p->first;
+      for (int d = 0; d < digits; ++d)
+	++counts[d * 256 + ((pc >> (d * 8)) & 0xff)];
+    }
+
+  Fde_address_list tmp(count);
+  for (int d = 0; d < digits; ++d)
+    {
+      size_t* pcount = &counts[d * 256];
+      unsigned int first = (this->fde_addresses_[0].first >> (d * 8)) & 0xff;
+      if (pcount[first] == count)
+	continue;
+
+      // Turn the counts into starting positions, and distribute the
+      // entries.
+      size_t pos = 0;
+      for (int i = 0; i < 256; ++i)
+	{
+	  size_t c = pcount[i];
+	  pcount[i] = pos;
+	  pos += c;
+	}
+      for (iterator p = this->fde_addresses_.begin();
+	   p != this->fde_addresses_.end();
+	   ++p)
+	tmp[pcount[(p->first >> (d * 8)) & 0xff]++] = *p;
+      this->fde_addresses_.swap(tmp);
+    }
+}
+
 // Given the offset FDE_OFFSET of an FDE in the .eh_frame section, and
 // the contents of the .eh_frame section EH_FRAME_CONTENTS, where the
 // FDE's encoding is FDE_ENCODING, return the output address of the
@@ -120,20 +120,14 @@ class Eh_frame_hdr : public Output_section_data
     end()
     { return this->fde_addresses_.end(); }
 
+    // Sort the list by PC.
+    void
+    sort();
+
    private:
     Fde_address_list fde_addresses_;
   };
 
-  // Compare Fde_address objects.
-  template<int size>
-  struct Fde_address_compare
-  {
-    bool
-    operator()(const typename Fde_addresses<size>::Fde_address& f1,
-	       const typename Fde_addresses<size>::Fde_address& f2) const
-    { return f1.first < f2.first; }
-  };
-
   // Return the PC to which an FDE refers.
   template<int size, bool big_endian>
   typename elfcpp::Elf_types<size>::Elf_Addr
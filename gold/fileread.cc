@@ -38,6 +38,7 @@
 
 #include <sys/stat.h>
 #include "filenames.h"
+#include "md5.h"
 
 #include "debug.h"
 #include "parameters.h"
@@ -114,6 +115,29 @@ get_mtime(const char* filename, Timespec* mtime)
   return true;
 }
 
+// Compute the digest of the contents of an unopened file.
+
+bool
+get_file_digest(const char* filename, unsigned char* digest)
+{
+  int o = open_descriptor(-1, filename, O_RDONLY);
+  if (o < 0)
+    return false;
+
+  struct md5_ctx ctx;
+  md5_init_ctx(&ctx);
+  char buf[64 * 1024];
+  ssize_t got;
+  while ((got = ::read(o, buf, sizeof buf)) > 0)
+    md5_process_bytes(buf, got, &ctx);
+  release_descriptor(o, true);
+  if (got < 0)
+    return false;
+
+  md5_finish_ctx(&ctx, digest);
+  return true;
+}
+
 // Class File_read.
 
 // A lock for the File_read static variables.
@@ -258,6 +282,7 @@ void
 File_read::release()
 {
   gold_assert(this->is_locked());
+  Hold_optional_lock hl(this->share_lock_);
 
   if (!parameters->options_valid() || parameters->options().stats())
     {
@@ -306,12 +331,14 @@ File_read::unlock(const Task* task)
   this->token_.remove_writer(task);
 }
 
-// Return whether the file is locked.
+// Return whether the file is locked.  It is while a share lock is
+// set, since other tasks are reading it on behalf of the task which
+// locked it.
 
 bool
 File_read::is_locked() const
 {
-  if (!this->token_.is_writable())
+  if (!this->token_.is_writable() || this->share_lock_ != NULL)
     return true;
   // The file is not locked, so it should have been released.
   gold_assert(this->released_);
@@ -423,6 +450,7 @@ File_read::do_read(off_t start, section_size_type size, void* p)
 void
 File_read::read(off_t start, section_size_type size, void* p)
 {
+  Hold_optional_lock hl(this->share_lock_);
   const File_read::View* pv = this->find_view(start, size, -1U, NULL);
   if (pv != NULL)
     {
@@ -613,6 +641,7 @@ const unsigned char*
 File_read::get_view(off_t offset, off_t start, section_size_type size,
 		    bool aligned, bool cache)
 {
+  Hold_optional_lock hl(this->share_lock_);
   File_read::View* pv = this->find_or_make_view(offset, start, size,
 						aligned, cache);
   return pv->data() + (offset + start - pv->start() + pv->byteshift());
@@ -622,6 +651,7 @@ File_view*
 File_read::get_lasting_view(off_t offset, off_t start, section_size_type size,
 			    bool aligned, bool cache)
 {
+  Hold_optional_lock hl(this->share_lock_);
   File_read::View* pv = this->find_or_make_view(offset, start, size,
 						aligned, cache);
   pv->lock();
@@ -731,6 +761,7 @@ File_read::read_multiple(off_t base, const Read_multiple& rm)
 	this->read(base + i_off, i_entry.size, i_entry.buffer);
       else
 	{
+	  Hold_optional_lock hl(this->share_lock_);
 	  File_read::View* view = this->find_view(base + i_off,
 						  end_off - i_off,
 						  -1U, NULL);
@@ -771,6 +802,7 @@ File_read::clear_view_cache_marks()
   if (this->object_count_ > 1)
     return;
 
+  Hold_optional_lock hl(this->share_lock_);
   for (Views::iterator p = this->views_.begin();
        p != this->views_.end();
        ++p)
@@ -861,6 +893,7 @@ File_read::print_stats()
 File_view::~File_view()
 {
   gold_assert(this->file_.is_locked());
+  Hold_optional_lock hl(this->file_.share_lock_);
   this->view_->unlock();
 }
 
@@ -954,6 +987,36 @@ File_read::get_mtime()
 #endif
 }
 
+// Compute the digest of the contents of the file.  Use the whole
+// file view if the file is already mapped; otherwise read the file in
+// pieces rather than mapping all of it just to compute the digest.
+
+void
+File_read::get_digest(unsigned char* digest)
+{
+  gold_assert(this->is_locked());
+
+  if (this->whole_file_view_ != NULL)
+    {
+      const unsigned char* p = this->whole_file_view_->data();
+      md5_buffer(reinterpret_cast<const char*>(p), this->size_, digest);
+      return;
+    }
+
+  struct md5_ctx ctx;
+  md5_init_ctx(&ctx);
+  unsigned char buf[64 * 1024];
+  for (off_t off = 0; off < this->size_; off += sizeof buf)
+    {
+      section_size_type len = sizeof buf;
+      if (this->size_ - off < static_cast<off_t>(len))
+	len = convert_to_section_size_type(this->size_ - off);
+      this->read(off, len, buf);
+      md5_process_bytes(buf, len, &ctx);
+    }
+  md5_finish_ctx(&ctx, digest);
+}
+
 // Try to find a file in the extra search dirs.  Returns true on success.
 
 bool
@@ -35,6 +35,8 @@
 namespace gold
 {
 
+class Lock;
+
 // Since not all system supports stat.st_mtim and struct timespec,
 // we define our own structure and fill the nanoseconds if we can.
 
@@ -58,6 +60,16 @@ struct Timespec
 bool
 get_mtime(const char* filename, Timespec* mtime);
 
+// The size of the digest of the contents of a file.
+const unsigned int file_digest_size = 16;
+
+// Compute the MD5 digest of the contents of an unopened file into
+// DIGEST, which must hold file_digest_size bytes.  Returns false if
+// the file can not be read.
+
+bool
+get_file_digest(const char* filename, unsigned char* digest);
+
 class Position_dependent_options;
 class Input_file_argument;
 class Dirsearch;
@@ -72,7 +84,7 @@ class File_read
   File_read()
     : name_(), descriptor_(-1), is_descriptor_opened_(false), object_count_(0),
       size_(0), token_(false), views_(), saved_views_(), mapped_bytes_(0),
-      released_(true), whole_file_view_(NULL)
+      released_(true), whole_file_view_(NULL), share_lock_(NULL)
   { }
 
   ~File_read();
@@ -132,6 +144,17 @@ class File_read
   void
   release();
 
+  // Set a lock to hold while finding, reading, locking or releasing
+  // views, as in get_view, get_lasting_view, read, read_multiple,
+  // release and the File_view destructor.  The Task which has locked
+  // the file uses this while it lets other threads read the file on
+  // its behalf.  The file counts as locked while the lock is set,
+  // even if that Task has finished, until a Task which locks the file
+  // again sets it back to NULL.
+  void
+  set_share_lock(Lock* lock)
+  { this->share_lock_ = lock; }
+
   // Return the size of the file.
   off_t
   filesize() const
@@ -220,6 +243,11 @@ class File_read
   Timespec
   get_mtime();
 
+  // Compute the MD5 digest of the contents of the file into DIGEST,
+  // which must hold file_digest_size bytes.  The file must be locked.
+  void
+  get_digest(unsigned char* digest);
+
  private:
   // Control for what views to clear.
   enum Clear_views_mode
@@ -442,6 +470,9 @@ class File_read
   // - The contents was specified in the constructor.  Used only for
   //   testing purposes).
   View* whole_file_view_;
+  // If not NULL, a lock held while finding or reading views, because
+  // several threads are reading the file.
+  Lock* share_lock_;
 };
 
 // A view of file data that persists even when the file is unlocked.
@@ -22,53 +22,305 @@
 
 
 #include "gold.h"
+
+#include <algorithm>
+
 #include "object.h"
 #include "gc.h"
 #include "symtab.h"
+#include "gold-threads.h"
+#include "workqueue.h"
 
 namespace gold
 {
 
-// Garbage collection uses a worklist style algorithm to determine the 
-// transitive closure of all referenced sections.
-void 
-Garbage_collection::do_transitive_closure()
+// Garbage collection uses a worklist style algorithm to determine the
+// transitive closure of all referenced sections.  The references
+// recorded by add_reference are kept per object, indexed by section
+// index, along with a byte per section recording whether it has been
+// marked.  The marking is done by several tasks, each of which starts
+// from a share of the roots on the work list and keeps its own stack
+// of sections to scan.  A section is claimed by atomically setting its
+// mark byte, so each section is scanned by exactly one task.  A task
+// never waits for work: it finishes when its stack is empty.  While
+// fewer tasks are live than there are threads, a busy task hands half
+// of its stack to a new task.  Marking is done when the last task
+// finishes.
+
+// A task which marks the sections reachable from a set of roots.
+
+class Gc_mark_task : public Task
 {
-  while (!this->worklist().empty())
+ public:
+  Gc_mark_task(Garbage_collection* gc, Task_token* blocker)
+    : gc_(gc), stack_(), blocker_(blocker)
+  { }
+
+  // The sections to start from.  They must already be marked.
+  Garbage_collection::Mark_stack*
+  stack()
+  { return &this->stack_; }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  { this->gc_->mark_sections(workqueue, this->blocker_, &this->stack_); }
+
+  std::string
+  get_name() const
+  { return "Gc_mark_task"; }
+
+ private:
+  Garbage_collection* gc_;
+  Garbage_collection::Mark_stack stack_;
+  Task_token* blocker_;
+};
+
+// Class Garbage_collection.
+
+Garbage_collection::Garbage_collection()
+  : work_list_(), is_worklist_ready_(false), object_sections_(),
+    last_object_(NULL), last_object_sections_(NULL), cident_sections_(),
+    mark_lock_(NULL), mark_task_limit_(0), live_mark_tasks_(0),
+    mark_task_count_(0), mark_timer_(), marked_count_(0), section_count_(0),
+    mark_time_(0)
+{
+}
+
+Garbage_collection::~Garbage_collection()
+{
+  for (Object_sections_map::iterator p = this->object_sections_.begin();
+       p != this->object_sections_.end();
+       ++p)
+    delete p->second;
+  delete this->mark_lock_;
+}
+
+// Return the information for OBJECT, growing its mark bytes if
+// necessary to cover section SHNDX.  This is only called before
+// marking starts.
+
+Garbage_collection::Object_sections*
+Garbage_collection::get_object_sections(Object* object, unsigned int shndx)
+{
+  Object_sections* os;
+  if (object == this->last_object_)
+    os = this->last_object_sections_;
+  else
     {
-      // Add elements from the work list to the referenced list
-      // one by one.
-      Section_id entry = this->worklist().front();
-      this->worklist().pop();
-      if (this->referenced_list().find(entry)
-          == this->referenced_list().end()) 
-        {
-          this->referenced_list().insert(entry);
-        }
+      Object_sections_map::iterator p = this->object_sections_.find(object);
+      if (p != this->object_sections_.end())
+	os = p->second;
       else
-        {
-          continue;
-        }
-      Garbage_collection::Section_ref::iterator find_it = 
-                this->section_reloc_map().find(entry);
-      if (find_it == this->section_reloc_map().end()) 
-          continue;
-      Garbage_collection::Sections_reachable v = find_it->second;
-      // Scan the vector of references for each work_list entry. 
-      for (Garbage_collection::Sections_reachable::iterator it_v = v.begin();
-           it_v != v.end();
-           ++it_v)
-        {
-          // Do not add already processed sections to the work_list. 
-          if (this->referenced_list().find(*it_v)
-              == this->referenced_list().end())
-            {
-              this->worklist().push(*it_v);   
-            }
-        }
+	{
+	  os = new Object_sections(object->shnum());
+	  this->object_sections_[object] = os;
+	}
+      this->last_object_ = object;
+      this->last_object_sections_ = os;
+    }
+  if (shndx >= os->marked.size())
+    os->marked.resize(shndx + 1, 0);
+  return os;
+}
+
+// Mark section ENTRY.  Return true if it was not already marked, in
+// which case the caller is responsible for scanning it.
+
+inline bool
+Garbage_collection::mark_section(const Section_entry& entry)
+{
+  unsigned char* pmark = &entry.first->marked[entry.second];
+  if (*pmark != 0)
+    return false;
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_1
+  return __sync_bool_compare_and_swap(pmark, 0, 1);
+#else
+  // We only use one mark task in this case.
+  *pmark = 1;
+  return true;
+#endif
+}
+
+// Queue up the tasks which mark every section reachable from the work
+// list.
+
+Task_token*
+Garbage_collection::queue_mark_tasks(const Input_objects* input_objects,
+				     Workqueue* workqueue)
+{
+  this->mark_timer_.start();
+
+  // The statistics cover the sections which nothing refers to, so
+  // count all the sections now.  Section 0 is not a real section.
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    if ((*p)->shnum() > 0)
+      this->section_count_ += (*p)->shnum() - 1;
+
+  Mark_stack roots;
+  while (!this->work_list_.empty())
+    {
+      Section_id id = this->work_list_.front();
+      this->work_list_.pop();
+      Section_entry entry(this->get_object_sections(id.first, id.second),
+			  id.second);
+      if (mark_section(entry))
+	roots.push_back(entry);
     }
+
+  // Never have more mark tasks live than there are threads to run
+  // them.  When the thread count is not given, gold uses a thread per
+  // input object, so use a fixed limit instead.
+  const int max_task_count = 16;
+  int task_limit = 1;
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_1
+  if (parameters->options().threads())
+    {
+      task_limit = parameters->options().thread_count_middle();
+      if (task_limit == 0)
+	task_limit = max_task_count;
+    }
+#endif
+  this->mark_task_limit_ = task_limit;
+  this->mark_lock_ = new Lock();
+
+  int task_count = task_limit;
+  if (roots.size() < static_cast<size_t>(task_count))
+    task_count = roots.size();
+  this->live_mark_tasks_ = task_count;
+  this->mark_task_count_ = task_count;
+
+  Task_token* mark_blocker = new Task_token(true);
+  if (task_count == 0)
+    return mark_blocker;
+
+  std::vector<Gc_mark_task*> tasks;
+  tasks.reserve(task_count);
+  for (int i = 0; i < task_count; ++i)
+    tasks.push_back(new Gc_mark_task(this, mark_blocker));
+  for (size_t i = 0; i < roots.size(); ++i)
+    tasks[i % task_count]->stack()->push_back(roots[i]);
+
+  mark_blocker->add_blockers(task_count);
+  for (int i = 0; i < task_count; ++i)
+    workqueue->queue(tasks[i]);
+
+  return mark_blocker;
+}
+
+// Mark the sections reachable from the sections on STACK.  This is
+// run by a mark task which holds a blocker on MARK_BLOCKER.
+
+void
+Garbage_collection::mark_sections(Workqueue* workqueue,
+				  Task_token* mark_blocker,
+				  Mark_stack* stack)
+{
+  size_t scanned = 0;
+  while (!stack->empty())
+    {
+      Section_entry entry = stack->back();
+      stack->pop_back();
+      const std::vector<Mark_stack>& references(entry.first->references);
+      if (entry.second < references.size())
+	{
+	  const Mark_stack& refs(references[entry.second]);
+	  for (Mark_stack::const_iterator p = refs.begin();
+	       p != refs.end();
+	       ++p)
+	    if (mark_section(*p))
+	      stack->push_back(*p);
+	}
+
+      // Every so often, if there is room for another task, hand half
+      // of our work over to a new one.  Reading live_mark_tasks_
+      // without the lock is only a hint.
+      ++scanned;
+      if (this->mark_task_limit_ > 1
+	  && (scanned & 255) == 0
+	  && stack->size() >= 2
+	  && this->live_mark_tasks_ < this->mark_task_limit_)
+	{
+	  {
+	    Hold_lock hl(*this->mark_lock_);
+	    if (this->live_mark_tasks_ >= this->mark_task_limit_)
+	      continue;
+	    ++this->live_mark_tasks_;
+	    ++this->mark_task_count_;
+	  }
+
+	  Gc_mark_task* task = new Gc_mark_task(this, mark_blocker);
+	  size_t keep = stack->size() / 2;
+	  task->stack()->assign(stack->begin() + keep, stack->end());
+	  stack->resize(keep);
+	  // We still hold our own blocker, so the token can not be
+	  // unblocked before the new task is queued.
+	  workqueue->add_blocker(mark_blocker);
+	  workqueue->queue_soon(task);
+	}
+    }
+
+  if (this->mark_task_limit_ > 1)
+    {
+      Hold_lock hl(*this->mark_lock_);
+      --this->live_mark_tasks_;
+    }
+}
+
+// Called when all the mark tasks are done.
+
+void
+Garbage_collection::marking_done()
+{
+  for (Object_sections_map::const_iterator p = this->object_sections_.begin();
+       p != this->object_sections_.end();
+       ++p)
+    {
+      if (p->first->is_dynamic())
+	continue;
+      const std::vector<unsigned char>& marked(p->second->marked);
+      // Section 0 is not a real section.
+      for (size_t i = 1; i < marked.size(); ++i)
+	if (marked[i] != 0)
+	  ++this->marked_count_;
+    }
+  this->mark_time_ = this->mark_timer_.get_elapsed_time().wall;
   this->worklist_ready();
 }
 
+// Return whether section SHNDX of OBJ was found to be unreferenced.
+
+bool
+Garbage_collection::is_section_garbage(Object* obj, unsigned int shndx) const
+{
+  Object_sections_map::const_iterator p = this->object_sections_.find(obj);
+  if (p == this->object_sections_.end())
+    return true;
+  const std::vector<unsigned char>& marked(p->second->marked);
+  return shndx >= marked.size() || marked[shndx] == 0;
+}
+
+// Print statistics about the marking.
+
+void
+Garbage_collection::print_stats() const
+{
+  fprintf(stderr, _("%s: gc marked sections: %zu; unmarked sections: %zu\n"),
+	  program_name, this->marked_count_,
+	  this->section_count_ - this->marked_count_);
+  fprintf(stderr, _("%s: gc mark tasks: %d; mark time: %ld.%06ld\n"),
+	  program_name, this->mark_task_count_, this->mark_time_ / 1000,
+	  (this->mark_time_ % 1000) * 1000);
+}
+
 } // End namespace gold.
 
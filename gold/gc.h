@@ -30,6 +30,7 @@
 #include "symtab.h"
 #include "object.h"
 #include "icf.h"
+#include "timer.h"
 
 namespace gold
 {
@@ -45,32 +46,33 @@ struct Reloc_types;
 class Output_section;
 class General_options;
 class Layout;
+class Input_objects;
+class Lock;
+class Task_token;
+class Workqueue;
 
 class Garbage_collection
 {
+  struct Object_sections;
+
  public:
 
   typedef Unordered_set<Section_id, Section_id_hash> Sections_reachable;
-  typedef std::map<Section_id, Sections_reachable> Section_ref;
   typedef std::queue<Section_id> Worklist_type;
   // This maps the name of the section which can be represented as a C
   // identifier (cident) to the list of sections that have that name.
   // Different object files can have cident sections with the same name.
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
+  // A section to be marked: the per-object information and the
+  // section index.
+  typedef std::pair<Object_sections*, unsigned int> Section_entry;
+  typedef std::vector<Section_entry> Mark_stack;
 
-  Garbage_collection()
-  : is_worklist_ready_(false)
-  { }
-
-  // Accessor methods for the private members.
+  Garbage_collection();
 
-  Sections_reachable&
-  referenced_list()
-  { return referenced_list_; }
+  ~Garbage_collection();
 
-  Section_ref&
-  section_reloc_map()
-  { return this->section_reloc_map_; }
+  // Accessor methods for the private members.
 
   Worklist_type&
   worklist()
@@ -84,13 +86,25 @@ class Garbage_collection
   worklist_ready()
   { this->is_worklist_ready_ = true; }
 
+  // Queue up tasks which mark every section reachable from the
+  // sections on the work list.  Return a blocker which is unblocked
+  // when the marking is complete; marking_done should be called then.
+  Task_token*
+  queue_mark_tasks(const Input_objects*, Workqueue*);
+
+  // Mark the sections reachable from the sections on STACK, handing
+  // some of the work to new mark tasks when there are idle threads.
+  // This is called by the mark tasks, which hold a blocker on
+  // MARK_BLOCKER.
+  void
+  mark_sections(Workqueue*, Task_token* mark_blocker, Mark_stack* stack);
+
+  // Called when all the mark tasks have completed.
   void
-  do_transitive_closure();
+  marking_done();
 
   bool
-  is_section_garbage(Object* obj, unsigned int shndx)
-  { return (this->referenced_list().find(Section_id(obj, shndx))
-            == this->referenced_list().end()); }
+  is_section_garbage(Object* obj, unsigned int shndx) const;
 
   Cident_section_map*
   cident_sections()
@@ -107,22 +121,68 @@ class Garbage_collection
   add_reference(Object* src_object, unsigned int src_shndx,
 		Object* dst_object, unsigned int dst_shndx)
   {
-    Section_id src_id(src_object, src_shndx);
-    Section_id dst_id(dst_object, dst_shndx);
-    Section_ref::iterator p = this->section_reloc_map_.find(src_id);
-    if (p == this->section_reloc_map_.end())
-      this->section_reloc_map_[src_id].insert(dst_id);
-    else
-      p->second.insert(dst_id);
+    Object_sections* src = this->get_object_sections(src_object, src_shndx);
+    if (src_shndx >= src->references.size())
+      src->references.resize(src_shndx + 1);
+    Mark_stack* refs = &src->references[src_shndx];
+    Section_entry dst(this->get_object_sections(dst_object, dst_shndx),
+		      dst_shndx);
+    // Relocations against the same section tend to come in runs, so
+    // skip the obvious duplicates; the rest are harmless.
+    if (refs->empty() || refs->back() != dst)
+      refs->push_back(dst);
   }
 
+  // Print statistics about the marking to stderr.
+  void
+  print_stats() const;
+
  private:
+  // The information kept for each object: the sections referenced
+  // from each section, and whether each section has been marked.
+  // Both are indexed by section index.  REFERENCES only extends to
+  // the last section which refers to anything.
+  struct Object_sections
+  {
+    Object_sections(unsigned int shnum)
+      : references(), marked(shnum, 0)
+    { }
+
+    std::vector<Mark_stack> references;
+    std::vector<unsigned char> marked;
+  };
+
+  typedef Unordered_map<const Object*, Object_sections*> Object_sections_map;
+
+  // Return the information for OBJECT, making sure that its mark
+  // bytes cover section SHNDX.
+  Object_sections*
+  get_object_sections(Object* object, unsigned int shndx);
+
+  // Mark section ENTRY, returning true if it was not already marked.
+  static bool
+  mark_section(const Section_entry& entry);
 
   Worklist_type work_list_;
   bool is_worklist_ready_;
-  Section_ref section_reloc_map_;
-  Sections_reachable referenced_list_;
+  Object_sections_map object_sections_;
+  // The most recently used entry in OBJECT_SECTIONS_.
+  const Object* last_object_;
+  Object_sections* last_object_sections_;
   Cident_section_map cident_sections_;
+  // The lock which protects LIVE_MARK_TASKS_ and MARK_TASK_COUNT_.
+  Lock* mark_lock_;
+  // The most mark tasks which may be live at once.
+  int mark_task_limit_;
+  // The number of mark tasks which have been queued and not finished.
+  int live_mark_tasks_;
+  // The total number of mark tasks, for the statistics.
+  int mark_task_count_;
+  // Statistics.
+  Timer mark_timer_;
+  size_t marked_count_;
+  size_t section_count_;
+  long mark_time_;
 };
 
 // Data to pass between successive invocations of do_layout
@@ -361,16 +421,14 @@ gc_process_relocs(
                 symtab->gc()->cident_sections()->find(std::string(cident_section_name));
               if (ele == symtab->gc()->cident_sections()->end())
                 continue;
-	      Section_id src_id(src_obj, src_indx);
-              Garbage_collection::Sections_reachable&
-                v(symtab->gc()->section_reloc_map()[src_id]);
               Garbage_collection::Sections_reachable& cident_secn(ele->second);
               for (Garbage_collection::Sections_reachable::iterator it_v
                      = cident_secn.begin();
                    it_v != cident_secn.end();
                    ++it_v)
                 {
-                  v.insert(*it_v);
+		  symtab->gc()->add_reference(src_obj, src_indx,
+					      it_v->first, it_v->second);
                 }
             }
         }
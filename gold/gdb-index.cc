@@ -28,6 +28,8 @@
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "workqueue.h"
+#include "timer.h"
 
 namespace gold
 {
@@ -171,6 +173,207 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+class Gdb_index_info_reader;
+
+// The results of scanning the .debug_info and .debug_types sections
+// of a single input object.  These are filled in by a
+// Gdb_index_scan_task, which may run in parallel with the scans of
+// other objects, and are then merged into the Gdb_index in input
+// order, so that the contents of the index do not depend on the order
+// in which the tasks ran.  CU and TU indexes are local to the object
+// until they are merged.
+
+class Gdb_index_scan
+{
+ public:
+  Gdb_index_scan(Relobj* object, const unsigned char* symbols,
+		 off_t symbols_size);
+
+  ~Gdb_index_scan();
+
+  // The object being scanned.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Record a .debug_info or .debug_types section to scan.
+  void
+  add_section(bool is_type_unit, unsigned int shndx,
+	      unsigned int reloc_shndx, unsigned int reloc_type)
+  {
+    this->sections_.push_back(Section(is_type_unit, shndx, reloc_shndx,
+				      reloc_type));
+  }
+
+  // Scan the recorded sections.  The object must be locked.
+  void
+  scan();
+
+  // Merge the results into GDB_INDEX.
+  void
+  merge(Gdb_index* gdb_index);
+
+  // Add a compilation unit.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    this->comp_units_.push_back(std::make_pair(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(int cu_index, Dwarf_range_list* ranges)
+  { this->ranges_.push_back(std::make_pair(cu_index, ranges)); }
+
+  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
+  // the high-byte of the cu_index field.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUS associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return pubtypes_table_; }
+
+  // Count a CU or TU for which there were no pubnames or pubtypes.
+  void
+  add_nopubnames_unit(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_nopubnames_count_;
+    else
+      ++this->cu_nopubnames_count_;
+  }
+
+  // Number of CUs and TUs without pubnames or pubtypes.
+  unsigned int
+  cu_nopubnames_count() const
+  { return this->cu_nopubnames_count_; }
+
+  unsigned int
+  tu_nopubnames_count() const
+  { return this->tu_nopubnames_count_; }
+
+  // Wall time in microseconds taken by the scan.
+  long long
+  scan_time() const
+  { return this->scan_time_; }
+
+ private:
+  // A section to scan.
+  struct Section
+  {
+    Section(bool is_tu, unsigned int sh, unsigned int rsh, unsigned int rt)
+      : is_type_unit(is_tu), shndx(sh), reloc_shndx(rsh), reloc_type(rt)
+    { }
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  // An entry in the type unit list.
+  struct Type_unit
+  {
+    Type_unit(off_t off, off_t toff, uint64_t sig)
+      : tu_offset(off), type_offset(toff), type_signature(sig)
+    { }
+    off_t tu_offset;
+    off_t type_offset;
+    uint64_t type_signature;
+  };
+
+  // A symbol found by the scan.  The hash codes are computed here,
+  // so that the merge only has to do the table lookups.
+  struct Symbol
+  {
+    const char* name;
+    size_t length;
+    unsigned int hash;
+    size_t pool_hash;
+    int cu_index;
+    uint8_t flags;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr,
+                       Gdb_index_info_reader* dwinfo);
+
+  // Wrapper for map_pubtable_to_dies
+  void
+  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo);
+
+  // The object being scanned.
+  Relobj* object_;
+  // A copy of the object's symbol table, used to apply relocations.
+  unsigned char* symbols_;
+  off_t symbols_size_;
+  // The sections to scan.
+  std::vector<Section> sections_;
+  // The compilation units, as (offset, length) pairs.
+  std::vector<std::pair<off_t, off_t> > comp_units_;
+  // The type units.
+  std::vector<Type_unit> type_units_;
+  // The address ranges, with the local index of their CU.
+  std::vector<std::pair<int, Dwarf_range_list*> > ranges_;
+  // The symbols, in the order in which they were found.
+  std::vector<Symbol> symbols_found_;
+  // Storage for the symbol names.
+  Stringpool names_;
+  // Maps from CU offset to offset in the pubnames and pubtypes tables.
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Tables to store the pubnames sections of the object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Stmt list offset of the CUs and TUs associated with the last read
+  // pubnames and pubtypes sections.
+  off_t stmt_list_offset_;
+  // Statistics.
+  unsigned int cu_nopubnames_count_;
+  unsigned int tu_nopubnames_count_;
+  long long scan_time_;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,19 +386,15 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_scan* scan)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      scan_(scan), cu_index_(0), cu_language_(0)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
-  // Print usage statistics.
-  static void
-  print_stats();
-
  protected:
   // Visit a compilation unit.
   virtual void
@@ -285,8 +484,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The scan of the object, which collects the results.
+  Gdb_index_scan* scan_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -295,34 +494,15 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   // for DW_AT_specification.
   Declaration_map declarations_;
 
-  // Statistics.
-  // Total number of DWARF compilation units processed.
-  static unsigned int dwarf_cu_count;
-  // Number of DWARF compilation units with pubnames/pubtypes.
-  static unsigned int dwarf_cu_nopubnames_count;
-  // Total number of DWARF type units processed.
-  static unsigned int dwarf_tu_count;
-  // Number of DWARF type units with pubnames/pubtypes.
-  static unsigned int dwarf_tu_nopubnames_count;
 };
 
-// Total number of DWARF compilation units processed.
-unsigned int Gdb_index_info_reader::dwarf_cu_count = 0;
-// Number of DWARF compilation units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_cu_nopubnames_count = 0;
-// Total number of DWARF type units processed.
-unsigned int Gdb_index_info_reader::dwarf_tu_count = 0;
-// Number of DWARF type units without pubnames/pubtypes.
-unsigned int Gdb_index_info_reader::dwarf_tu_nopubnames_count = 0;
-
 // Process a compilation unit and parse its child DIE.
 
 void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  this->cu_index_ = this->scan_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +513,9 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->scan_->add_type_unit(tu_offset, type_offset,
+						    signature);
   this->visit_top_die(root_die);
 }
 
@@ -378,10 +557,8 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 			     this->object()->name().c_str());
 		return;
 	      }
-	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
-	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	    this->scan_->add_nopubnames_unit(die->tag()
+					     != elfcpp::DW_TAG_compile_unit);
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -435,8 +612,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	      this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -475,8 +651,7 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+		this->scan_->add_symbol(this->cu_index_, full_name.c_str(), 0);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -823,8 +998,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->scan_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -849,8 +1023,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->scan_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -875,7 +1048,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->scan_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -914,8 +1087,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->scan_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -926,10 +1098,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->scan_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->scan_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -937,12 +1109,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->scan_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->scan_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->scan_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->scan_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -962,67 +1134,40 @@ Gdb_index_info_reader::clear_declarations()
   this->declarations_.clear();
 }
 
-// Print usage statistics.
-void
-Gdb_index_info_reader::print_stats()
-{
-  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_count);
-  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_cu_nopubnames_count);
-  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_count);
-  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
-          program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
-}
+// Class Gdb_index_scan.
 
-// Class Gdb_index.
-
-// Construct the .gdb_index section.
-
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+Gdb_index_scan::Gdb_index_scan(Relobj* object, const unsigned char* symbols,
+			       off_t symbols_size)
+  : object_(object), symbols_(NULL), symbols_size_(symbols_size),
+    sections_(), comp_units_(), type_units_(), ranges_(), symbols_found_(),
+    names_(), cu_pubname_map_(), cu_pubtype_map_(), pubnames_table_(NULL),
+    pubtypes_table_(NULL), stmt_list_offset_(-1), cu_nopubnames_count_(0),
+    tu_nopubnames_count_(0), scan_time_(0)
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+  // The caller frees the symbols once the object has been laid out,
+  // which is before we scan it.
+  if (symbols != NULL && symbols_size > 0)
+    {
+      this->symbols_ = new unsigned char[symbols_size];
+      memcpy(this->symbols_, symbols, symbols_size);
+    }
 }
 
-Gdb_index::~Gdb_index()
+Gdb_index_scan::~Gdb_index_scan()
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  delete[] this->symbols_;
+  delete this->pubnames_table_;
+  delete this->pubtypes_table_;
 }
 
-
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
 // when we encounter the die for that cu or tu.
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_scan::map_pubtable_to_dies(unsigned int attr,
+				     Gdb_index_info_reader* dwinfo)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1040,7 +1185,8 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
     }
 
   map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
+  if (!table->read_section(this->object_, this->symbols_,
+			   this->symbols_size_))
     return NULL;
 
   while (table->read_header(section_offset))
@@ -1055,30 +1201,19 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
 // Wrapper for map_pubtable_to_dies
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_scan::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo)
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = -1;
-
-  delete this->pubnames_table_;
   this->pubnames_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
-  delete this->pubtypes_table_;
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo);
   this->pubtypes_table_
-      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+      = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo);
 }
 
 // Given a cu_offset, find the associated section of the pubnames
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Gdb_index_scan::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1090,7 +1225,7 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Gdb_index_scan::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1098,7 +1233,229 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
   return -1;
 }
 
-// Scan a .debug_info or .debug_types input section.
+// Scan the .debug_info and .debug_types sections of the object.
+
+void
+Gdb_index_scan::scan()
+{
+  long long start_time = 0;
+  if (parameters->options().stats())
+    start_time = wall_clock_usec();
+
+  for (std::vector<Section>::const_iterator p = this->sections_.begin();
+       p != this->sections_.end();
+       ++p)
+    {
+      Gdb_index_info_reader dwinfo(p->is_type_unit, this->object_,
+				   this->symbols_, this->symbols_size_,
+				   p->shndx, p->reloc_shndx,
+				   p->reloc_type, this);
+      if (p == this->sections_.begin())
+	this->map_pubnames_and_types_to_dies(&dwinfo);
+      dwinfo.parse();
+    }
+
+  if (parameters->options().stats())
+    this->scan_time_ = wall_clock_usec() - start_time;
+}
+
+// Add a symbol.
+
+void
+Gdb_index_scan::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+{
+  Symbol sym;
+  sym.length = strlen(sym_name);
+  sym.name = this->names_.add_with_length(sym_name, sym.length, true, NULL);
+  sym.hash = mapped_index_string_hash(
+      reinterpret_cast<const unsigned char*>(sym_name));
+  sym.pool_hash = Stringpool::hash_string(sym_name, sym.length);
+  sym.cu_index = cu_index;
+  sym.flags = flags;
+  this->symbols_found_.push_back(sym);
+}
+
+// Merge the results of the scan into GDB_INDEX, translating the local
+// CU and TU indexes.
+
+void
+Gdb_index_scan::merge(Gdb_index* gdb_index)
+{
+  int cu_base = -1;
+  for (unsigned int i = 0; i < this->comp_units_.size(); ++i)
+    {
+      int cu_index = gdb_index->add_comp_unit(this->comp_units_[i].first,
+					      this->comp_units_[i].second);
+      if (i == 0)
+	cu_base = cu_index;
+    }
+
+  int tu_base = -1;
+  for (unsigned int i = 0; i < this->type_units_.size(); ++i)
+    {
+      const Type_unit& tu(this->type_units_[i]);
+      int tu_index = gdb_index->add_type_unit(tu.tu_offset, tu.type_offset,
+					      tu.type_signature);
+      if (i == 0)
+	tu_base = tu_index;
+    }
+
+  for (unsigned int i = 0; i < this->ranges_.size(); ++i)
+    {
+      int cu_index = this->ranges_[i].first;
+      cu_index = cu_index < 0 ? cu_index - tu_base : cu_index + cu_base;
+      gdb_index->add_address_range_list(this->object_, cu_index,
+					this->ranges_[i].second);
+    }
+
+  for (std::vector<Symbol>::const_iterator p = this->symbols_found_.begin();
+       p != this->symbols_found_.end();
+       ++p)
+    {
+      int cu_index = p->cu_index;
+      cu_index = cu_index < 0 ? cu_index - tu_base : cu_index + cu_base;
+      gdb_index->add_symbol(cu_index, p->name, p->length, p->hash,
+			    p->pool_hash, p->flags);
+    }
+}
+
+// A task which scans the .debug_info and .debug_types sections of
+// one object.
+
+class Gdb_index_scan_task : public Task
+{
+ public:
+  Gdb_index_scan_task(Gdb_index_scan* scan, Task_token* blocker)
+    : scan_(scan), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    Relobj* object = this->scan_->object();
+    return object->is_locked() ? object->token() : NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->scan_->object()->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->scan_->scan();
+    this->scan_->object()->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_scan_task " + this->scan_->object()->name(); }
+
+ private:
+  Gdb_index_scan* scan_;
+  Task_token* blocker_;
+};
+
+// A task which merges the scans into the index once they are all
+// complete.  This is blocked by THIS_BLOCKER and SCAN_BLOCKER, and
+// unblocks NEXT_BLOCKER.
+
+class Gdb_index_merge_task : public Task
+{
+ public:
+  Gdb_index_merge_task(Gdb_index* gdb_index, Task_token* this_blocker,
+		       Task_token* scan_blocker, Task_token* next_blocker)
+    : gdb_index_(gdb_index), this_blocker_(this_blocker),
+      scan_blocker_(scan_blocker), next_blocker_(next_blocker)
+  { }
+
+  ~Gdb_index_merge_task()
+  {
+    delete this->this_blocker_;
+    delete this->scan_blocker_;
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (this->scan_blocker_->is_blocked())
+      return this->scan_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->gdb_index_->merge_scans(); }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_merge_task"; }
+
+ private:
+  Gdb_index* gdb_index_;
+  Task_token* this_blocker_;
+  Task_token* scan_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Class Gdb_index.
+
+// Statistics.
+unsigned int Gdb_index::dwarf_cu_count = 0;
+unsigned int Gdb_index::dwarf_cu_nopubnames_count = 0;
+unsigned int Gdb_index::dwarf_tu_count = 0;
+unsigned int Gdb_index::dwarf_tu_nopubnames_count = 0;
+long long Gdb_index::dwarf_scan_time = 0;
+long long Gdb_index::symtab_build_time = 0;
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0),
+    scans_(),
+    scan_tasks_queued_(false)
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
+  // Free any scans that were never merged.
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    delete this->scans_[i];
+}
+
+// Record a .debug_info or .debug_types input section to be scanned.
+// The sections of an object are recorded together, while the object
+// is laid out.
 
 void
 Gdb_index::scan_debug_info(bool is_type_unit,
@@ -1109,24 +1466,80 @@ Gdb_index::scan_debug_info(bool is_type_unit,
 			   unsigned int reloc_shndx,
 			   unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
+  gold_assert(!this->scan_tasks_queued_);
+  if (this->scans_.empty() || this->scans_.back()->object() != object)
+    this->scans_.push_back(new Gdb_index_scan(object, symbols, symbols_size));
+  this->scans_.back()->add_section(is_type_unit, shndx, reloc_shndx,
+				   reloc_type);
+}
+
+// Queue a task to scan each object, and a task to merge the results.
+// Walking the DIEs is the expensive part of building the index, so
+// the objects are scanned in parallel.
+
+Task_token*
+Gdb_index::queue_scan_tasks(Workqueue* workqueue, Task_token* this_blocker)
+{
+  gold_assert(!this->scan_tasks_queued_);
+  this->scan_tasks_queued_ = true;
+
+  if (this->scans_.empty())
+    return this_blocker;
+
+  // Add all the blockers before queuing any tasks, since the tasks
+  // may start running as soon as they are queued.
+  Task_token* scan_blocker = new Task_token(true);
+  scan_blocker->add_blockers(this->scans_.size());
+
+  Task_token* next_blocker = new Task_token(true);
+  next_blocker->add_blocker();
+
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    workqueue->queue(new Gdb_index_scan_task(this->scans_[i], scan_blocker));
+
+  workqueue->queue(new Gdb_index_merge_task(this, this_blocker, scan_blocker,
+					    next_blocker));
+
+  return next_blocker;
+}
+
+// Merge the scans into the index, in input order.
+
+void
+Gdb_index::merge_scans()
+{
+  long long start_time = 0;
+  if (parameters->options().stats())
+    start_time = wall_clock_usec();
+
+  for (unsigned int i = 0; i < this->scans_.size(); ++i)
+    {
+      Gdb_index_scan* scan = this->scans_[i];
+      unsigned int cu_count = this->comp_units_.size();
+      unsigned int tu_count = this->type_units_.size();
+      scan->merge(this);
+      Gdb_index::dwarf_cu_count += this->comp_units_.size() - cu_count;
+      Gdb_index::dwarf_tu_count += this->type_units_.size() - tu_count;
+      Gdb_index::dwarf_cu_nopubnames_count += scan->cu_nopubnames_count();
+      Gdb_index::dwarf_tu_nopubnames_count += scan->tu_nopubnames_count();
+      Gdb_index::dwarf_scan_time += scan->scan_time();
+      delete scan;
+    }
+  this->scans_.clear();
+
+  if (parameters->options().stats())
+    Gdb_index::symtab_build_time += wall_clock_usec() - start_time;
 }
 
 // Add a symbol.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Gdb_index::add_symbol(int cu_index, const char* sym_name, size_t sym_len,
+		      unsigned int hash, size_t pool_hash, uint8_t flags)
 {
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
   Gdb_symbol* sym = new Gdb_symbol();
-  this->stringpool_.add(sym_name, true, &sym->name_key);
+  this->stringpool_.add_prehashed(sym_name, sym_len, pool_hash, true,
+				  &sym->name_key);
   sym->hashval = hash;
   sym->cu_vector_index = 0;
 
@@ -1154,27 +1567,6 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
-
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
-{
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
-}
-
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
-
-void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
-{
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
-}
-
 // Set the size of the .gdb_index section.
 
 void
@@ -1350,8 +1742,24 @@ Gdb_index::do_write(Output_file* of)
 void
 Gdb_index::print_stats()
 {
-  if (parameters->options().gdb_index())
-    Gdb_index_info_reader::print_stats();
+  if (!parameters->options().gdb_index())
+    return;
+
+  fprintf(stderr, _("%s: DWARF CUs: %u\n"),
+          program_name, Gdb_index::dwarf_cu_count);
+  fprintf(stderr, _("%s: DWARF CUs without pubnames/pubtypes: %u\n"),
+          program_name, Gdb_index::dwarf_cu_nopubnames_count);
+  fprintf(stderr, _("%s: DWARF TUs: %u\n"),
+          program_name, Gdb_index::dwarf_tu_count);
+  fprintf(stderr, _("%s: DWARF TUs without pubnames/pubtypes: %u\n"),
+          program_name, Gdb_index::dwarf_tu_nopubnames_count);
+  fprintf(stderr, _("%s: gdb_index DIE scan time (all threads): "
+		    "%lld.%06lld\n"),
+	  program_name, Gdb_index::dwarf_scan_time / 1000000,
+	  Gdb_index::dwarf_scan_time % 1000000);
+  fprintf(stderr, _("%s: gdb_index symbol table build time: %lld.%06lld\n"),
+	  program_name, Gdb_index::symtab_build_time / 1000000,
+	  Gdb_index::symtab_build_time % 1000000);
 }
 
 } // End namespace gold.
@@ -42,8 +42,9 @@ class Sized_relobj;
 class Dwarf_range_list;
 template <typename T>
 class Gdb_hashtab;
-class Gdb_index_info_reader;
-class Dwarf_pubnames_table;
+class Gdb_index_scan;
+class Task_token;
+class Workqueue;
 
 // This class manages the .gdb_index section, which is a fast
 // lookup table for DWARF information used by the gdb debugger.
@@ -56,7 +57,9 @@ class Gdb_index : public Output_section_data
 
   ~Gdb_index();
 
-  // Scan a .debug_info or .debug_types input section.
+  // Record a .debug_info or .debug_types input section to be
+  // scanned.  The sections of each object are scanned by a separate
+  // task, queued by queue_scan_tasks.
   void scan_debug_info(bool is_type_unit,
 		       Relobj* object,
 		       const unsigned char* symbols,
@@ -65,6 +68,17 @@ class Gdb_index : public Output_section_data
 		       unsigned int reloc_shndx,
 		       unsigned int reloc_type);
 
+  // Queue the tasks which scan the sections recorded by
+  // scan_debug_info, and the task which merges the results into the
+  // index once they and THIS_BLOCKER have finished.  Return a blocker
+  // which is unblocked when the merge is complete.
+  Task_token*
+  queue_scan_tasks(Workqueue* workqueue, Task_token* this_blocker);
+
+  // Merge the results of the scans into the index, in input order.
+  void
+  merge_scans();
+
   // Add a compilation unit.
   int
   add_comp_unit(off_t cu_offset, off_t cu_length)
@@ -89,40 +103,12 @@ class Gdb_index : public Output_section_data
     this->ranges_.push_back(Per_cu_range_list(object, cu_index, ranges));
   }
 
-  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
-  // the high-byte of the cu_index field.
-  void
-  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
-
-  // Return the offset into the pubnames table for the cu at the given
-  // offset.
-  off_t
-  find_pubname_offset(off_t cu_offset);
-
-  // Return the offset into the pubtypes table for the cu at the
-  // given offset.
-  off_t
-  find_pubtype_offset(off_t cu_offset);
-
-  // Return TRUE if we have already processed the pubnames and types
-  // set for OBJECT of the CUs and TUS associated with the statement
-  // list at OFFSET.
-  bool
-  pubnames_read(const Relobj* object, off_t offset);
-
-  // Record that we have already read the pubnames associated with
-  // OBJECT and OFFSET.
+  // Add a symbol of length SYM_LEN.  HASH is its gdb_index hash, and
+  // POOL_HASH its Stringpool hash.  FLAGS are the gdb_index version 7
+  // flags to be stored in the high-byte of the cu_index field.
   void
-  set_pubnames_read(const Relobj* object, off_t offset);
-
-  // Return a pointer to the given table.
-  Dwarf_pubnames_table*
-  pubnames_table()
-  { return pubnames_table_; }
-
-  Dwarf_pubnames_table*
-  pubtypes_table()
-  { return pubtypes_table_; }
+  add_symbol(int cu_index, const char* sym_name, size_t sym_len,
+	     unsigned int hash, size_t pool_hash, uint8_t flags);
 
   // Print usage statistics.
   static void
@@ -148,21 +134,6 @@ class Gdb_index : public Output_section_data
   do_print_to_mapfile(Mapfile* mapfile) const
   { mapfile->print_output_data(this, _("** gdb_index")); }
 
-  // Create a map from dies to pubnames.
-  Dwarf_pubnames_table*
-  map_pubtable_to_dies(unsigned int attr,
-                       Gdb_index_info_reader* dwinfo,
-                       Relobj* object,
-                       const unsigned char* symbols,
-                       off_t symbols_size);
-
-  // Wrapper for map_pubtable_to_dies
-  void
-  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                 Relobj* object,
-                                 const unsigned char* symbols,
-                                 off_t symbols_size);
-
  private:
   // An entry in the compilation unit list.
   struct Comp_unit
@@ -216,21 +187,6 @@ class Gdb_index : public Output_section_data
 
   typedef std::vector<std::pair<int, uint8_t> > Cu_vector;
 
-  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
-  Pubname_offset_map cu_pubname_map_;
-  Pubname_offset_map cu_pubtype_map_;
-
-  // Scan the given pubtable and build a map of the various dies it
-  // refers to, so we can process the entries when we encounter the
-  // die.
-  void
-  map_pubtable_to_dies(Dwarf_pubnames_table* table,
-                       Pubname_offset_map* map);
-
-  // Tables to store the pubnames section of the current object.
-  Dwarf_pubnames_table* pubnames_table_;
-  Dwarf_pubnames_table* pubtypes_table_;
-
   // The .gdb_index section.
   Output_section* gdb_index_section_;
   // The list of DWARF compilation units.
@@ -253,10 +209,26 @@ class Gdb_index : public Output_section_data
   off_t symtab_offset_;
   off_t cu_pool_offset_;
   off_t stringpool_offset_;
-  // Object, stmt list offset of the CUs and TUs associated with the
-  // last read pubnames and pubtypes sections.
-  const Relobj* pubnames_object_;
-  off_t stmt_list_offset_;
+  // The scans of the input objects, in input order.
+  std::vector<Gdb_index_scan*> scans_;
+  // Whether the scan tasks have been queued.
+  bool scan_tasks_queued_;
+
+  // Statistics.
+  // Total number of DWARF compilation units processed.
+  static unsigned int dwarf_cu_count;
+  // Number of DWARF compilation units without pubnames/pubtypes.
+  static unsigned int dwarf_cu_nopubnames_count;
+  // Total number of DWARF type units processed.
+  static unsigned int dwarf_tu_count;
+  // Number of DWARF type units without pubnames/pubtypes.
+  static unsigned int dwarf_tu_nopubnames_count;
+  // Wall time in microseconds spent walking DIEs, summed over the
+  // scan tasks.
+  static long long dwarf_scan_time;
+  // Wall time in microseconds spent merging the scans into the
+  // symbol table.
+  static long long symtab_build_time;
 };
 
 } // End namespace gold.
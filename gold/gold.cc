@@ -59,6 +59,16 @@ process_incremental_input(Incremental_binary*, unsigned int, Input_objects*,
 			  Symbol_table*, Layout*, Dirsearch*, Mapfile*,
 			  Task_token*, Task_token*);
 
+static void
+queue_middle_icf_tasks(const General_options&, const Task*,
+		       const Input_objects*, Symbol_table*, Layout*,
+		       Workqueue*, Mapfile*);
+
+static void
+queue_middle_layout_tasks(const General_options&, const Task*,
+			  const Input_objects*, Symbol_table*, Layout*,
+			  Workqueue*, Mapfile*);
+
 void
 gold_exit(Exit_status status)
 {
@@ -166,6 +176,142 @@ Gc_runner::run(Workqueue* workqueue, const Task* task)
 			this->mapfile_);
 }
 
+// This class arranges to queue the identical code folding tasks, and
+// the rest of the middle tasks, once the sections which are not
+// garbage have been marked.
+
+class Gc_marked_runner : public Task_function_runner
+{
+ public:
+  Gc_marked_runner(const General_options& options,
+		   const Input_objects* input_objects,
+		   Symbol_table* symtab,
+		   Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Gc_marked_runner::run(Workqueue* workqueue, const Task* task)
+{
+  this->symtab_->gc()->marking_done();
+  queue_middle_icf_tasks(this->options_, task, this->input_objects_,
+			 this->symtab_, this->layout_, workqueue,
+			 this->mapfile_);
+}
+
+// This class arranges to run identical code folding once the sections
+// have been checksummed, and then to queue the rest of the middle
+// tasks.
+
+class Icf_runner : public Task_function_runner
+{
+ public:
+  Icf_runner(const General_options& options,
+	     const Input_objects* input_objects,
+	     Symbol_table* symtab,
+	     Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Icf_runner::run(Workqueue* workqueue, const Task* task)
+{
+  this->symtab_->icf()->find_identical_sections(task, this->symtab_);
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
+// This class arranges to process the input files of an incremental
+// update link once the digests of the input files which may have
+// changed have been computed.
+
+class Incremental_inputs_runner : public Task_function_runner
+{
+ public:
+  Incremental_inputs_runner(Incremental_binary* ibase,
+			    Input_objects* input_objects,
+			    Symbol_table* symtab, Layout* layout,
+			    Dirsearch* search_path, Mapfile* mapfile,
+			    Task_token* final_blocker)
+    : ibase_(ibase), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), search_path_(search_path), mapfile_(mapfile),
+      final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  Incremental_binary* ibase_;
+  Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Dirsearch* search_path_;
+  Mapfile* mapfile_;
+  // The blocker released by the task for the last input file.
+  Task_token* final_blocker_;
+};
+
+void
+Incremental_inputs_runner::run(Workqueue* workqueue, const Task*)
+{
+  // Process the list of input files stored in the base file, and
+  // queue a task for each file: a Read_symbols task for a changed
+  // file, and an Add_symbols task for an unchanged file.  We need to
+  // mark all the space used by unchanged files before we can start any
+  // tasks running.
+  unsigned int input_file_count = this->ibase_->input_file_count();
+  std::vector<Task*> tasks;
+  tasks.reserve(input_file_count);
+  Task_token* this_blocker = NULL;
+  for (unsigned int i = 0; i < input_file_count; ++i)
+    {
+      Task_token* next_blocker;
+      if (i + 1 == input_file_count)
+	next_blocker = this->final_blocker_;
+      else
+	{
+	  next_blocker = new Task_token(true);
+	  next_blocker->add_blocker();
+	}
+      Task* t = process_incremental_input(this->ibase_, i,
+					  this->input_objects_,
+					  this->symtab_, this->layout_,
+					  this->search_path_, this->mapfile_,
+					  this_blocker, next_blocker);
+      tasks.push_back(t);
+      this_blocker = next_blocker;
+    }
+  // Now we can queue the tasks.
+  for (unsigned int i = 0; i < tasks.size(); i++)
+    workqueue->queue(tasks[i]);
+}
+
 // Queue up the initial set of tasks for this link job.
 
 void
@@ -244,29 +390,22 @@ queue_initial_tasks(const General_options& options,
 	  this_blocker = next_blocker;
 	}
     }
-  else
+  else if (ibase->input_file_count() > 0)
     {
-      // Incremental update link.  Process the list of input files
-      // stored in the base file, and queue a task for each file:
-      // a Read_symbols task for a changed file, and an Add_symbols task
-      // for an unchanged file.  We need to mark all the space used by
-      // unchanged files before we can start any tasks running.
-      unsigned int input_file_count = ibase->input_file_count();
-      std::vector<Task*> tasks;
-      tasks.reserve(input_file_count);
-      for (unsigned int i = 0; i < input_file_count; ++i)
-	{
-	  Task_token* next_blocker = new Task_token(true);
-	  next_blocker->add_blocker();
-	  Task* t = process_incremental_input(ibase, i, input_objects, symtab,
-					      layout, &search_path, mapfile,
-					      this_blocker, next_blocker);
-	  tasks.push_back(t);
-	  this_blocker = next_blocker;
-	}
-      // Now we can queue the tasks.
-      for (unsigned int i = 0; i < tasks.size(); i++)
-	workqueue->queue(tasks[i]);
+      // Incremental update link.  First compute in parallel the
+      // digests of the input files which are newer than the base
+      // file, and then process the input files stored in the base
+      // file.
+      Task_token* digest_blocker = new Task_token(true);
+      ibase->queue_digest_tasks(workqueue, digest_blocker);
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      workqueue->queue(new Task_function(
+	  new Incremental_inputs_runner(ibase, input_objects, symtab, layout,
+					&search_path, mapfile, next_blocker),
+	  digest_blocker,
+	  "Task_function Incremental_inputs_runner"));
+      this_blocker = next_blocker;
     }
 
   if (options.has_plugins())
@@ -513,18 +652,73 @@ queue_middle_tasks(const General_options& options,
       // Symbols named with -u should not be considered garbage.
       symtab->gc_mark_undef_symbols(layout);
       gold_assert(symtab->gc() != NULL);
-      // Do a transitive closure on all references to determine the worklist.
-      symtab->gc()->do_transitive_closure();
+      // Mark all the sections reachable from the work list, in
+      // parallel, and queue the rest of the middle tasks when that is
+      // done.
+      Task_token* gc_blocker =
+	symtab->gc()->queue_mark_tasks(input_objects, workqueue);
+      workqueue->queue(new Task_function(new Gc_marked_runner(options,
+							      input_objects,
+							      symtab,
+							      layout,
+							      mapfile),
+					 gc_blocker,
+					 "Task_function Gc_marked_runner"));
+      return;
     }
 
+  queue_middle_icf_tasks(options, task, input_objects, symtab, layout,
+			 workqueue, mapfile);
+}
+
+// Queue up the identical code folding tasks, if any, once garbage
+// collection, if any, has been done.
+
+static void
+queue_middle_icf_tasks(const General_options& options,
+		       const Task* task,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout,
+		       Workqueue* workqueue,
+		       Mapfile* mapfile)
+{
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
-  // be folding sections that will be garbage.
+  // be folding sections that will be garbage.  The candidate sections
+  // are checksummed in parallel, and the rest of the middle tasks are
+  // queued when that is done.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      Task_token* icf_blocker =
+	symtab->icf()->queue_checksum_tasks(task, input_objects, symtab,
+					    workqueue);
+      workqueue->queue(new Task_function(new Icf_runner(options,
+							input_objects,
+							symtab,
+							layout,
+							mapfile),
+					 icf_blocker,
+					 "Task_function Icf_runner"));
+      return;
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks, once identical code
+// folding, if any, has been done.
+
+static void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -768,6 +962,19 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // Scan the debug info for the .gdb_index section in parallel with
+  // the relocations.
+  this_blocker = layout->queue_gdb_index_tasks(workqueue, this_blocker);
+
+  // Likewise deduplicate the strings in merged string sections.
+  this_blocker = layout->queue_merge_tasks(workqueue, this_blocker);
+
+  // See if any of the input definitions violate the One Definition
+  // Rule, reading the line numbers of each object in parallel.
+  this_blocker = symtab->queue_odr_tasks(workqueue, input_objects,
+					 this_blocker,
+					 options.output_file_name());
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
@@ -867,10 +1074,15 @@ queue_final_tasks(const General_options& options,
     }
   else
     {
+      // Compress any debug sections before their final sizes are
+      // needed.
+      Task_token* compressed_blocker =
+	layout->queue_compression_tasks(workqueue, final_blocker);
+
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
       Task* t = new Write_after_input_sections_task(layout, of,
-						    final_blocker,
+						    compressed_blocker,
 						    new_final_blocker);
       workqueue->queue(t);
       final_blocker = new_final_blocker;
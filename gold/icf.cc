@@ -27,11 +27,13 @@
 // its contents and relocations.  If the symbol name corresponding to
 // a relocation is known it is used to compute the checksum.  If the
 // symbol name is not known the stringified name of the object and the
-// section number pointed to by the relocation is used.  The checksums
+// section number pointed to by the relocation is used.  The checksum
+// is a 128-bit MD5 digest, computed once per section by tasks which
+// run in parallel, one per object; the contents themselves are not
+// copied.  Relocations to other foldable sections are left out of the
+// digest and recorded separately, as described below.  The checksums
 // are stored as keys in a hash map and a section is identical to some
 // other section if its checksum is already present in the hash map.
-// Checksum collisions are handled by using a multimap and explicitly
-// checking the contents when two sections have the same checksum.
 //
 // However, two functions A and B with identical text but with
 // relocations pointing to different foldable sections can be identical if
@@ -147,60 +149,61 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "md5.h"
+#include "workqueue.h"
 
 namespace gold
 {
 
+// Return the first 64 bits of an MD5 DIGEST, used as a hash table key.
+
+static inline uint64_t
+digest_key(const unsigned char* digest)
+{
+  uint64_t key;
+  memcpy(&key, digest, sizeof key);
+  return key;
+}
+
+// Add the null-terminated string S to the checksum in CTX.
+
+static inline void
+checksum_string(md5_ctx* ctx, const char* s)
+{
+  md5_process_bytes(s, strlen(s), ctx);
+}
+
 // This function determines if a section or a group of identical
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
 // Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
+// SECTION_CHECKSUMS : The checksums of each section.
+// FIRST_ITERATION : True to compare just the section contents,
+//                   false to also compare the relocs to sections
+//                   that cannot be folded.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
 
 static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+preprocess_for_unique_sections(
+    const std::vector<Icf::Section_checksum>& section_checksums,
+    bool first_iteration,
+    std::vector<bool>* is_secn_or_group_unique)
 {
-  Unordered_map<uint32_t, unsigned int> uniq_map;
-  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
+  Unordered_map<uint64_t, unsigned int> uniq_map;
+  std::pair<Unordered_map<uint64_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_checksums.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
-      else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
-      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
+      const Icf::Section_checksum& checksum(section_checksums[i]);
+      uint64_t key = digest_key(first_iteration
+				? checksum.contents_digest
+				: checksum.digest);
+      uniq_map_insert = uniq_map.insert(std::make_pair(key, i));
       if (uniq_map_insert.second)
         {
           (*is_secn_or_group_unique)[i] = true;
@@ -213,100 +216,62 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// This computes the checksums of a section's contents, both text and
+// relocs.  Relocs are differentiated as those pointing to sections
+// that could be folded and those that cannot.  Relocs pointing to
+// sections that could be folded are recorded in TRACKED_SECTIONS,
+// since the section they are folded into changes between iterations;
+// everything else goes into DIGEST.  This is called by an
+// Icf_checksum_task, in parallel with the tasks for other objects,
+// unless IN_TASK is false.  The object must be locked.  If a reloc
+// points to a merge section in a different object, whose contents
+// can't be read from a task, this returns false without computing
+// anything.
 // Parameters  :
-// FIRST_ITERATION    : true if it is the first invocation.
-// SECN               : Section for which contents are desired.
 // SECTION_NUM        : Unique section number of this section.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
-
-static std::string
-get_section_contents(bool first_iteration,
-                     const Section_id& secn,
-                     unsigned int section_num,
-                     unsigned int* num_tracked_relocs,
-                     Symbol_table* symtab,
-                     const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
+// IN_TASK            : True if called from a task.
+
+bool
+Icf::compute_section_checksum(unsigned int section_num, bool in_task)
 {
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
+  const Section_id& secn(this->id_section_[section_num]);
+  Section_checksum* checksum = &this->section_checksums_[section_num];
 
   section_size_type plen;
-  const unsigned char* contents = NULL;
-  if (first_iteration)
-    contents = secn.first->section_contents(secn.second, &plen, false);
+  const unsigned char* contents;
+  contents = secn.first->section_contents(secn.second, &plen, false);
 
-  // The buffer to hold all the contents including relocs.  A checksum
-  // is then computed on this buffer.
-  std::string buffer;
-  std::string icf_reloc_buffer;
+  md5_ctx ctx;
+  md5_init_ctx(&ctx);
 
-  if (num_tracked_relocs)
-    *num_tracked_relocs = 0;
-
-  Icf::Reloc_info_list& reloc_info_list = 
-    symtab->icf()->reloc_info_list();
+  checksum->tracked_sections.clear();
 
   Icf::Reloc_info_list::iterator it_reloc_info_list =
-    reloc_info_list.find(secn);
-
-  buffer.clear();
-  icf_reloc_buffer.clear();
+    this->reloc_info_list_.find(secn);
 
-  // Process relocs and put them into the buffer.
+  // Process relocs and add them to the checksum.
 
-  if (it_reloc_info_list != reloc_info_list.end())
+  if (it_reloc_info_list != this->reloc_info_list_.end())
     {
-      Icf::Sections_reachable_info &v =
+      const Icf::Sections_reachable_info &v =
         (it_reloc_info_list->second).section_info;
       // Stores the information of the symbol pointed to by the reloc.
       const Icf::Symbol_info &s = (it_reloc_info_list->second).symbol_info;
       // Stores the addend and the symbol value.
-      Icf::Addend_info &a = (it_reloc_info_list->second).addend_info;
+      const Icf::Addend_info &a = (it_reloc_info_list->second).addend_info;
       // Stores the offset of the reloc.
       const Icf::Offset_info &o = (it_reloc_info_list->second).offset_info;
       const Icf::Reloc_addend_size_info &reloc_addend_size_info =
         (it_reloc_info_list->second).reloc_addend_size_info;
-      Icf::Sections_reachable_info::iterator it_v = v.begin();
+      Icf::Sections_reachable_info::const_iterator it_v = v.begin();
       Icf::Symbol_info::const_iterator it_s = s.begin();
-      Icf::Addend_info::iterator it_a = a.begin();
+      Icf::Addend_info::const_iterator it_a = a.begin();
       Icf::Offset_info::const_iterator it_o = o.begin();
       Icf::Reloc_addend_size_info::const_iterator it_addend_size =
         reloc_addend_size_info.begin();
 
       for (; it_v != v.end(); ++it_v, ++it_s, ++it_a, ++it_o, ++it_addend_size)
         {
-	  if (first_iteration
-	      && it_v->first != NULL)
-	    {
-	      Symbol_location loc;
-	      loc.object = it_v->first;
-	      loc.shndx = it_v->second;
-	      loc.offset = convert_types<off_t, long long>(it_a->first
-							   + it_a->second);
-	      // Look through function descriptors
-	      parameters->target().function_location(&loc);
-	      if (loc.shndx != it_v->second)
-		{
-		  it_v->second = loc.shndx;
-		  // Modify symvalue/addend to the code entry.
-		  it_a->first = loc.offset;
-		  it_a->second = 0;
-		}
-	    }
-
           // ADDEND_STR stores the symbol value and addend and offset,
           // each at most 16 hex digits long.  it_a points to a pair
           // where first is the symbol value and second is the
@@ -325,15 +290,12 @@ get_section_contents(bool first_iteration,
 	  // object is NULL.
 	  if (it_v->first == NULL)
             {
-	      if (first_iteration)
-                {
-		  // If the symbol name is available, use it.
-                  if ((*it_s) != NULL)
-                      buffer.append((*it_s)->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-		}
+	      // If the symbol name is available, use it.
+	      if ((*it_s) != NULL)
+		checksum_string(&ctx, (*it_s)->name());
+	      // Append the addend.
+	      checksum_string(&ctx, addend_str);
+	      checksum_string(&ctx, "@");
 	      continue;
 	    }
 
@@ -344,56 +306,38 @@ get_section_contents(bool first_iteration,
           if (reloc_secn.first == secn.first
               && reloc_secn.second == secn.second)
             {
-              if (first_iteration)
-                {
-                  buffer.append("R");
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
+	      checksum_string(&ctx, "R");
+	      checksum_string(&ctx, addend_str);
+	      checksum_string(&ctx, "@");
               continue;
             }
-          Icf::Uniq_secn_id_map& section_id_map =
-            symtab->icf()->section_to_int_map();
-          Icf::Uniq_secn_id_map::iterator section_id_map_it =
-            section_id_map.find(reloc_secn);
+          Icf::Uniq_secn_id_map::const_iterator section_id_map_it =
+            this->section_id_.find(reloc_secn);
           bool is_sym_preemptible = (*it_s != NULL
 				     && !(*it_s)->is_from_dynobj()
 				     && !(*it_s)->is_undefined()
 				     && (*it_s)->is_preemptible());
           if (!is_sym_preemptible
-              && section_id_map_it != section_id_map.end())
+              && section_id_map_it != this->section_id_.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
-              char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
-              snprintf(kept_section_str, sizeof(kept_section_str), "%u",
-                       kept_section_id[secn_id]);
-              if (first_iteration)
-                {
-                  buffer.append("ICF_R");
-                  buffer.append(addend_str);
-                }
-              icf_reloc_buffer.append(kept_section_str);
-              // Append the addend.
-              icf_reloc_buffer.append(addend_str);
-              icf_reloc_buffer.append("@");
+	      checksum->tracked_sections.push_back(section_id_map_it->second);
+	      checksum_string(&ctx, "ICF_R");
+	      checksum_string(&ctx, addend_str);
             }
           else
             {
               // This is a reloc to a section that cannot be folded.
-              // Process it only in the first iteration.
-              if (!first_iteration)
-                continue;
-
               uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
               // This reloc points to a merge section.  Hash the
               // contents of this section.
               if ((secn_flags & elfcpp::SHF_MERGE) != 0
 		  && parameters->target().can_icf_inline_merge_sections())
                 {
+		  // Only this object is locked by the task.
+		  if (in_task && it_v->first != secn.first)
+		    return false;
+
                   uint64_t entsize =
                     (it_v->first)->section_entsize(it_v->second);
 		  long long offset = it_a->first;
@@ -458,7 +402,7 @@ get_section_contents(bool first_iteration,
                         {
                         case 1:
                           {
-                            buffer.append(str_char);
+			    checksum_string(&ctx, str_char);
                             break;
                           }
                         case 2:
@@ -469,7 +413,7 @@ get_section_contents(bool first_iteration,
                             // Find the NULL character.
                             while(*(ptr_16 + strlen_16) != 0)
                                 strlen_16++;
-                            buffer.append(str_char, strlen_16 * 2);
+			    md5_process_bytes(str_char, strlen_16 * 2, &ctx);
                           }
                           break;
                         case 4:
@@ -480,7 +424,7 @@ get_section_contents(bool first_iteration,
                             // Find the NULL character.
                             while(*(ptr_32 + strlen_32) != 0)
                                 strlen_32++;
-                            buffer.append(str_char, strlen_32 * 4);
+			    md5_process_bytes(str_char, strlen_32 * 4, &ctx);
                           }
                           break;
                         default:
@@ -490,186 +434,198 @@ get_section_contents(bool first_iteration,
                   else
                     {
                       // Use the entsize to determine the length.
-                      buffer.append(reinterpret_cast<const 
-                                                     char*>(str_contents),
-                                    entsize);
+		      md5_process_bytes(str_contents, entsize, &ctx);
                     }
-		  buffer.append("@");
+		  checksum_string(&ctx, "@");
                 }
               else if ((*it_s) != NULL)
                 {
                   // If symbol name is available use that.
-                  buffer.append((*it_s)->name());
+		  checksum_string(&ctx, (*it_s)->name());
                   // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
+		  checksum_string(&ctx, addend_str);
+		  checksum_string(&ctx, "@");
                 }
               else
                 {
                   // Symbol name is not available, like for a local symbol,
                   // use object and section id.
-                  buffer.append(it_v->first->name());
+		  checksum_string(&ctx, it_v->first->name().c_str());
                   char secn_id[10];
                   snprintf(secn_id, sizeof(secn_id), "%u",it_v->second);
-                  buffer.append(secn_id);
+		  checksum_string(&ctx, secn_id);
                   // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
+		  checksum_string(&ctx, addend_str);
+		  checksum_string(&ctx, "@");
                 }
             }
         }
     }
 
-  if (first_iteration)
-    {
-      buffer.append("Contents = ");
-      buffer.append(reinterpret_cast<const char*>(contents), plen);
-      // Store the section contents that dont change to avoid recomputing
-      // during the next call to this function.
-      (*section_contents)[section_num] = buffer;
-    }
-  else
-    {
-      gold_assert(buffer.empty());
-      // Reuse the contents computed in the previous iteration.
-      buffer.append((*section_contents)[section_num]);
-    }
-
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+  // The section contents are hashed on their own, so that sections
+  // with unique contents can be identified cheaply, and that digest
+  // stands in for the contents in the full checksum.
+  md5_buffer(reinterpret_cast<const char*>(contents), plen,
+	     checksum->contents_digest);
+  checksum_string(&ctx, "Contents = ");
+  md5_process_bytes(checksum->contents_digest,
+		    sizeof checksum->contents_digest, &ctx);
+  md5_finish_ctx(&ctx, checksum->digest);
+
+  checksum->is_computed = true;
+  return true;
 }
 
-// This function computes a checksum on each section to detect and form
-// groups of identical sections.  The first iteration does this for all 
-// sections.
+// This function forms groups of identical sections.  The first
+// iteration does this for all sections.
 // Further iterations do this only for the kept sections from each group to
 // determine if larger groups of identical sections could be formed.  The
 // first section in each group is the kept section for that group.
 //
-// CRC32 is the checksumming algorithm and can have collisions.  That is,
-// two sections with different contents can have the same checksum. Hence,
-// a multimap is used to maintain more than one group of checksum
-// identical sections.  A section is added to a group only after its
-// contents are explicitly compared with the kept section of the group.
+// Two sections are identical if their MD5 checksums are the same, and
+// if their relocs to sections that might be folded point to the same
+// kept sections.  Only the latter needs to be recomputed on each
+// iteration, so an iteration does not look at the section contents.
+// A hash of both is used as the key of a multimap of groups.
 //
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// ID_SECTION         : Vector mapping a section to an unique integer.
+// SECTION_CHECKSUMS  : The checksums of each section.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
 
 static bool
 match_sections(unsigned int iteration_num,
-               Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
                std::vector<unsigned int>* kept_section_id,
-               const std::vector<Section_id>& id_section,
-               std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               const std::vector<Icf::Section_checksum>& section_checksums,
+               std::vector<bool>* is_secn_or_group_unique)
 {
-  Unordered_multimap<uint32_t, unsigned int> section_cksum;
-  std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
-            Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
+  Unordered_multimap<uint64_t, unsigned int> section_cksum;
+  std::pair<Unordered_multimap<uint64_t, unsigned int>::iterator,
+            Unordered_multimap<uint64_t, unsigned int>::iterator> key_range;
   bool converged = true;
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
+  preprocess_for_unique_sections(section_checksums, iteration_num == 1,
+				 is_secn_or_group_unique);
+
+  // The kept sections of the tracked relocs of the kept section of each
+  // group, as they were when the group was formed.
+  std::vector<std::vector<unsigned int> > group_kept_sections;
+  group_kept_sections.resize(section_checksums.size());
 
-  std::vector<std::string> full_section_contents;
+  std::vector<unsigned int> this_kept_sections;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_checksums.size(); i++)
     {
-      full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      Section_id secn = id_section[i];
-      std::string this_secn_contents;
-      uint32_t cksum;
-      if (iteration_num == 1)
-        {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-          (*num_tracked_relocs)[i] = num_relocs;
-        }
-      else
-        {
-          if ((*kept_section_id)[i] != i)
-            {
-              // This section is already folded into something.  See
-              // if it should point to a different kept section.
-              unsigned int kept_section = (*kept_section_id)[i];
-              if (kept_section != (*kept_section_id)[kept_section])
-                {
-                  (*kept_section_id)[i] = (*kept_section_id)[kept_section];
-                }
-              continue;
-            }
-          this_secn_contents = get_section_contents(false, secn, i, NULL,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-        }
+      if (iteration_num > 1 && (*kept_section_id)[i] != i)
+	{
+	  // This section is already folded into something.  See
+	  // if it should point to a different kept section.
+	  unsigned int kept_section = (*kept_section_id)[i];
+	  if (kept_section != (*kept_section_id)[kept_section])
+	    {
+	      (*kept_section_id)[i] = (*kept_section_id)[kept_section];
+	    }
+	  continue;
+	}
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
-      size_t count = section_cksum.count(cksum);
+      const Icf::Section_checksum& checksum(section_checksums[i]);
+      gold_assert(checksum.is_computed);
+
+      uint64_t cksum = digest_key(checksum.digest);
+      this_kept_sections.clear();
+      for (std::vector<unsigned int>::const_iterator p =
+	     checksum.tracked_sections.begin();
+	   p != checksum.tracked_sections.end();
+	   ++p)
+	{
+	  unsigned int kept_section = (*kept_section_id)[*p];
+	  this_kept_sections.push_back(kept_section);
+	  cksum = (cksum ^ kept_section) * 0x100000001b3ULL;
+	}
+
+      key_range = section_cksum.equal_range(cksum);
+      Unordered_multimap<uint64_t, unsigned int>::iterator it;
+      // Search all the groups with this cksum for a match.
+      for (it = key_range.first; it != key_range.second; ++it)
+	{
+	  unsigned int kept_section = it->second;
+	  if (memcmp(section_checksums[kept_section].digest, checksum.digest,
+		     sizeof checksum.digest) != 0)
+	    continue;
+	  if (group_kept_sections[kept_section] != this_kept_sections)
+	    continue;
+	  (*kept_section_id)[i] = kept_section;
+	  converged = false;
+	  break;
+	}
+      if (it == key_range.second)
+	{
+	  // Create a new group for this cksum.
+	  section_cksum.insert(std::make_pair(cksum, i));
+	  group_kept_sections[i] = this_kept_sections;
+	}
 
-      if (count == 0)
-        {
-          // Start a group with this cksum.
-          section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
-        }
-      else
-        {
-          key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
-          // Search all the groups with this cksum for a match.
-          for (it = key_range.first; it != key_range.second; ++it)
-            {
-              unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
-                  continue;
-              (*kept_section_id)[i] = kept_section;
-              converged = false;
-              break;
-            }
-          if (it == key_range.second)
-            {
-              // Create a new group for this cksum.
-              section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
-            }
-        }
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (iteration_num == 1 && checksum.tracked_sections.empty())
         (*is_secn_or_group_unique)[i] = true;
     }
 
   return converged;
 }
 
+// A task to compute the checksums of the candidate sections of one
+// object.
+
+class Icf_checksum_task : public Task
+{
+ public:
+  Icf_checksum_task(Icf* icf, Object* object, unsigned int first_section,
+		    unsigned int last_section, Task_token* blocker)
+    : icf_(icf), object_(object),
+      first_section_(first_section), last_section_(last_section),
+      blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return this->object_->is_locked() ? this->object_->token() : NULL; }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    for (unsigned int i = this->first_section_; i < this->last_section_; ++i)
+      this->icf_->compute_section_checksum(i, true);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_checksum_task " + this->object_->name(); }
+
+ private:
+  Icf* icf_;
+  Object* object_;
+  // The range of section numbers to process.
+  unsigned int first_section_;
+  unsigned int last_section_;
+  Task_token* blocker_;
+};
+
 // During safe icf (--icf=safe), only fold functions that are ctors or dtors.
 // This function returns true if the section name is that of a ctor or a dtor.
 
@@ -688,32 +644,35 @@ is_function_ctor_or_dtor(const std::string& section_name)
   return false;
 }
 
-// This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (twice by default)
-// which computes the crc checksums and detects identical functions.
-
-void
-Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+// This is called from queue_middle_tasks in gold.cc.  It decides
+// which sections are candidates for folding, and queues tasks which
+// compute their checksums, one per object.  It returns a blocker which
+// is unblocked when the tasks are done.  TASK is the task calling
+// this.
+
+Task_token*
+Icf::queue_checksum_tasks(const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Workqueue* workqueue)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
+  // The range of candidate section numbers of each object.
+  std::vector<std::pair<Object*, unsigned int> > object_first_section;
+
   // Decide which sections are possible candidates first.
 
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
        p != input_objects->relobj_end();
        ++p)
     {
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, *p);
+      // Lock the object so we can read from it.  No checksum task has
+      // been queued yet, so nothing else is reading it.
+      Task_lock_obj<Object> tl(task, *p);
 
+      unsigned int first_section = section_num;
       for (unsigned int i = 0;i < (*p)->shnum(); ++i)
         {
 	  const std::string section_name = (*p)->section_name(i);
@@ -737,11 +696,84 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
           section_num++;
         }
+      if (section_num > first_section)
+	object_first_section.push_back(std::make_pair(*p, first_section));
+
+      // Look through function descriptors in the relocs of the
+      // candidate sections, modifying symvalue/addend to the code
+      // entry.  This may look at other objects, so it is done here
+      // rather than in the tasks.
+      for (unsigned int i = first_section; i < section_num; ++i)
+	{
+	  Reloc_info_list::iterator it_reloc_info_list =
+	    this->reloc_info_list_.find(this->id_section_[i]);
+	  if (it_reloc_info_list == this->reloc_info_list_.end())
+	    continue;
+	  Sections_reachable_info& v = it_reloc_info_list->second.section_info;
+	  Addend_info& a = it_reloc_info_list->second.addend_info;
+	  for (unsigned int j = 0; j < v.size(); ++j)
+	    {
+	      if (v[j].first == NULL)
+		continue;
+	      Symbol_location loc;
+	      loc.object = v[j].first;
+	      loc.shndx = v[j].second;
+	      loc.offset = convert_types<off_t, long long>(a[j].first
+							   + a[j].second);
+	      target.function_location(&loc);
+	      if (loc.shndx != v[j].second)
+		{
+		  v[j].second = loc.shndx;
+		  a[j].first = loc.offset;
+		  a[j].second = 0;
+		}
+	    }
+	}
+    }
+
+  this->section_checksums_.resize(section_num);
+
+  // Add all the blockers before queuing any tasks, since the tasks
+  // may start running as soon as they are queued.
+  Task_token* checksum_blocker = new Task_token(true);
+  checksum_blocker->add_blockers(object_first_section.size());
+  for (unsigned int i = 0; i < object_first_section.size(); ++i)
+    {
+      unsigned int last_section = (i + 1 < object_first_section.size()
+				   ? object_first_section[i + 1].second
+				   : section_num);
+      workqueue->queue(new Icf_checksum_task(this,
+					     object_first_section[i].first,
+					     object_first_section[i].second,
+					     last_section, checksum_blocker));
+    }
+
+  return checksum_blocker;
+}
+
+// This is the main ICF function called from the Icf_runner task TASK
+// in gold.cc once the checksum tasks are done.  This calls
+// match_sections repeatedly (twice by default) which detects
+// identical functions.
+
+void
+Icf::find_identical_sections(const Task* task, Symbol_table* symtab)
+{
+  std::vector<bool> is_secn_or_group_unique(this->id_section_.size(), false);
+
+  // Compute the checksums which could not be computed by the tasks.
+  for (unsigned int i = 0; i < this->id_section_.size(); ++i)
+    {
+      if (this->section_checksums_[i].is_computed)
+	continue;
+      // Lock the object so we can read from it.  The checksum tasks
+      // are done, and Icf_runner runs before any later task which
+      // could read it.
+      Task_lock_obj<Object> tl(task, this->id_section_[i].first);
+      bool computed = this->compute_section_checksum(i, false);
+      gold_assert(computed);
     }
 
   unsigned int num_iterations = 0;
@@ -756,12 +788,14 @@ Icf::find_identical_sections(const Input_objects* input_objects,
   while (!converged && (num_iterations < max_iterations))
     {
       num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, &is_secn_or_group_unique,
-                                 &section_contents);
+      converged = match_sections(num_iterations, &this->kept_section_id_,
+                                 this->section_checksums_,
+				 &is_secn_or_group_unique);
     }
 
+  // The checksums are not needed any more.
+  std::vector<Section_checksum>().swap(this->section_checksums_);
+
   if (parameters->options().print_icf_sections())
     {
       if (converged)
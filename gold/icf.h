@@ -35,6 +35,8 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Task_token;
+class Workqueue;
 
 class Icf
 {
@@ -64,11 +66,31 @@ class Icf
   typedef Unordered_map<Section_id, Reloc_info,
                         Section_id_hash> Reloc_info_list;
 
+  // The checksums of a section which is a candidate for folding.
+  struct Section_checksum
+  {
+    Section_checksum()
+      : tracked_sections(), is_computed(false)
+    { }
+
+    // MD5 digest of the section contents.
+    unsigned char contents_digest[16];
+    // MD5 digest of the section contents and relocs, leaving out
+    // which sections the relocs to foldable sections point to.
+    unsigned char digest[16];
+    // The section numbers of the foldable sections pointed to by
+    // relocs, in order.
+    std::vector<unsigned int> tracked_sections;
+    // Whether the checksums have been computed.
+    bool is_computed;
+  };
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
-    reloc_info_list_()
+    reloc_info_list_(),
+    section_checksums_()
   { }
 
   // Returns the kept folded identical section corresponding to
@@ -76,11 +98,23 @@ class Icf
   Section_id
   get_folded_section(Object* dup_obj, unsigned int dup_shndx);
 
+  // Decides which sections are candidates for folding, and queues
+  // tasks to compute their checksums.  Returns a blocker which is
+  // unblocked when the tasks are done.
+  Task_token*
+  queue_checksum_tasks(const Task* task,
+                       const Input_objects* input_objects,
+                       Symbol_table* symtab,
+                       Workqueue* workqueue);
+
+  // Computes the checksums of the candidate section SECTION_NUM.
+  bool
+  compute_section_checksum(unsigned int section_num, bool in_task);
+
   // Forms groups of identical sections where the first member
   // of each group is the kept section during folding.
   void
-  find_identical_sections(const Input_objects* input_objects,
-                          Symbol_table* symtab);
+  find_identical_sections(const Task* task, Symbol_table* symtab);
 
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
@@ -160,6 +194,9 @@ class Icf
   bool icf_ready_;
   // This list is populated by gc_process_relocs in gc.h.
   Reloc_info_list reloc_info_list_;
+  // The checksums of each candidate section, indexed like
+  // id_section_.
+  std::vector<Section_checksum> section_checksums_;
 };
 
 // This function returns true if this section corresponds to a function that
@@ -44,7 +44,8 @@ namespace gold {
 // Version number for the .gnu_incremental_inputs section.
 // Version 1 was the initial checkin.
 // Version 2 adds some padding to ensure 8-byte alignment where necessary.
-const unsigned int INCREMENTAL_LINK_VERSION = 2;
+// Version 3 adds a digest of the contents of each input file.
+const unsigned int INCREMENTAL_LINK_VERSION = 3;
 
 // This class manages the .gnu_incremental_inputs section, which holds
 // the header information, a directory of input files, and separate
@@ -172,6 +173,190 @@ Incremental_binary::error(const char* format, ...) const
   va_end(args);
 }
 
+// Return TRUE if input file N has changed since the last link.  The
+// answer is computed once per file, since archive members and
+// libraries ask about the same file many times.
+
+bool
+Incremental_binary::file_has_changed(unsigned int n)
+{
+  if (this->file_status_.empty())
+    this->file_status_.resize(this->input_file_count(), FILE_NOT_CHECKED);
+  gold_assert(n < this->file_status_.size());
+  if (this->file_status_[n] == FILE_NOT_CHECKED)
+    {
+      if (this->do_file_has_changed(n))
+	{
+	  this->file_status_[n] = FILE_CHANGED;
+	  ++Incremental_binary::total_changed_files;
+	}
+      else
+	{
+	  this->file_status_[n] = FILE_UNCHANGED;
+	  ++Incremental_binary::total_unchanged_files;
+	}
+    }
+  return this->file_status_[n] == FILE_CHANGED;
+}
+
+// Check the incremental disposition and the timestamp of input file N.
+
+Incremental_binary::File_status
+Incremental_binary::check_file_timestamp(unsigned int n) const
+{
+  const Input_reader* input_file = this->get_input_reader(n);
+  Incremental_disposition disp = INCREMENTAL_CHECK;
+
+  // For files named in scripts, find the file that was actually named
+  // on the command line, so that we can get the incremental disposition
+  // flag.
+  unsigned int arg_index = n;
+  Script_info* script = this->get_script_info(n);
+  if (script != NULL)
+    arg_index = script->input_file_index();
+
+  const Input_argument* input_argument = this->get_input_argument(arg_index);
+  if (input_argument != NULL)
+    disp = input_argument->file().options().incremental_disposition();
+
+  // For files at the beginning of the command line (i.e., those added
+  // implicitly by gcc), check whether the --incremental-startup-unchanged
+  // option was used.
+  if (disp == INCREMENTAL_STARTUP)
+    disp = parameters->options().incremental_startup_disposition();
+
+  if (disp != INCREMENTAL_CHECK)
+    return disp == INCREMENTAL_CHANGED ? FILE_CHANGED : FILE_UNCHANGED;
+
+  Timespec old_mtime = input_file->get_mtime();
+  Timespec new_mtime;
+  if (!get_mtime(input_file->filename(), &new_mtime))
+    {
+      // If we can't open get the current modification time, assume it has
+      // changed.  If the file doesn't exist, we'll issue an error when we
+      // try to open it later.
+      return FILE_CHANGED;
+    }
+
+  if (new_mtime.seconds < old_mtime.seconds
+      || (new_mtime.seconds == old_mtime.seconds
+	  && new_mtime.nanoseconds <= old_mtime.nanoseconds))
+    return FILE_UNCHANGED;
+
+  // The file is newer.  Its contents must be compared if we recorded
+  // a digest of them.
+  static const unsigned char no_digest[file_digest_size] = { 0 };
+  if (memcmp(input_file->get_digest(), no_digest, file_digest_size) == 0)
+    return FILE_CHANGED;
+  return FILE_NOT_CHECKED;
+}
+
+// This task computes the digest of an input file for
+// Incremental_binary::queue_digest_tasks.
+
+class Incremental_digest_task : public Task
+{
+ public:
+  Incremental_digest_task(Incremental_binary* ibase, unsigned int n,
+			  Task_token* blocker)
+    : ibase_(ibase), n_(n), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->ibase_->compute_file_digest(this->n_); }
+
+  std::string
+  get_name() const
+  {
+    return (std::string("Incremental_digest_task ")
+	    + this->ibase_->get_input_reader(this->n_)->filename());
+  }
+
+ private:
+  Incremental_binary* ibase_;
+  unsigned int n_;
+  Task_token* blocker_;
+};
+
+// Queue a task to compute the digest of each input file whose
+// contents must be compared with the last link.
+
+void
+Incremental_binary::queue_digest_tasks(Workqueue* workqueue,
+				       Task_token* blocker)
+{
+  unsigned int count = this->input_file_count();
+  if (this->file_status_.empty())
+    this->file_status_.resize(count, FILE_NOT_CHECKED);
+  this->file_digests_.resize(count);
+  for (unsigned int i = 0; i < count; ++i)
+    {
+      // Scripts were already checked by check_inputs, and archive
+      // members are checked by the timestamp of the archive.
+      if (this->file_status_[i] != FILE_NOT_CHECKED
+	  || (this->get_input_reader(i)->type()
+	      == INCREMENTAL_INPUT_ARCHIVE_MEMBER)
+	  || this->check_file_timestamp(i) != FILE_NOT_CHECKED)
+	continue;
+      blocker->add_blocker();
+      workqueue->queue(new Incremental_digest_task(this, i, blocker));
+    }
+}
+
+// Compute the digest of the current contents of input file N.
+
+void
+Incremental_binary::compute_file_digest(unsigned int n)
+{
+  File_digest* fd = &this->file_digests_[n];
+  fd->valid = get_file_digest(this->get_input_reader(n)->filename(),
+			      fd->digest);
+  fd->computed = true;
+}
+
+// Get the digest of the current contents of input file N.
+
+bool
+Incremental_binary::get_current_digest(unsigned int n, const char* filename,
+				       unsigned char* digest) const
+{
+  if (n < this->file_digests_.size() && this->file_digests_[n].computed)
+    {
+      const File_digest& fd(this->file_digests_[n]);
+      memcpy(digest, fd.digest, file_digest_size);
+      return fd.valid;
+    }
+  return get_file_digest(filename, digest);
+}
+
+// Statistics.
+
+unsigned int Incremental_binary::total_unchanged_files;
+unsigned int Incremental_binary::total_changed_files;
+unsigned int Incremental_binary::total_digest_matches;
+
+// Print statistical information to stderr.  This is used for --stats.
+
+void
+Incremental_binary::print_stats()
+{
+  fprintf(stderr, _("%s: incremental inputs reused: %u\n"),
+	  program_name, Incremental_binary::total_unchanged_files);
+  fprintf(stderr, _("%s: incremental inputs read again: %u\n"),
+	  program_name, Incremental_binary::total_changed_files);
+  fprintf(stderr, _("%s: incremental inputs reused by content digest: %u\n"),
+	  program_name, Incremental_binary::total_digest_matches);
+}
+
 // Return TRUE if a section of type SH_TYPE can be updated in place
 // during an incremental update.  We can update sections of type PROGBITS,
 // NOBITS, INIT_ARRAY, FINI_ARRAY, PREINIT_ARRAY, and NOTE.  All others
@@ -451,7 +636,7 @@ Sized_incremental_binary<size, big_endian>::do_check_inputs(
 	  // No special treatment necessary.
 	  break;
 	case INCREMENTAL_INPUT_SCRIPT:
-	  if (this->do_file_has_changed(i))
+	  if (this->file_has_changed(i))
 	    {
 	      explain_no_incremental(_("%s: script file changed"),
 				     input_file.filename());
@@ -473,45 +658,22 @@ bool
 Sized_incremental_binary<size, big_endian>::do_file_has_changed(
     unsigned int n) const
 {
-  Input_entry_reader input_file = this->inputs_reader_.input_file(n);
-  Incremental_disposition disp = INCREMENTAL_CHECK;
-
-  // For files named in scripts, find the file that was actually named
-  // on the command line, so that we can get the incremental disposition
-  // flag.
-  Script_info* script = this->get_script_info(n);
-  if (script != NULL)
-    n = script->input_file_index();
-
-  const Input_argument* input_argument = this->get_input_argument(n);
-  if (input_argument != NULL)
-    disp = input_argument->file().options().incremental_disposition();
-
-  // For files at the beginning of the command line (i.e., those added
-  // implicitly by gcc), check whether the --incremental-startup-unchanged
-  // option was used.
-  if (disp == INCREMENTAL_STARTUP)
-    disp = parameters->options().incremental_startup_disposition();
-
-  if (disp != INCREMENTAL_CHECK)
-    return disp == INCREMENTAL_CHANGED;
+  File_status status = this->check_file_timestamp(n);
+  if (status != FILE_NOT_CHECKED)
+    return status == FILE_CHANGED;
 
+  // The file is newer, but a build system may have rewritten it with
+  // the same contents.  If the digest of the contents still matches,
+  // we can keep using the previous contributions from the file.
+  Input_entry_reader input_file = this->inputs_reader_.input_file(n);
   const char* filename = input_file.filename();
-  Timespec old_mtime = input_file.get_mtime();
-  Timespec new_mtime;
-  if (!get_mtime(filename, &new_mtime))
-    {
-      // If we can't open get the current modification time, assume it has
-      // changed.  If the file doesn't exist, we'll issue an error when we
-      // try to open it later.
-      return true;
-    }
-
-  if (new_mtime.seconds > old_mtime.seconds)
-    return true;
-  if (new_mtime.seconds == old_mtime.seconds
-      && new_mtime.nanoseconds > old_mtime.nanoseconds)
+  unsigned char new_digest[file_digest_size];
+  if (!this->get_current_digest(n, filename, new_digest)
+      || memcmp(input_file.get_digest(), new_digest, file_digest_size) != 0)
     return true;
+
+  gold_debug(DEBUG_INCREMENTAL, "%s: contents unchanged", filename);
+  ++Incremental_binary::total_digest_matches;
   return false;
 }
 
@@ -1028,6 +1190,9 @@ Incremental_inputs::report_archive_begin(Library_base* arch,
   this->strtab_->add(arch->filename().c_str(), false, &filename_key);
   Incremental_archive_entry* entry =
       new Incremental_archive_entry(filename_key, arg_serial, mtime);
+  unsigned char digest[file_digest_size];
+  arch->get_file_digest(digest);
+  entry->set_digest(digest);
   arch->set_incremental_info(entry);
 
   if (script_info != NULL)
@@ -1088,7 +1253,8 @@ Incremental_inputs::report_archive_end(Library_base* arch)
 
 void
 Incremental_inputs::report_object(Object* obj, unsigned int arg_serial,
-				  Library_base* arch, Script_info* script_info)
+				  Library_base* arch, Script_info* script_info,
+				  const unsigned char* digest)
 {
   Stringpool::Key filename_key;
   Timespec mtime = obj->get_mtime();
@@ -1132,6 +1298,21 @@ Incremental_inputs::report_object(Object* obj, unsigned int arg_serial,
   if (obj->as_needed())
     input_entry->set_as_needed();
 
+  // Archive members are checked through their archive, so we only
+  // need a digest for files named directly.  That is normally
+  // computed by the Read_symbols task, which runs in parallel.
+  if (arch == NULL)
+    {
+      if (digest != NULL)
+	input_entry->set_digest(digest);
+      else
+	{
+	  unsigned char file_digest[file_digest_size];
+	  obj->get_file_digest(file_digest);
+	  input_entry->set_digest(file_digest);
+	}
+    }
+
   this->inputs_.push_back(input_entry);
 
   if (script_info != NULL)
@@ -1179,13 +1360,15 @@ Incremental_inputs::report_comdat_group(Object* obj, const char* name)
 void
 Incremental_inputs::report_script(Script_info* script,
 				  unsigned int arg_serial,
-				  Timespec mtime)
+				  Timespec mtime,
+				  const unsigned char* digest)
 {
   Stringpool::Key filename_key;
 
   this->strtab_->add(script->filename().c_str(), false, &filename_key);
   Incremental_script_entry* entry =
       new Incremental_script_entry(filename_key, arg_serial, script, mtime);
+  entry->set_digest(digest);
   this->inputs_.push_back(entry);
   script->set_incremental_info(entry);
 }
@@ -1498,7 +1681,8 @@ Output_section_incremental_inputs<size, big_endian>::write_input_files(
       Swap32::writeval(pov + 16, mtime.nanoseconds);
       Swap16::writeval(pov + 20, flags);
       Swap16::writeval(pov + 22, (*p)->arg_serial());
-      gold_assert(this->input_entry_size == 24);
+      memcpy(pov + 24, (*p)->get_digest(), file_digest_size);
+      gold_assert(this->input_entry_size == 40);
       pov += this->input_entry_size;
     }
   return pov;
@@ -2540,13 +2724,14 @@ Sized_relobj_incr<size, big_endian>::do_set_local_dynsym_offset(off_t)
 // for this object.
 
 template<int size, bool big_endian>
-void
+Task_token*
 Sized_relobj_incr<size, big_endian>::do_relocate(const Symbol_table*,
 						 const Layout* layout,
-						 Output_file* of)
+						 Output_file* of,
+						 Workqueue*)
 {
   if (this->incr_reloc_count_ == 0)
-    return;
+    return NULL;
 
   const unsigned int incr_reloc_size =
       Incremental_relocs_reader<size, big_endian>::reloc_size;
@@ -2661,6 +2846,8 @@ Sized_relobj_incr<size, big_endian>::do_relocate(const Symbol_table*,
       of->write_output_view(this->local_dynsym_offset_, dyn_output_size,
 			    dyn_oview);
     }
+
+  return NULL;
 }
 
 // Set the offset of a section.
@@ -102,7 +102,7 @@ class Incremental_input_entry
     : filename_key_(filename_key), file_index_(0), offset_(0), info_offset_(0),
       arg_serial_(arg_serial), mtime_(mtime), is_in_system_directory_(false),
       as_needed_(false)
-  { }
+  { memset(this->digest_, 0, sizeof this->digest_); }
 
   virtual
   ~Incremental_input_entry()
@@ -156,6 +156,17 @@ class Incremental_input_entry
   get_mtime() const
   { return this->mtime_; }
 
+  // Set the digest of the contents of the input file.
+  void
+  set_digest(const unsigned char* digest)
+  { memcpy(this->digest_, digest, sizeof this->digest_); }
+
+  // Get the digest of the contents of the input file.  This is all
+  // zeroes if we did not compute one.
+  const unsigned char*
+  get_digest() const
+  { return this->digest_; }
+
   // Record that the file was found in a system directory.
   void
   set_is_in_system_directory()
@@ -248,6 +259,9 @@ class Incremental_input_entry
   // Last modification time of the file.
   Timespec mtime_;
 
+  // Digest of the contents of the file.
+  unsigned char digest_[file_digest_size];
+
   // TRUE if the file was found in a system directory.
   bool is_in_system_directory_;
 
@@ -582,10 +596,11 @@ class Incremental_inputs
   report_archive_end(Library_base* arch);
 
   // Record the info for object file OBJ.  If ARCH is not NULL,
-  // attach the object file to the archive.
+  // attach the object file to the archive.  DIGEST is the digest of
+  // the file if it has already been computed, or NULL.
   void
   report_object(Object* obj, unsigned int arg_serial, Library_base* arch,
-		Script_info* script_info);
+		Script_info* script_info, const unsigned char* digest);
 
   // Record an input section belonging to object file OBJ.
   void
@@ -596,10 +611,11 @@ class Incremental_inputs
   void
   report_comdat_group(Object* obj, const char* name);
 
-  // Record the info for input script SCRIPT.
+  // Record the info for input script SCRIPT.  DIGEST is the digest of
+  // the script file.
   void
   report_script(Script_info* script, unsigned int arg_serial,
-		Timespec mtime);
+		Timespec mtime, const unsigned char* digest);
 
   // Return the running count of incremental relocations.
   unsigned int
@@ -760,8 +776,9 @@ class Incremental_inputs_reader
   // (3 x 4-byte fields, plus 4 bytes padding.)
   static const unsigned int header_size = 16;
   // Size of an input file entry.
-  // (2 x 4-byte fields, 1 x 12-byte field, 2 x 2-byte fields.)
-  static const unsigned int input_entry_size = 24;
+  // (2 x 4-byte fields, 1 x 12-byte field, 2 x 2-byte fields,
+  // 1 x 16-byte field.)
+  static const unsigned int input_entry_size = 40;
   // Size of the first part of the supplemental info block for
   // relocatable objects and archive members.
   // (7 x 4-byte fields, plus 4 bytes padding.)
@@ -846,6 +863,12 @@ class Incremental_inputs_reader
       return t;
     }
 
+    // Return the digest of the file contents, or all zeroes if none
+    // was recorded.
+    const unsigned char*
+    get_digest() const
+    { return this->inputs_->p_ + this->offset_ + 24; }
+
     // Return the type of input file.
     Incremental_input_type
     type() const
@@ -1342,7 +1365,7 @@ class Incremental_binary
  public:
   Incremental_binary(Output_file* output, Target* /*target*/)
     : input_args_map_(), library_map_(), script_map_(),
-      output_(output)
+      output_(output), file_status_(), file_digests_()
   { }
 
   virtual
@@ -1380,6 +1403,10 @@ class Incremental_binary
     get_mtime() const
     { return this->do_get_mtime(); }
 
+    const unsigned char*
+    get_digest() const
+    { return this->do_get_digest(); }
+
     Incremental_input_type
     type() const
     { return this->do_type(); }
@@ -1403,6 +1430,9 @@ class Incremental_binary
     virtual Timespec
     do_get_mtime() const = 0;
 
+    virtual const unsigned char*
+    do_get_digest() const = 0;
+
     virtual Incremental_input_type
     do_type() const = 0;
 
@@ -1427,9 +1457,25 @@ class Incremental_binary
   { return this->do_get_input_reader(n); }
 
   // Return TRUE if the input file N has changed since the last link.
+  // This checks each file only once.
   bool
-  file_has_changed(unsigned int n) const
-  { return this->do_file_has_changed(n); }
+  file_has_changed(unsigned int n);
+
+  // Queue a task to compute the digest of each input file which is
+  // newer than the last link, so that file_has_changed can compare
+  // the contents of those files without reading them one at a time.
+  // The tasks hold BLOCKER until they are done.
+  void
+  queue_digest_tasks(Workqueue*, Task_token* blocker);
+
+  // Compute the digest of the current contents of input file N.  This
+  // is called by the tasks queued by queue_digest_tasks.
+  void
+  compute_file_digest(unsigned int n);
+
+  // Print statistical information to stderr.  This is used for --stats.
+  static void
+  print_stats();
 
   // Return the Input_argument for input file N.  Returns NULL if
   // the Input_argument is not available.
@@ -1543,6 +1589,29 @@ class Incremental_binary
   virtual bool
   do_file_has_changed(unsigned int n) const = 0;
 
+  // The result of checking an input file.
+  enum File_status
+  {
+    FILE_NOT_CHECKED,
+    FILE_UNCHANGED,
+    FILE_CHANGED
+  };
+
+  // Check the incremental disposition and the timestamp of input file
+  // N.  Return FILE_CHANGED or FILE_UNCHANGED if they tell whether the
+  // file has changed, or FILE_NOT_CHECKED if its contents must be
+  // compared with the digest recorded by the last link.
+  File_status
+  check_file_timestamp(unsigned int n) const;
+
+  // Get the digest of the current contents of input file N, named
+  // FILENAME, into DIGEST.  Use the digest computed by a task from
+  // queue_digest_tasks if there is one.  Return false if the file
+  // cannot be read.
+  bool
+  get_current_digest(unsigned int n, const char* filename,
+		     unsigned char* digest) const;
+
   // Initialize the layout of the output file based on the existing
   // output file.
   virtual void
@@ -1577,9 +1646,38 @@ class Incremental_binary
   // Map from an input file index to a Script_info.
   std::vector<Script_info*> script_map_;
 
+  // The number of input files whose timestamp changed but whose
+  // contents did not.
+  static unsigned int total_digest_matches;
+
  private:
+  // The digest of the current contents of an input file, computed by a
+  // task queued by queue_digest_tasks.
+  struct File_digest
+  {
+    File_digest()
+      : computed(false), valid(false)
+    { }
+
+    // Whether a task computed the digest.
+    bool computed;
+    // Whether the file could be read.
+    bool valid;
+    unsigned char digest[file_digest_size];
+  };
+
+  // The number of input files reused from the previous link.
+  static unsigned int total_unchanged_files;
+  // The number of input files read again.
+  static unsigned int total_changed_files;
+
   // Edited output file object.
   Output_file* output_;
+  // Map from an input file index to the result of checking the file.
+  std::vector<File_status> file_status_;
+  // Map from an input file index to the digest computed for the file.
+  // Each task from queue_digest_tasks sets a different element.
+  std::vector<File_digest> file_digests_;
 };
 
 template<int size, bool big_endian>
@@ -1721,6 +1819,10 @@ class Sized_incremental_binary : public Incremental_binary
     do_get_mtime() const
     { return this->reader_.get_mtime(); }
 
+    const unsigned char*
+    do_get_digest() const
+    { return this->reader_.get_digest(); }
+
     Incremental_input_type
     do_type() const
     { return this->reader_.type(); }
@@ -1869,6 +1971,11 @@ class Sized_relobj_incr : public Sized_relobj<size, big_endian>
   do_get_mtime()
   { return this->input_reader_.get_mtime(); }
 
+  // Return the digest of the file recorded by the last link.
+  void
+  do_get_file_digest(unsigned char* digest)
+  { memcpy(digest, this->input_reader_.get_digest(), file_digest_size); }
+
   // Read the symbols.
   void
   do_read_symbols(Read_symbols_data*);
@@ -2008,8 +2115,9 @@ class Sized_relobj_incr : public Sized_relobj<size, big_endian>
   do_set_local_dynsym_offset(off_t);
 
   // Relocate the input sections and write out the local symbols.
-  void
-  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of);
+  Task_token*
+  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of,
+	      Workqueue*);
 
   // Set the offset of a section.
   void
@@ -2080,6 +2188,11 @@ class Sized_incr_dynobj : public Dynobj
   do_get_mtime()
   { return this->input_reader_.get_mtime(); }
 
+  // Return the digest of the file recorded by the last link.
+  void
+  do_get_file_digest(unsigned char* digest)
+  { memcpy(digest, this->input_reader_.get_digest(), file_digest_size); }
+
   // Read the symbols.
   void
   do_read_symbols(Read_symbols_data*);
@@ -2234,6 +2347,11 @@ class Incremental_library : public Library_base
   do_get_mtime()
   { return this->input_reader_->get_mtime(); }
 
+  // Return the digest of the archive file recorded by the last link.
+  void
+  do_get_file_digest(unsigned char* digest)
+  { memcpy(digest, this->input_reader_->get_digest(), file_digest_size); }
+
   // Iterator for unused global symbols in the library.
   void
   do_for_all_unused_symbols(Symbol_visitor_base* v) const;
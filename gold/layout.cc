@@ -52,6 +52,7 @@
 #include "descriptors.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "timer.h"
 #include "layout.h"
 
 namespace gold
@@ -235,25 +236,149 @@ Free_list::print_stats()
 	  program_name, Free_list::num_allocate_visits);
 }
 
-// A Hash_task computes the MD5 checksum of an array of char.
-// It has a blocker on either side (i.e., the task cannot run until
-// the first is unblocked, and it unblocks the second after running).
+// The function used by a Hash_task to hash a chunk of the output
+// file for the build ID.  It writes HASH_SIZE bytes to DST.
+
+typedef void (*Build_id_hash_function)(const unsigned char* src, size_t size,
+				       unsigned char* dst);
+
+// Compute the MD5 checksum of a chunk, for --build-id=tree.
+
+static void
+build_id_md5_chunk(const unsigned char* src, size_t size, unsigned char* dst)
+{
+  md5_buffer(reinterpret_cast<const char*>(src), size, dst);
+}
+
+// A fast, non-cryptographic 64-bit hash, for --build-id=fast.  This is
+// the XXH64 algorithm.  It reads its input and writes its output in
+// little-endian order, so the result does not depend on the host.
+
+const uint64_t fast_hash_prime1 = 0x9e3779b185ebca87ULL;
+const uint64_t fast_hash_prime2 = 0xc2b2ae3d27d4eb4fULL;
+const uint64_t fast_hash_prime3 = 0x165667b19e3779f9ULL;
+const uint64_t fast_hash_prime4 = 0x85ebca77c2b2ae63ULL;
+const uint64_t fast_hash_prime5 = 0x27d4eb2f165667c5ULL;
+
+static inline uint64_t
+fast_hash_rotl(uint64_t v, int n)
+{
+  return (v << n) | (v >> (64 - n));
+}
+
+static inline uint64_t
+fast_hash_round(uint64_t acc, uint64_t input)
+{
+  acc += input * fast_hash_prime2;
+  acc = fast_hash_rotl(acc, 31);
+  return acc * fast_hash_prime1;
+}
+
+static inline uint64_t
+fast_hash_merge_round(uint64_t acc, uint64_t val)
+{
+  acc ^= fast_hash_round(0, val);
+  return acc * fast_hash_prime1 + fast_hash_prime4;
+}
+
+static inline uint64_t
+fast_hash_read64(const unsigned char* p)
+{
+  return elfcpp::Swap_unaligned<64, false>::readval(p);
+}
+
+static void
+build_id_fast_chunk(const unsigned char* src, size_t size, unsigned char* dst)
+{
+  const unsigned char* p = src;
+  const unsigned char* const pend = src + size;
+  uint64_t h;
+
+  if (size >= 32)
+    {
+      uint64_t v1 = fast_hash_prime1 + fast_hash_prime2;
+      uint64_t v2 = fast_hash_prime2;
+      uint64_t v3 = 0;
+      uint64_t v4 = -fast_hash_prime1;
+      const unsigned char* const plimit = pend - 32;
+      do
+	{
+	  v1 = fast_hash_round(v1, fast_hash_read64(p));
+	  v2 = fast_hash_round(v2, fast_hash_read64(p + 8));
+	  v3 = fast_hash_round(v3, fast_hash_read64(p + 16));
+	  v4 = fast_hash_round(v4, fast_hash_read64(p + 24));
+	  p += 32;
+	}
+      while (p <= plimit);
+
+      h = (fast_hash_rotl(v1, 1) + fast_hash_rotl(v2, 7)
+	   + fast_hash_rotl(v3, 12) + fast_hash_rotl(v4, 18));
+      h = fast_hash_merge_round(h, v1);
+      h = fast_hash_merge_round(h, v2);
+      h = fast_hash_merge_round(h, v3);
+      h = fast_hash_merge_round(h, v4);
+    }
+  else
+    h = fast_hash_prime5;
+
+  h += static_cast<uint64_t>(size);
+
+  while (p + 8 <= pend)
+    {
+      h ^= fast_hash_round(0, fast_hash_read64(p));
+      h = fast_hash_rotl(h, 27) * fast_hash_prime1 + fast_hash_prime4;
+      p += 8;
+    }
+  if (p + 4 <= pend)
+    {
+      uint64_t k = elfcpp::Swap_unaligned<32, false>::readval(p);
+      h ^= k * fast_hash_prime1;
+      h = fast_hash_rotl(h, 23) * fast_hash_prime2 + fast_hash_prime3;
+      p += 4;
+    }
+  while (p < pend)
+    {
+      h ^= *p * fast_hash_prime5;
+      h = fast_hash_rotl(h, 11) * fast_hash_prime1;
+      ++p;
+    }
+
+  h ^= h >> 33;
+  h *= fast_hash_prime2;
+  h ^= h >> 29;
+  h *= fast_hash_prime3;
+  h ^= h >> 32;
+
+  elfcpp::Swap_unaligned<64, false>::writeval(dst, h);
+}
+
+// A Hash_task computes the checksum of a chunk of the output file,
+// using either MD5 or the fast hash.  It has a blocker on either side
+// (i.e., the task cannot run until the first is unblocked, and it
+// unblocks the second after running).
 
 class Hash_task : public Task
 {
  public:
-  Hash_task(const unsigned char* src,
+  Hash_task(Build_id_hash_function hash,
+	    Output_file* of,
+	    off_t offset,
 	    size_t size,
 	    unsigned char* dst,
 	    Task_token* build_id_blocker,
 	    Task_token* final_blocker)
-    : src_(src), size_(size), dst_(dst), build_id_blocker_(build_id_blocker),
-      final_blocker_(final_blocker)
+    : hash_(hash), of_(of), offset_(offset), size_(size), dst_(dst),
+      build_id_blocker_(build_id_blocker), final_blocker_(final_blocker)
   { }
 
   void
   run(Workqueue*)
-  { md5_buffer(reinterpret_cast<const char*>(src_), size_, dst_); }
+  {
+    const unsigned char* src = this->of_->get_input_view(this->offset_,
+							 this->size_);
+    this->hash_(src, this->size_, this->dst_);
+    this->of_->free_input_view(this->offset_, this->size_, src);
+  }
 
   Task_token*
   is_runnable();
@@ -268,7 +393,9 @@ class Hash_task : public Task
   { return "Hash_task"; }
 
  private:
-  const unsigned char* const src_;
+  const Build_id_hash_function hash_;
+  Output_file* const of_;
+  const off_t offset_;
   const size_t size_;
   unsigned char* const dst_;
   Task_token* const build_id_blocker_;
@@ -283,6 +410,55 @@ Hash_task::is_runnable()
   return NULL;
 }
 
+// A Merge_wait_task waits for THIS_BLOCKER and for the tasks which
+// process SHF_MERGE sections, and then unblocks NEXT_BLOCKER.
+
+class Merge_wait_task : public Task
+{
+ public:
+  Merge_wait_task(Task_token* this_blocker,
+		  const std::vector<Task_token*>& merge_blockers,
+		  Task_token* next_blocker)
+    : this_blocker_(this_blocker), merge_blockers_(merge_blockers),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Merge_wait_task()
+  {
+    delete this->this_blocker_;
+    for (size_t i = 0; i < this->merge_blockers_.size(); ++i)
+      delete this->merge_blockers_[i];
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    for (size_t i = 0; i < this->merge_blockers_.size(); ++i)
+      if (this->merge_blockers_[i]->is_blocked())
+	return this->merge_blockers_[i];
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { }
+
+  std::string
+  get_name() const
+  { return "Merge_wait_task"; }
+
+ private:
+  Task_token* this_blocker_;
+  std::vector<Task_token*> merge_blockers_;
+  Task_token* next_blocker_;
+};
+
 // Layout::Relaxation_debug_check methods.
 
 // Check that sections and special data are in reset states.
@@ -367,10 +543,6 @@ Layout::Relaxation_debug_check::verify_sections(
 void
 Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 {
-  // See if any of the input definitions violate the One Definition Rule.
-  // TODO: if this is too slow, do this as a task, rather than inline.
-  this->symtab_->detect_odr_violations(task, this->options_.output_file_name());
-
   Layout* layout = this->layout_;
   off_t file_size = layout->finalize(this->input_objects_,
 				     this->symtab_,
@@ -451,9 +623,9 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     build_id_note_(NULL),
     array_of_hashes_(NULL),
     size_of_array_of_hashes_(0),
-    input_view_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
+    compressed_sections_(),
     group_signatures_(),
     output_file_size_(-1),
     have_added_input_section_(false),
@@ -472,6 +644,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     script_output_section_data_list_(),
     segment_states_(NULL),
     relaxation_debug_check_(NULL),
+    relaxation_pass_stats_(),
     section_order_map_(),
     section_segment_map_(),
     input_section_position_(),
@@ -494,6 +667,15 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
   // The section name pool is worth optimizing in all cases, because
   // it is small, but there are often overlaps due to .rel sections.
   this->namepool_.set_optimize();
+
+  // Sharing suffixes in the symbol string tables is cheap enough to
+  // do by default.  An incremental link needs the offsets to stay
+  // as they were assigned.
+  if (!parameters->incremental())
+    {
+      this->sympool_.set_optimize();
+      this->dynpool_.set_optimize();
+    }
 }
 
 // For incremental links, record the base file to be modified.
@@ -1541,8 +1723,8 @@ Layout::add_eh_frame_for_plt(Output_data* plt, const unsigned char* cie_data,
     }
 }
 
-// Scan a .debug_info or .debug_types section, and add summary
-// information to the .gdb_index section.
+// Record a .debug_info or .debug_types section to be scanned for
+// summary information for the .gdb_index section.
 
 template<int size, bool big_endian>
 void
@@ -1573,6 +1755,38 @@ Layout::add_to_gdb_index(bool is_type_unit,
 					 reloc_type);
 }
 
+// Queue the tasks which scan the debug info for the .gdb_index
+// section.
+
+Task_token*
+Layout::queue_gdb_index_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (this->gdb_index_data_ == NULL)
+    return blocker;
+  return this->gdb_index_data_->queue_scan_tasks(workqueue, blocker);
+}
+
+// Queue the tasks which find the distinct strings in SHF_MERGE string
+// sections.
+
+Task_token*
+Layout::queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  std::vector<Task_token*> merge_blockers;
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    (*p)->queue_merge_tasks(workqueue, &merge_blockers);
+  if (merge_blockers.empty())
+    return blocker;
+
+  Task_token* next_blocker = new Task_token(true);
+  next_blocker->add_blocker();
+  workqueue->queue(new Merge_wait_task(blocker, merge_blockers,
+				       next_blocker));
+  return next_blocker;
+}
+
 // Add POSD to an output section using NAME, TYPE, and FLAGS.  Return
 // the output section.
 
@@ -1616,8 +1830,13 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
   if ((flags & elfcpp::SHF_ALLOC) == 0
       && strcmp(parameters->options().compress_debug_sections(), "none") != 0
       && is_compressible_debug_section(name))
-    os = new Output_compressed_section(&parameters->options(), name, type,
-				       flags);
+    {
+      Output_compressed_section* cos =
+	new Output_compressed_section(&parameters->options(), name, type,
+				      flags);
+      this->compressed_sections_.push_back(cos);
+      os = cos;
+    }
   else if ((flags & elfcpp::SHF_ALLOC) == 0
 	   && parameters->options().strip_debug_non_line()
 	   && strcmp(".debug_abbrev", name) == 0)
@@ -2738,15 +2957,38 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
     this->prepare_for_relaxation();
 
   // Run the relaxation loop to lay out sections.
+  bool gather_stats = parameters->options().stats() && target->may_relax();
+  bool relax_again;
   do
     {
+      long long start_time = gather_stats ? wall_clock_usec() : 0;
+
       off = this->relaxation_loop_body(pass, target, symtab, &load_seg,
 				       phdr_seg, segment_headers, file_header,
 				       &shndx);
       pass++;
+
+      long long layout_end_time = gather_stats ? wall_clock_usec() : 0;
+
+      relax_again = (target->may_relax()
+		     && target->relax(pass, input_objects, symtab, this,
+				      task));
+
+      if (gather_stats)
+	{
+	  Relaxation_pass_stats stats;
+	  stats.layout_time = layout_end_time - start_time;
+	  stats.relax_time = wall_clock_usec() - layout_end_time;
+	  stats.sections_changed = 0;
+	  for (Section_list::const_iterator p = this->section_list_.begin();
+	       p != this->section_list_.end();
+	       ++p)
+	    if ((*p)->section_offsets_need_adjustment())
+	      ++stats.sections_changed;
+	  this->relaxation_pass_stats_.push_back(stats);
+	}
     }
-  while (target->may_relax()
-	 && target->relax(pass, input_objects, symtab, this, task));
+  while (relax_again);
 
   // If there is a load segment that contains the file and program headers,
   // provide a symbol __ehdr_start pointing there.
@@ -3019,7 +3261,9 @@ Layout::create_build_id()
   std::string desc;
   if (strcmp(style, "md5") == 0)
     descsz = 128 / 8;
-  else if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
+  else if ((strcmp(style, "sha1") == 0)
+	   || (strcmp(style, "tree") == 0)
+	   || (strcmp(style, "fast") == 0))
     descsz = 160 / 8;
   else if (strcmp(style, "uuid") == 0)
     {
@@ -5347,53 +5591,102 @@ Layout::write_sections_after_input_sections(Output_file* of)
   this->section_headers_->write(of);
 }
 
+// Queue the tasks which compress the debug sections.  These run in
+// parallel with each other once BLOCKER is unblocked, i.e., once all
+// the input sections have been written out, rather than one section
+// after another when the section sizes are finalized.
+
+Task_token*
+Layout::queue_compression_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (this->compressed_sections_.empty())
+    return blocker;
+
+  // Add all the blockers before queuing any tasks, since the tasks
+  // may start running as soon as they are queued.
+  unsigned int count = 0;
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    count += (*p)->set_up_compression_tasks();
+
+  Task_token* compressed_blocker = new Task_token(true);
+  compressed_blocker->add_blockers(count);
+
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    (*p)->queue_compression_tasks(workqueue, blocker, compressed_blocker);
+
+  return compressed_blocker;
+}
+
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
+// The "fast" style is always computed as a tree, using the fast hash
+// for the chunks, so that the chunks can always be hashed in parallel.
 // We compute a checksum over the entire file because that is simplest.
 
 Task_token*
 Layout::queue_build_id_tasks(Workqueue* workqueue, Task_token* build_id_blocker,
 			     Output_file* of)
 {
+  if (this->build_id_note_ == NULL)
+    return build_id_blocker;
+
   const size_t filesize = (this->output_file_size() <= 0 ? 0
 			   : static_cast<size_t>(this->output_file_size()));
-  if (this->build_id_note_ != NULL
-      && strcmp(parameters->options().build_id(), "tree") == 0
-      && parameters->options().build_id_chunk_size_for_treehash() > 0
+  const char* style = parameters->options().build_id();
+  size_t chunk_size = parameters->options().build_id_chunk_size_for_treehash();
+  Build_id_hash_function hash;
+  size_t hash_size;
+  if (strcmp(style, "tree") == 0
+      && chunk_size > 0
       && filesize > 0
       && (filesize >=
 	  parameters->options().build_id_min_file_size_for_treehash()))
     {
-      static const size_t MD5_OUTPUT_SIZE_IN_BYTES = 16;
-      const size_t chunk_size =
-	  parameters->options().build_id_chunk_size_for_treehash();
-      const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
-      Task_token* post_hash_tasks_blocker = new Task_token(true);
-      post_hash_tasks_blocker->add_blockers(num_hashes);
-      this->size_of_array_of_hashes_ = num_hashes * MD5_OUTPUT_SIZE_IN_BYTES;
-      const unsigned char* src = of->get_input_view(0, filesize);
-      this->input_view_ = src;
-      unsigned char *dst = new unsigned char[this->size_of_array_of_hashes_];
-      this->array_of_hashes_ = dst;
-      for (size_t i = 0, src_offset = 0; i < num_hashes;
-	   i++, dst += MD5_OUTPUT_SIZE_IN_BYTES, src_offset += chunk_size)
-	{
-	  size_t size = std::min(chunk_size, filesize - src_offset);
-	  workqueue->queue(new Hash_task(src + src_offset,
-					 size,
-					 dst,
-					 build_id_blocker,
-					 post_hash_tasks_blocker));
-	}
-      return post_hash_tasks_blocker;
+      hash = build_id_md5_chunk;
+      hash_size = 128 / 8;
+    }
+  else if (strcmp(style, "fast") == 0 && filesize > 0)
+    {
+      if (chunk_size == 0)
+	chunk_size = filesize;
+      hash = build_id_fast_chunk;
+      hash_size = 64 / 8;
     }
-  return build_id_blocker;
+  else
+    return build_id_blocker;
+
+  const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
+  Task_token* post_hash_tasks_blocker = new Task_token(true);
+  post_hash_tasks_blocker->add_blockers(num_hashes);
+  this->size_of_array_of_hashes_ = num_hashes * hash_size;
+  unsigned char *dst = new unsigned char[this->size_of_array_of_hashes_];
+  this->array_of_hashes_ = dst;
+  for (size_t i = 0, src_offset = 0; i < num_hashes;
+       i++, dst += hash_size, src_offset += chunk_size)
+    {
+      size_t size = std::min(chunk_size, filesize - src_offset);
+      workqueue->queue(new Hash_task(hash,
+				     of,
+				     src_offset,
+				     size,
+				     dst,
+				     build_id_blocker,
+				     post_hash_tasks_blocker));
+    }
+  return post_hash_tasks_blocker;
 }
 
-// If a tree-style build ID was requested, the parallel part of that computation
-// is already done, and the final hash-of-hashes is computed here.  For other
-// types of build IDs, all the work is done here.
+// If a tree-style or fast build ID was requested, the parallel part
+// of that computation is already done, and the final hash-of-hashes
+// is computed here.  For other types of build IDs, all the work is
+// done here.
 
 void
 Layout::write_build_id(Output_file* of) const
@@ -5404,22 +5697,54 @@ Layout::write_build_id(Output_file* of) const
   unsigned char* ov = of->get_output_view(this->build_id_note_->offset(),
 					  this->build_id_note_->data_size());
 
-  if (this->array_of_hashes_ == NULL)
+  const char* style = parameters->options().build_id();
+  if (this->array_of_hashes_ == NULL && strcmp(style, "fast") == 0)
+    {
+      // queue_build_id_tasks only skips the chunks for an empty file.
+      // Hash it as a single empty chunk, so that the result matches
+      // the tree of chunk hashes used for larger files.
+      unsigned char chunk_hash[64 / 8];
+      build_id_fast_chunk(NULL, 0, chunk_hash);
+      sha1_buffer(reinterpret_cast<const char*>(chunk_hash),
+		  sizeof chunk_hash, ov);
+    }
+  else if (this->array_of_hashes_ == NULL)
     {
       const size_t output_file_size = this->output_file_size();
-      const unsigned char* iv = of->get_input_view(0, output_file_size);
-      const char* style = parameters->options().build_id();
 
       // If we get here with style == "tree" then the output must be
       // too small for chunking, and we use SHA-1 in that case.
+      bool is_sha1;
       if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
-	sha1_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+	is_sha1 = true;
       else if (strcmp(style, "md5") == 0)
-	md5_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+	is_sha1 = false;
       else
 	gold_unreachable();
 
-      of->free_input_view(0, output_file_size, iv);
+      // Read the file a piece at a time, so that we never need a
+      // view of the whole file if the output is being streamed.
+      const size_t piece_size = 1 << 20;
+      struct sha1_ctx sha1_ctx;
+      struct md5_ctx md5_ctx;
+      if (is_sha1)
+	sha1_init_ctx(&sha1_ctx);
+      else
+	md5_init_ctx(&md5_ctx);
+      for (size_t off = 0; off < output_file_size; off += piece_size)
+	{
+	  size_t len = std::min(piece_size, output_file_size - off);
+	  const unsigned char* iv = of->get_input_view(off, len);
+	  if (is_sha1)
+	    sha1_process_bytes(iv, len, &sha1_ctx);
+	  else
+	    md5_process_bytes(iv, len, &md5_ctx);
+	  of->free_input_view(off, len, iv);
+	}
+      if (is_sha1)
+	sha1_finish_ctx(&sha1_ctx, ov);
+      else
+	md5_finish_ctx(&md5_ctx, ov);
     }
   else
     {
@@ -5428,7 +5753,6 @@ Layout::write_build_id(Output_file* of) const
       sha1_buffer(reinterpret_cast<const char*>(this->array_of_hashes_),
 		  this->size_of_array_of_hashes_, ov);
       delete[] this->array_of_hashes_;
-      of->free_input_view(0, this->output_file_size(), this->input_view_);
     }
 
   of->write_output_view(this->build_id_note_->offset(),
@@ -5509,6 +5833,23 @@ Layout::print_stats() const
   this->sympool_.print_stats("output symbol name pool");
   this->dynpool_.print_stats("dynamic name pool");
 
+  if (!this->relaxation_pass_stats_.empty())
+    {
+      fprintf(stderr, _("%s: relaxation passes: %zu\n"),
+	      program_name, this->relaxation_pass_stats_.size());
+      for (size_t i = 0; i < this->relaxation_pass_stats_.size(); ++i)
+	{
+	  const Relaxation_pass_stats& stats(this->relaxation_pass_stats_[i]);
+	  fprintf(stderr,
+		  _("%s: relaxation pass %zu: layout time: %lld.%06lld; "
+		    "relax time: %lld.%06lld; output sections changed: %u\n"),
+		  program_name, i + 1,
+		  stats.layout_time / 1000000, stats.layout_time % 1000000,
+		  stats.relax_time / 1000000, stats.relax_time % 1000000,
+		  stats.sections_changed);
+	}
+    }
+
   for (Section_list::const_iterator p = this->section_list_.begin();
        p != this->section_list_.end();
        ++p)
@@ -57,6 +57,7 @@ class Output_data_dynamic;
 class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
+class Output_compressed_section;
 class Eh_frame;
 class Gdb_index;
 class Target;
@@ -643,8 +644,8 @@ class Layout
 		       size_t cie_length, const unsigned char* fde_data,
 		       size_t fde_length);
 
-  // Scan a .debug_info or .debug_types section, and add summary
-  // information to the .gdb_index section.
+  // Record a .debug_info or .debug_types section to be scanned for
+  // summary information for the .gdb_index section.
   template<int size, bool big_endian>
   void
   add_to_gdb_index(bool is_type_unit,
@@ -655,6 +656,19 @@ class Layout
 		   unsigned int reloc_shndx,
 		   unsigned int reloc_type);
 
+  // If we are building a .gdb_index section, queue the tasks which
+  // scan the sections recorded by add_to_gdb_index, and return a
+  // blocker that will unblock when they and BLOCKER finish.
+  // Otherwise return BLOCKER.
+  Task_token*
+  queue_gdb_index_tasks(Workqueue* workqueue, Task_token* blocker);
+
+  // Queue the tasks which find the distinct strings in SHF_MERGE
+  // string sections, and return a blocker that will unblock when they
+  // and BLOCKER finish.  If there are no such tasks, return BLOCKER.
+  Task_token*
+  queue_merge_tasks(Workqueue* workqueue, Task_token* blocker);
+
   // Handle a GNU stack note.  This is called once per input object
   // file.  SEEN_GNU_STACK is true if the object file has a
   // .note.GNU-stack section.  GNU_STACK_FLAGS is the section flags
@@ -891,6 +905,12 @@ class Layout
 			  const Output_data_reloc_generic* dyn_rel,
 			  bool add_debug, bool dynrel_includes_plt);
 
+  // If any debug sections are being compressed, queue the tasks which
+  // compress them once BLOCKER is unblocked, and return a blocker
+  // that will unblock when they finish.  Otherwise return BLOCKER.
+  Task_token*
+  queue_compression_tasks(Workqueue* workqueue, Task_token* blocker);
+
   // If a treehash is necessary to compute the build ID, then queue
   // the necessary tasks and return a blocker that will unblock when
   // they finish.  Otherwise return BUILD_ID_BLOCKER.
@@ -1210,6 +1230,19 @@ class Layout
   typedef Unordered_map<const Output_segment*, const Output_segment*>
     Segment_states;
 
+  // Statistics about one pass of the relaxation loop, for --stats.
+  // Times are wall clock microseconds.
+  struct Relaxation_pass_stats
+  {
+    // Time spent laying out the sections.
+    long long layout_time;
+    // Time spent in the target relaxation hook.
+    long long relax_time;
+    // Number of output sections whose input section offsets the
+    // target changed, and which must be adjusted before the next pass.
+    unsigned int sections_changed;
+  };
+
   // Save states of current output segments.
   void
   save_segments(Segment_states*);
@@ -1378,12 +1411,12 @@ class Layout
   unsigned char* array_of_hashes_;
   // Size of array_of_hashes_ (in bytes).
   size_t size_of_array_of_hashes_;
-  // Input view for computing tree hash of build ID.  Freed in write_build_id().
-  const unsigned char* input_view_;
   // The output section containing dwarf abbreviations
   Output_reduced_debug_abbrev_section* debug_abbrev_;
   // The output section containing the dwarf debug info tree
   Output_reduced_debug_info_section* debug_info_;
+  // The output sections whose contents are being compressed.
+  std::vector<Output_compressed_section*> compressed_sections_;
   // A list of group sections and their signatures.
   Group_signatures group_signatures_;
   // The size of the output file.
@@ -1426,6 +1459,8 @@ class Layout
   Segment_states* segment_states_;
   // A relaxation debug checker.  We only create one when in debugging mode.
   Relaxation_debug_check* relaxation_debug_check_;
+  // Statistics for each relaxation pass, when using --stats.
+  std::vector<Relaxation_pass_stats> relaxation_pass_stats_;
   // Plugins specify section_ordering using this map.  This is set in
   // update_section_order in plugin.cc
   std::map<Section_id, unsigned int> section_order_map_;
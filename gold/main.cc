@@ -251,6 +251,9 @@ main(int argc, char** argv)
   // Run the main task processing loop.
   workqueue.process(0);
 
+  if (command_line.options().trace_file() != NULL)
+    workqueue.write_trace(command_line.options().trace_file());
+
   if (command_line.options().print_output_format())
     print_output_format();
 
@@ -295,6 +298,7 @@ main(int argc, char** argv)
       fprintf(stderr, _("%s: total space allocated by malloc: %d bytes\n"),
 	      program_name, m.arena);
 #endif
+      workqueue.print_stats();
       File_read::print_stats();
       Archive::print_stats();
       Lib_group::print_stats();
@@ -303,6 +307,8 @@ main(int argc, char** argv)
       symtab.print_stats();
       layout.print_stats();
       Gdb_index::print_stats();
+      if (parameters->incremental_update())
+	Incremental_binary::print_stats();
       Free_list::print_stats();
     }
 
@@ -27,6 +27,7 @@
 
 #include "merge.h"
 #include "compressed_output.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -40,7 +41,7 @@ Object_merge_map::~Object_merge_map()
   for (Section_merge_maps::iterator p = this->section_merge_maps_.begin();
        p != this->section_merge_maps_.end();
        ++p)
-    delete p->second;
+    delete *p;
 }
 
 // Get the Input_merge_map to use for an input section, or NULL.
@@ -49,13 +50,12 @@ Object_merge_map::Input_merge_map*
 Object_merge_map::get_input_merge_map(unsigned int shndx)
 {
   gold_assert(shndx != -1U);
-  if (shndx == this->first_shnum_)
-    return &this->first_map_;
-  if (shndx == this->second_shnum_)
-    return &this->second_map_;
-  Section_merge_maps::const_iterator p = this->section_merge_maps_.find(shndx);
-  if (p != this->section_merge_maps_.end())
-    return p->second;
+  Section_merge_maps::const_iterator p =
+    std::lower_bound(this->section_merge_maps_.begin(),
+		     this->section_merge_maps_.end(),
+		     shndx, Input_merge_map_compare());
+  if (p != this->section_merge_maps_.end() && (*p)->shndx == shndx)
+    return *p;
   return NULL;
 }
 
@@ -65,32 +65,27 @@ Object_merge_map::Input_merge_map*
 Object_merge_map::get_or_make_input_merge_map(const Merge_map* merge_map,
 					      unsigned int shndx)
 {
-  Input_merge_map* map = this->get_input_merge_map(shndx);
-  if (map != NULL)
+  gold_assert(shndx != -1U);
+
+  // Sections are normally added in order, so check the last one
+  // first.
+  Section_merge_maps::iterator p = this->section_merge_maps_.end();
+  if (!this->section_merge_maps_.empty()
+      && this->section_merge_maps_.back()->shndx >= shndx)
+    p = std::lower_bound(this->section_merge_maps_.begin(),
+			 this->section_merge_maps_.end(),
+			 shndx, Input_merge_map_compare());
+  if (p != this->section_merge_maps_.end() && (*p)->shndx == shndx)
     {
       // For a given input section in a given object, every mapping
       // must be done with the same Merge_map.
-      gold_assert(map->merge_map == merge_map);
-      return map;
+      gold_assert((*p)->merge_map == merge_map);
+      return *p;
     }
 
   // We need to create a new entry.
-  if (this->first_shnum_ == -1U)
-    {
-      this->first_shnum_ = shndx;
-      this->first_map_.merge_map = merge_map;
-      return &this->first_map_;
-    }
-  if (this->second_shnum_ == -1U)
-    {
-      this->second_shnum_ = shndx;
-      this->second_map_.merge_map = merge_map;
-      return &this->second_map_;
-    }
-
-  Input_merge_map* new_map = new Input_merge_map;
-  new_map->merge_map = merge_map;
-  this->section_merge_maps_[shndx] = new_map;
+  Input_merge_map* new_map = new Input_merge_map(merge_map, shndx);
+  this->section_merge_maps_.insert(p, new_map);
   return new_map;
 }
 
@@ -152,12 +147,7 @@ Object_merge_map::get_output_offset(const Merge_map* merge_map,
       || (merge_map != NULL && map->merge_map != merge_map))
     return false;
 
-  if (!map->sorted)
-    {
-      std::sort(map->entries.begin(), map->entries.end(),
-		Input_merge_compare());
-      map->sorted = true;
-    }
+  gold_assert(map->sorted);
 
   Input_merge_entry entry;
   entry.input_offset = input_offset;
@@ -192,6 +182,25 @@ Object_merge_map::is_merge_section_for(const Merge_map* merge_map,
   return map != NULL && map->merge_map == merge_map;
 }
 
+// Sort the mappings for each input section.
+
+void
+Object_merge_map::sort_input_merge_maps()
+{
+  for (Section_merge_maps::iterator p = this->section_merge_maps_.begin();
+       p != this->section_merge_maps_.end();
+       ++p)
+    {
+      Input_merge_map* map = *p;
+      if (!map->sorted)
+	{
+	  std::sort(map->entries.begin(), map->entries.end(),
+		    Input_merge_compare());
+	  map->sorted = true;
+	}
+    }
+}
+
 // Initialize a mapping from input offsets to output addresses.
 
 template<int size>
@@ -498,6 +507,83 @@ Output_merge_data::do_print_merge_stats(const char* section_name)
 
 // Class Output_merge_string.
 
+// A task which finds and hashes the strings in some of the input
+// sections of a merged string section.
+
+template<typename Char_type>
+class Merge_string_scan_task : public Task
+{
+ public:
+  Merge_string_scan_task(Output_merge_string<Char_type>* pomb, size_t begin,
+			 size_t end, Task_token* blocker)
+    : pomb_(pomb), begin_(begin), end_(end), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->pomb_->scan_input_sections(this->begin_, this->end_); }
+
+  std::string
+  get_name() const
+  { return "Merge_string_scan_task"; }
+
+ private:
+  Output_merge_string<Char_type>* pomb_;
+  size_t begin_;
+  size_t end_;
+  Task_token* blocker_;
+};
+
+// A task which finds the distinct strings in one shard of a merged
+// string section, once all the strings have been hashed.
+
+template<typename Char_type>
+class Merge_string_dedup_task : public Task
+{
+ public:
+  Merge_string_dedup_task(Output_merge_string<Char_type>* pomb,
+			  unsigned int shard, unsigned int shard_count,
+			  Task_token* scan_blocker, Task_token* blocker)
+    : pomb_(pomb), shard_(shard), shard_count_(shard_count),
+      scan_blocker_(scan_blocker), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->scan_blocker_->is_blocked())
+      return this->scan_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->pomb_->dedup_shard(this->shard_, this->shard_count_); }
+
+  std::string
+  get_name() const
+  { return "Merge_string_dedup_task"; }
+
+ private:
+  Output_merge_string<Char_type>* pomb_;
+  unsigned int shard_;
+  unsigned int shard_count_;
+  Task_token* scan_blocker_;
+  Task_token* blocker_;
+};
+
 // Add an input section to a merged string section.
 
 template<typename Char_type>
@@ -511,10 +597,6 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 								     &sec_len,
 								     &is_new);
 
-  const Char_type* p = reinterpret_cast<const Char_type*>(pdata);
-  const Char_type* pend = p + sec_len / sizeof(Char_type);
-  const Char_type* pend0 = pend;
-
   if (sec_len % sizeof(Char_type) != 0)
     {
       object->error(_("mergeable string section length not multiple of "
@@ -524,21 +606,95 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
       return false;
     }
 
+  const Char_type* pend = reinterpret_cast<const Char_type*>(pdata + sec_len);
+  if (pend[-1] != 0)
+    gold_warning(_("%s: last entry in mergeable string section '%s' "
+		   "not null terminated"),
+		 object->name().c_str(),
+		 object->section_name(shndx).c_str());
+
+  Merged_strings_list* merged_strings_list =
+      new Merged_strings_list(object, shndx);
+  this->merged_strings_lists_.push_back(merged_strings_list);
+
+  if (this->uses_merge_tasks_)
+    {
+      // Keep the contents, so that the strings can be found after
+      // layout, while the input object is unlocked.  Use a lasting
+      // view of the input file if there is one; the object releases it
+      // when it is relocated.  Otherwise save a copy.
+      const unsigned char* contents = NULL;
+      if (is_new)
+	{
+	  merged_strings_list->buffer = const_cast<unsigned char*>(pdata);
+	  contents = pdata;
+	  is_new = false;
+	}
+      else
+	{
+	  section_size_type view_len;
+	  contents = object->lasting_section_contents(shndx, &view_len);
+	  if (contents == NULL)
+	    {
+	      unsigned char* buffer = new unsigned char[sec_len];
+	      memcpy(buffer, pdata, sec_len);
+	      merged_strings_list->buffer = buffer;
+	      contents = buffer;
+	    }
+	  else
+	    gold_assert(view_len == sec_len);
+	}
+      merged_strings_list->contents = contents;
+      merged_strings_list->contents_size = sec_len;
+      this->deferred_size_ += sec_len;
+    }
+  else
+    {
+      bool has_misaligned_strings = this->find_strings(merged_strings_list,
+						       pdata, sec_len, true);
+      this->input_count_ += merged_strings_list->count;
+      this->input_size_ += merged_strings_list->merged_strings.back().offset;
+
+      if (has_misaligned_strings)
+	gold_warning(_("%s: section %s contains incorrectly aligned strings;"
+		       " the alignment of those strings won't be preserved"),
+		     object->name().c_str(),
+		     object->section_name(shndx).c_str());
+    }
+
+  // For script processing, we keep the input sections.
+  if (this->keeps_input_sections())
+    record_input_section(object, shndx);
+
+  if (is_new)
+    delete[] pdata;
+
+  return true;
+}
+
+// Find the strings in an input section.
+
+template<typename Char_type>
+bool
+Output_merge_string<Char_type>::find_strings(
+    Merged_strings_list* merged_strings_list,
+    const unsigned char* pdata,
+    section_size_type sec_len,
+    bool add)
+{
+  const Char_type* p = reinterpret_cast<const Char_type*>(pdata);
+  const Char_type* pend = p + sec_len / sizeof(Char_type);
+  const Char_type* pend0 = pend;
+
   if (pend[-1] != 0)
     {
-      gold_warning(_("%s: last entry in mergeable string section '%s' "
-		     "not null terminated"),
-		   object->name().c_str(),
-		   object->section_name(shndx).c_str());
       // Find the end of the last NULL-terminated string in the buffer.
       while (pend0 > p && pend0[-1] != 0)
 	--pend0;
     }
 
-  Merged_strings_list* merged_strings_list =
-      new Merged_strings_list(object, shndx);
-  this->merged_strings_lists_.push_back(merged_strings_list);
   Merged_strings& merged_strings = merged_strings_list->merged_strings;
+  std::vector<size_t>& hash_codes = merged_strings_list->hash_codes;
 
   // Count the number of non-null strings in the section and size the list.
   size_t count = 0;
@@ -553,6 +709,8 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   if (pend0 < pend)
     ++count;
   merged_strings.reserve(count + 1);
+  if (!add)
+    hash_codes.reserve(count + 1);
 
   // The index I is in bytes, not characters.
   section_size_type i = 0;
@@ -574,8 +732,12 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	      != init_align_modulo))
 	  has_misaligned_strings = true;
 
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
+      Stringpool::Key key = 0;
+      if (add)
+	this->stringpool_.add_with_length(p, len, true, &key);
+      else
+	hash_codes.push_back(Stringpool_template<Char_type>::hash_string(p,
+									len));
 
       merged_strings.push_back(Merged_string(i, key));
       p += len + 1;
@@ -585,8 +747,12 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
     {
       size_t len = pend - p;
 
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
+      Stringpool::Key key = 0;
+      if (add)
+	this->stringpool_.add_with_length(p, len, true, &key);
+      else
+	hash_codes.push_back(Stringpool_template<Char_type>::hash_string(p,
+									len));
 
       merged_strings.push_back(Merged_string(i, key));
 
@@ -597,23 +763,189 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   // compute the length of the last string.
   merged_strings.push_back(Merged_string(i, 0));
 
-  this->input_count_ += count;
-  this->input_size_ += i;
+  merged_strings_list->count = count;
 
-  if (has_misaligned_strings)
-    gold_warning(_("%s: section %s contains incorrectly aligned strings;"
-		   " the alignment of those strings won't be preserved"),
-		 object->name().c_str(),
-		 object->section_name(shndx).c_str());
+  return has_misaligned_strings;
+}
 
-  // For script processing, we keep the input sections.
-  if (this->keeps_input_sections())
-    record_input_section(object, shndx);
+// Queue tasks to find the distinct strings in the saved input
+// sections.  Each scan task finds and hashes the strings in a range
+// of input sections.  When they are all done, each dedup task walks
+// all the strings in input order, and looks up the ones whose hash
+// code selects its shard in a private Stringpool.  Each distinct
+// string thus gets a number within its shard, which depends only on
+// the input order, and add_saved_strings adds the strings to the
+// real Stringpool in input order.  So the output does not depend on
+// the number of threads.
 
-  if (is_new)
-    delete[] pdata;
+template<typename Char_type>
+Task_token*
+Output_merge_string<Char_type>::do_queue_merge_tasks(Workqueue* workqueue)
+{
+  if (!this->uses_merge_tasks_)
+    return NULL;
+
+  // Don't bother with tasks for a small amount of data;
+  // finalize_merged_data will handle it.  Every dedup task looks at
+  // every string, so don't use too many of them.
+  const section_size_type min_task_size = 256 * 1024;
+  const unsigned int max_task_count = 32;
+  unsigned int task_count = parameters->options().thread_count_middle();
+  if (task_count == 0 || task_count > max_task_count)
+    task_count = max_task_count;
+  if (task_count > this->deferred_size_ / min_task_size)
+    task_count = this->deferred_size_ / min_task_size;
+  if (task_count < 2)
+    return NULL;
+
+  const size_t list_count = this->merged_strings_lists_.size();
+  this->merged_lists_count_ = list_count;
+  this->shard_sizes_.resize(task_count);
+
+  Task_token* scan_blocker = new Task_token(true);
+  scan_blocker->add_blockers(task_count);
+  this->scan_blocker_ = scan_blocker;
+  Task_token* dedup_blocker = new Task_token(true);
+  dedup_blocker->add_blockers(task_count);
+
+  // Give each scan task about the same amount of data.
+  size_t begin = 0;
+  uint64_t size = 0;
+  for (unsigned int i = 0; i < task_count; ++i)
+    {
+      uint64_t limit = (static_cast<uint64_t>(this->deferred_size_) * (i + 1)
+			/ task_count);
+      size_t end = begin;
+      while (end < list_count && size < limit)
+	{
+	  size += this->merged_strings_lists_[end]->contents_size;
+	  ++end;
+	}
+      workqueue->queue(new Merge_string_scan_task<Char_type>(this, begin, end,
+							     scan_blocker));
+      begin = end;
+    }
+  gold_assert(begin == list_count);
 
-  return true;
+  for (unsigned int i = 0; i < task_count; ++i)
+    workqueue->queue(new Merge_string_dedup_task<Char_type>(this, i,
+							    task_count,
+							    scan_blocker,
+							    dedup_blocker));
+
+  return dedup_blocker;
+}
+
+// Find and hash the strings in the saved input sections from BEGIN up
+// to END.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::scan_input_sections(size_t begin, size_t end)
+{
+  for (size_t i = begin; i < end; ++i)
+    {
+      Merged_strings_list* l = this->merged_strings_lists_[i];
+      this->find_strings(l, l->contents, l->contents_size, false);
+    }
+}
+
+// Give each distinct string whose hash code selects shard SHARD a
+// number in order of first appearance, and record it as a shard code
+// in the stringpool_key field.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::dedup_shard(unsigned int shard,
+					    unsigned int shard_count)
+{
+  Stringpool_template<Char_type> pool;
+  Stringpool::Key shard_size = 0;
+  for (size_t i = 0; i < this->merged_lists_count_; ++i)
+    {
+      Merged_strings_list* l = this->merged_strings_lists_[i];
+      const Char_type* contents =
+	reinterpret_cast<const Char_type*>(l->contents);
+      Merged_strings& merged_strings(l->merged_strings);
+      for (size_t j = 0; j + 1 < merged_strings.size(); ++j)
+	{
+	  size_t hash_code = l->hash_codes[j];
+	  if (hash_code % shard_count != shard)
+	    continue;
+	  section_offset_type offset = merged_strings[j].offset;
+	  size_t len = ((merged_strings[j + 1].offset - offset)
+			/ sizeof(Char_type) - 1);
+	  Stringpool::Key key;
+	  pool.add_prehashed(contents + offset / sizeof(Char_type), len,
+			     hash_code, false, &key);
+	  if (key > shard_size)
+	    shard_size = key;
+	  merged_strings[j].stringpool_key = ((key - 1) * shard_count
+					      + shard + 1);
+	}
+    }
+  this->shard_sizes_[shard] = shard_size;
+}
+
+// Add the strings of the saved input sections to the Stringpool, in
+// input order.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::add_saved_strings()
+{
+  const unsigned int shard_count = this->shard_sizes_.size();
+  std::vector<std::vector<Stringpool::Key> > shard_keys(shard_count);
+  for (unsigned int i = 0; i < shard_count; ++i)
+    shard_keys[i].resize(this->shard_sizes_[i]);
+
+  for (size_t i = 0; i < this->merged_strings_lists_.size(); ++i)
+    {
+      Merged_strings_list* l = this->merged_strings_lists_[i];
+      if (l->contents == NULL)
+	continue;
+
+      if (i >= this->merged_lists_count_)
+	this->find_strings(l, l->contents, l->contents_size, true);
+      else
+	{
+	  // The strings have been deduplicated by the tasks, so we
+	  // only need to add the first appearance of each one.
+	  const Char_type* contents =
+	    reinterpret_cast<const Char_type*>(l->contents);
+	  Merged_strings& merged_strings(l->merged_strings);
+	  for (size_t j = 0; j + 1 < merged_strings.size(); ++j)
+	    {
+	      Stringpool::Key code = merged_strings[j].stringpool_key - 1;
+	      Stringpool::Key& key(shard_keys[code % shard_count]
+				   [code / shard_count]);
+	      if (key == 0)
+		{
+		  section_offset_type offset = merged_strings[j].offset;
+		  size_t len = ((merged_strings[j + 1].offset - offset)
+				/ sizeof(Char_type) - 1);
+		  this->stringpool_.add_prehashed(contents
+						  + offset / sizeof(Char_type),
+						  len, l->hash_codes[j], true,
+						  &key);
+		}
+	      merged_strings[j].stringpool_key = key;
+	    }
+	  std::vector<size_t>().swap(l->hash_codes);
+	}
+
+      this->input_count_ += l->count;
+      this->input_size_ += l->merged_strings.back().offset;
+
+      delete[] l->buffer;
+      l->buffer = NULL;
+      l->contents = NULL;
+    }
+
+  this->merged_lists_count_ = 0;
+  this->shard_sizes_.clear();
+  delete this->scan_blocker_;
+  this->scan_blocker_ = NULL;
 }
 
 // Finalize the mappings from the input sections to the output
@@ -623,6 +955,7 @@ template<typename Char_type>
 section_size_type
 Output_merge_string<Char_type>::finalize_merged_data()
 {
+  this->add_saved_strings();
   this->stringpool_.set_string_offsets();
 
   for (typename Merged_strings_lists::const_iterator l =
@@ -24,7 +24,6 @@
 #define GOLD_MERGE_H
 
 #include <climits>
-#include <map>
 #include <vector>
 
 #include "stringpool.h"
@@ -34,6 +33,8 @@ namespace gold
 {
 
 class Merge_map;
+class Task_token;
+class Workqueue;
 
 // For each object with merge sections, we store an Object_merge_map.
 // This is used to map locations in input sections to a merged output
@@ -44,9 +45,7 @@ class Object_merge_map
 {
  public:
   Object_merge_map()
-    : first_shnum_(-1U), first_map_(),
-      second_shnum_(-1U), second_map_(),
-      section_merge_maps_()
+    : section_merge_maps_()
   { }
 
   ~Object_merge_map();
@@ -76,6 +75,13 @@ class Object_merge_map
   bool
   is_merge_section_for(const Merge_map*, unsigned int shndx);
 
+  // Sort the mappings for each input section by input offset.  This
+  // must be called once all the mappings have been added and before
+  // get_output_offset is used, since that may then be called by
+  // several threads at once.
+  void
+  sort_input_merge_maps();
+
   // Initialize an mapping from input offsets to output addresses for
   // section SHNDX.  STARTING_ADDRESS is the output address of the
   // merged section.
@@ -134,18 +140,29 @@ class Object_merge_map
     // we don't have it, rather than trying a lookup and returning an
     // answer which will receive the wrong offset.
     const Merge_map* merge_map;
+    // The input section index.
+    unsigned int shndx;
     // The list of mappings.
     Entries entries;
     // Whether the ENTRIES field is sorted by input_offset.
     bool sorted;
 
-    Input_merge_map()
-      : merge_map(NULL), entries(), sorted(true)
+    Input_merge_map(const Merge_map* merge_mapa, unsigned int shndxa)
+      : merge_map(merge_mapa), shndx(shndxa), entries(), sorted(true)
     { }
   };
 
-  // Map input section indices to merge maps.
-  typedef std::map<unsigned int, Input_merge_map*> Section_merge_maps;
+  // A less-than comparison routine for finding an Input_merge_map by
+  // input section index.
+  struct Input_merge_map_compare
+  {
+    bool
+    operator()(const Input_merge_map* map, unsigned int shndx) const
+    { return map->shndx < shndx; }
+  };
+
+  // The merge maps of an object, sorted by input section index.
+  typedef std::vector<Input_merge_map*> Section_merge_maps;
 
   // Return a pointer to the Input_merge_map to use for the input
   // section SHNDX, or NULL.
@@ -157,15 +174,10 @@ class Object_merge_map
   Input_merge_map*
   get_or_make_input_merge_map(const Merge_map* merge_map, unsigned int shndx);
 
-  // Any given object file will normally only have a couple of input
-  // sections with mergeable contents.  So we keep the first two input
-  // section numbers inline, and push any further ones into a map.  A
-  // value of -1U in first_shnum_ or second_shnum_ means that we don't
-  // have a corresponding entry.
-  unsigned int first_shnum_;
-  Input_merge_map first_map_;
-  unsigned int second_shnum_;
-  Input_merge_map second_map_;
+  // Any given object file will normally only have a few input
+  // sections with mergeable contents, and they are normally added in
+  // order of section index.  So we keep them in a sorted array, which
+  // is cheap both to add to and to search while relocating.
   Section_merge_maps section_merge_maps_;
 };
 
@@ -277,6 +289,14 @@ class Output_merge_base : public Output_section_data
     gold_assert(this->keeps_input_sections_);
     return this->input_sections_.end();
   }
+
+  // Queue tasks to process the input sections in parallel.  This is
+  // called after all the input sections have been added.  Return a
+  // blocker which is unblocked when the tasks are done, or NULL if
+  // there are no tasks.
+  Task_token*
+  queue_merge_tasks(Workqueue* workqueue)
+  { return this->do_queue_merge_tasks(workqueue); }
  
  protected:
   // Return the output offset for an input offset.
@@ -305,6 +325,11 @@ class Output_merge_base : public Output_section_data
   do_is_string()
   { return false; }
 
+  // This may be overridden by the child class.
+  virtual Task_token*
+  do_queue_merge_tasks(Workqueue*)
+  { return NULL; }
+
   // This may be overridden by the child class.
   virtual void
   do_set_keeps_input_sections()
@@ -462,11 +487,35 @@ class Output_merge_string : public Output_merge_base
  public:
   Output_merge_string(uint64_t addralign)
     : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
-      merged_strings_lists_(), input_count_(0), input_size_(0)
+      merged_strings_lists_(), input_count_(0), input_size_(0),
+      uses_merge_tasks_(false), deferred_size_(0), merged_lists_count_(0),
+      shard_sizes_(), scan_blocker_(NULL)
   {
     this->stringpool_.set_no_zero_null();
+    // A string which is a suffix of another is only correctly aligned
+    // if the alignment is no more than the character size.
+    if (addralign <= sizeof(Char_type) && !parameters->incremental())
+      this->stringpool_.set_optimize();
+    // With that alignment there is also no need to check for
+    // misaligned strings, which would require the input object.  So
+    // the strings can be hashed and deduplicated after layout, by
+    // tasks running in parallel.
+    if (addralign <= sizeof(Char_type) && parameters->options().threads())
+      this->uses_merge_tasks_ = true;
   }
 
+  // Find and hash the strings in the input sections from BEGIN up to
+  // END.  This is called by a task, in parallel with other calls.
+  void
+  scan_input_sections(size_t begin, size_t end);
+
+  // Find the distinct strings in the input sections whose hash codes
+  // select shard SHARD of SHARD_COUNT.  This is called by a task,
+  // after all the input sections have been scanned, in parallel with
+  // the other shards.
+  void
+  dedup_shard(unsigned int shard, unsigned int shard_count);
+
  protected:
   // Add an input section.
   bool
@@ -513,6 +562,10 @@ class Output_merge_string : public Output_merge_base
   do_is_string()
   { return true; }
 
+  // Queue tasks to hash and deduplicate the strings.
+  Task_token*
+  do_queue_merge_tasks(Workqueue*);
+
   // Set keeps-input-sections flag.
   void
   do_set_keeps_input_sections()
@@ -550,14 +603,45 @@ class Output_merge_string : public Output_merge_base
     unsigned int shndx;
     // The list of merged strings.
     Merged_strings merged_strings;
+    // When the strings are added after layout, the section contents,
+    // and the hash codes of the strings.  Until the strings are added
+    // to the Stringpool, the stringpool_key fields of MERGED_STRINGS
+    // hold shard codes rather than keys.  The contents are normally a
+    // lasting view held by OBJECT; BUFFER is the copy, if we had to
+    // make one.
+    const unsigned char* contents;
+    section_size_type contents_size;
+    unsigned char* buffer;
+    std::vector<size_t> hash_codes;
+    // The number of non-null strings.
+    size_t count;
 
     Merged_strings_list(Relobj* objecta, unsigned int shndxa)
-      : object(objecta), shndx(shndxa), merged_strings()
+      : object(objecta), shndx(shndxa), merged_strings(), contents(NULL),
+	contents_size(0), buffer(NULL), hash_codes(), count(0)
     { }
+
+    ~Merged_strings_list()
+    { delete[] this->buffer; }
   };
 
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
 
+  // Find the strings in the section contents PDATA of length SEC_LEN,
+  // and record them in MERGED_STRINGS_LIST.  If ADD is true, add them
+  // to the Stringpool; otherwise just compute their hash codes.
+  // Return whether any string is misaligned.
+  bool
+  find_strings(Merged_strings_list* merged_strings_list,
+	       const unsigned char* pdata, section_size_type sec_len,
+	       bool add);
+
+  // Add the strings of the input sections which were saved by
+  // do_add_input_section to the Stringpool, in input order.  This
+  // uses the results of the dedup tasks, if there were any.
+  void
+  add_saved_strings();
+
   // As we see the strings, we add them to a Stringpool.
   Stringpool_template<Char_type> stringpool_;
   // Map from a location in an input object to an entry in the
@@ -567,6 +651,17 @@ class Output_merge_string : public Output_merge_base
   size_t input_count_;
   // The total size of input sections.
   size_t input_size_;
+  // Whether input sections are saved to be processed by tasks.
+  bool uses_merge_tasks_;
+  // The total size of the saved input sections.
+  section_size_type deferred_size_;
+  // The number of lists, from the start of merged_strings_lists_,
+  // which are being deduplicated by tasks.
+  size_t merged_lists_count_;
+  // The number of distinct strings found by each shard.
+  std::vector<size_t> shard_sizes_;
+  // The blocker used by the dedup tasks to wait for the scan tasks.
+  Task_token* scan_blocker_;
 };
 
 } // End namespace gold.
@@ -3093,6 +3093,11 @@ class Target_mips : public Sized_target<size, big_endian>
   do_has_custom_set_dynsym_indexes() const
   { return true; }
 
+  // The GOT view is kept and updated while relocating.
+  bool
+  do_retains_output_views() const
+  { return true; }
+
   // Don't emit input .reginfo sections to output .reginfo.
   bool
   do_should_include_section(elfcpp::Elf_Word sh_type) const
@@ -368,6 +368,31 @@ Relobj::finalize_incremental_relocs(Layout* layout, bool clear_counts)
   layout->incremental_inputs()->set_reloc_count(rindex);
 }
 
+// Return the contents of section SHNDX in a lasting view, and keep
+// the view until release_lasting_views is called.
+
+const unsigned char*
+Relobj::lasting_section_contents(unsigned int shndx, section_size_type* plen)
+{
+  File_view* fv = this->do_lasting_section_view(shndx, plen);
+  if (fv == NULL)
+    return NULL;
+  this->lasting_views_.push_back(fv);
+  return fv->data();
+}
+
+// Release the views returned by lasting_section_contents.
+
+void
+Relobj::release_lasting_views()
+{
+  for (std::vector<File_view*>::iterator p = this->lasting_views_.begin();
+       p != this->lasting_views_.end();
+       ++p)
+    delete *p;
+  std::vector<File_view*>().swap(this->lasting_views_);
+}
+
 // Class Sized_relobj.
 
 // Iterate over local symbols, calling a visitor class V for each GOT offset
@@ -432,7 +457,9 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
     discarded_eh_frame_shndx_(-1U),
     deferred_layout_(),
     deferred_layout_relocs_(),
-    compressed_sections_()
+    compressed_sections_(),
+    relocate_ranges_(NULL),
+    relocate_views_()
 {
   this->e_type_ = ehdr.get_e_type();
 }
@@ -848,6 +875,43 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+  // Hash the names of the external symbols now, while we are running
+  // in parallel with other Read_symbols tasks.  The symbol name used
+  // as the key in the symbol table stops at any '@' which introduces
+  // a version name.
+  const unsigned char* psyms = (fvsymtab->data()
+				+ sd->external_symbols_offset);
+  const size_t extcount = extsize / sym_size;
+  const char* names = reinterpret_cast<const char*>(fvstrtab->data());
+  sd->symbol_name_hashes.resize(extcount);
+
+  // If we are going to build a .gnu.hash section holding most of the
+  // defined symbols, compute those hash codes now as well.
+  bool gnu_hashes = ((parameters->options().shared()
+		      || parameters->options().export_dynamic())
+		     && (strcmp(parameters->options().hash_style(), "gnu") == 0
+			 || strcmp(parameters->options().hash_style(),
+				   "both") == 0));
+  if (gnu_hashes)
+    sd->symbol_gnu_hashes.resize(extcount);
+
+  for (size_t i = 0; i < extcount; ++i, psyms += sym_size)
+    {
+      elfcpp::Sym<size, big_endian> sym(psyms);
+      unsigned int st_name = sym.get_st_name();
+      if (st_name >= sd->symbol_names_size)
+	{
+	  // Reported as an error when the symbol is added.
+	  sd->symbol_name_hashes[i] = 0;
+	  continue;
+	}
+      const char* name = names + st_name;
+      size_t namelen = strcspn(name, "@");
+      sd->symbol_name_hashes[i] = Stringpool::hash_string(name, namelen);
+      if (gnu_hashes)
+	sd->symbol_gnu_hashes[i] = Dynobj::gnu_hash(name, namelen);
+    }
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -1943,10 +2007,17 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 
   const char* sym_names =
     reinterpret_cast<const char*>(sd->symbol_names->data());
+  const size_t* sym_name_hashes = NULL;
+  if (sd->symbol_name_hashes.size() == symcount)
+    sym_name_hashes = &sd->symbol_name_hashes[0];
+  const uint32_t* sym_gnu_hashes = NULL;
+  if (sd->symbol_gnu_hashes.size() == symcount)
+    sym_gnu_hashes = &sd->symbol_gnu_hashes[0];
   symtab->add_from_relobj(this,
 			  sd->symbols->data() + sd->external_symbols_offset,
 			  symcount, this->local_symbol_count_,
 			  sym_names, sd->symbol_names_size,
+			  sym_name_hashes, sym_gnu_hashes,
 			  &this->symbols_,
 			  &this->defined_count_);
 
@@ -1954,6 +2025,8 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
   sd->symbols = NULL;
   delete sd->symbol_names;
   sd->symbol_names = NULL;
+  std::vector<size_t>().swap(sd->symbol_name_hashes);
+  std::vector<uint32_t>().swap(sd->symbol_gnu_hashes);
 }
 
 // Find out if this object, that is a member of a lib group, should be included
@@ -2792,6 +2865,24 @@ Sized_relobj_file<size, big_endian>::do_get_global_symbol_counts(
   *used = count;
 }
 
+// Return a lasting view of the contents of section SHNDX.  A
+// compressed section has no such view; neither does an empty one.
+
+template<int size, bool big_endian>
+File_view*
+Sized_relobj_file<size, big_endian>::do_lasting_section_view(
+    unsigned int shndx,
+    section_size_type* plen)
+{
+  if (this->section_is_compressed(shndx, NULL))
+    return NULL;
+  Object::Location loc(this->elf_file_.section_contents(shndx));
+  *plen = convert_to_section_size_type(loc.data_size);
+  if (*plen == 0)
+    return NULL;
+  return this->get_lasting_view(loc.file_offset, *plen, true, false);
+}
+
 // Return a view of the decompressed contents of a section.  Set *PLEN
 // to the size.  Set *IS_NEW to true if the contents need to be freed
 // by the caller.
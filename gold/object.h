@@ -37,6 +37,7 @@ namespace gold
 
 class General_options;
 class Task;
+class Workqueue;
 class Cref;
 class Layout;
 class Output_data;
@@ -47,6 +48,7 @@ class Pluginobj;
 class Dynobj;
 class Object_merge_map;
 class Relocatable_relocs;
+class Relocate_ranges;
 struct Symbols_data;
 
 template<typename Stringpool_char>
@@ -58,7 +60,8 @@ struct Read_symbols_data
 {
   Read_symbols_data()
     : section_headers(NULL), section_names(NULL), symbols(NULL),
-      symbol_names(NULL), versym(NULL), verdef(NULL), verneed(NULL)
+      symbol_names(NULL), versym(NULL), verdef(NULL), verneed(NULL),
+      has_file_digest(false)
   { }
 
   ~Read_symbols_data();
@@ -81,6 +84,17 @@ struct Read_symbols_data
   File_view* symbol_names;
   // Size of symbol name data in bytes.
   section_size_type symbol_names_size;
+  // Hash codes of the names of the external symbols, without any
+  // version suffix, as computed by Stringpool::hash_string.  These
+  // are computed while reading the symbols, which is done in
+  // parallel, so that adding the symbols to the symbol table, which
+  // is serialized, does not have to do it.  This is empty if the
+  // hash codes were not computed.
+  std::vector<size_t> symbol_name_hashes;
+  // GNU hash codes of the same names, for the .gnu.hash section.
+  // This is empty unless we are building a .gnu.hash section which
+  // may contain symbols defined in this object.
+  std::vector<uint32_t> symbol_gnu_hashes;
 
   // Version information.  This is only used on dynamic objects.
   // Version symbol data (from SHT_GNU_versym section).
@@ -94,6 +108,11 @@ struct Read_symbols_data
   File_view* verneed;
   section_size_type verneed_size;
   unsigned int verneed_info;
+
+  // Whether file_digest holds the digest of the contents of the file,
+  // for an incremental link.
+  bool has_file_digest;
+  unsigned char file_digest[file_digest_size];
 };
 
 // Information used to print error messages.
@@ -467,6 +486,13 @@ class Object
   get_mtime()
   { return this->do_get_mtime(); }
 
+  // Compute the digest of the contents of the file into DIGEST, which
+  // must hold file_digest_size bytes.  This is not meaningful for an
+  // archive member.
+  void
+  get_file_digest(unsigned char* digest)
+  { this->do_get_file_digest(digest); }
+
   // Get the number of sections.
   unsigned int
   shnum() const
@@ -783,6 +809,12 @@ class Object
   do_get_mtime()
   { return this->input_file()->file().get_mtime(); }
 
+  // Compute the digest of the contents of the file.  This method may
+  // be overridden for subclasses that don't use an actual file.
+  virtual void
+  do_get_file_digest(unsigned char* digest)
+  { this->input_file()->file().get_digest(digest); }
+
   // Read the symbols--implemented by child class.
   virtual void
   do_read_symbols(Read_symbols_data*) = 0;
@@ -1014,7 +1046,8 @@ class Relobj : public Object
       reloc_counts_(NULL),
       reloc_bases_(NULL),
       first_dyn_reloc_(0),
-      dyn_reloc_count_(0)
+      dyn_reloc_count_(0),
+      lasting_views_()
   { }
 
   // During garbage collection, the Read_symbols_data pass for 
@@ -1165,9 +1198,21 @@ class Relobj : public Object
   { return this->dyn_reloc_count_; }
 
   // Relocate the input sections and write out the local symbols.
+  // WORKQUEUE may be used to share the work with other tasks.  If it
+  // is, this returns a blocker which those tasks release when they
+  // are done, and finish_relocate must be called after that.
+  // Otherwise this returns NULL.
+  Task_token*
+  relocate(const Symbol_table* symtab, const Layout* layout, Output_file* of,
+	   Workqueue* workqueue)
+  { return this->do_relocate(symtab, layout, of, workqueue); }
+
+  // Finish relocating the input sections and write out the local
+  // symbols, once the tasks sharing the work of relocate are done.
   void
-  relocate(const Symbol_table* symtab, const Layout* layout, Output_file* of)
-  { return this->do_relocate(symtab, layout, of); }
+  finish_relocate(const Symbol_table* symtab, const Layout* layout,
+		  Output_file* of)
+  { this->do_finish_relocate(symtab, layout, of); }
 
   // Return whether an input section is being included in the link.
   bool
@@ -1213,6 +1258,18 @@ class Relobj : public Object
     this->object_merge_map_ = object_merge_map;
   }
 
+  // Return the contents of section SHNDX, in a view which stays valid
+  // while the object is unlocked, until release_lasting_views is
+  // called.  Set *PLEN to the size.  Return NULL if there is no such
+  // view, e.g. because the section is compressed.
+  const unsigned char*
+  lasting_section_contents(unsigned int shndx, section_size_type* plen);
+
+  // Release the views returned by lasting_section_contents.  This may
+  // only be called while the object is locked.
+  void
+  release_lasting_views();
+
   // Record the relocatable reloc info for an input reloc section.
   void
   set_relocatable_relocs(unsigned int reloc_shndx, Relocatable_relocs* rr)
@@ -1332,8 +1389,15 @@ class Relobj : public Object
 
   // Relocate the input sections and write out the local
   // symbols--implemented by child class.
+  virtual Task_token*
+  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of,
+	      Workqueue*) = 0;
+
+  // Finish relocating the input sections--implemented by child class
+  // if do_relocate may share the work with other tasks.
   virtual void
-  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of) = 0;
+  do_finish_relocate(const Symbol_table*, const Layout*, Output_file*)
+  { gold_unreachable(); }
 
   // Set the offset of a section--implemented by child class.
   virtual void
@@ -1344,6 +1408,12 @@ class Relobj : public Object
   virtual void
   do_layout_deferred_sections(Layout*) = 0;
 
+  // Return a lasting view of the contents of section SHNDX, or NULL
+  // if the child class can not provide one.
+  virtual File_view*
+  do_lasting_section_view(unsigned int, section_size_type*)
+  { return NULL; }
+
   // Given a section index, return the corresponding Output_section.
   // The return value will be NULL if the section is not included in
   // the link.
@@ -1454,6 +1524,8 @@ class Relobj : public Object
   unsigned int first_dyn_reloc_;
   // Count of dynamic relocations for this object.
   unsigned int dyn_reloc_count_;
+  // Views returned by lasting_section_contents.
+  std::vector<File_view*> lasting_views_;
 };
 
 // This class is used to handle relocations against a section symbol
@@ -2042,6 +2114,20 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   typedef typename Sized_relobj<size, big_endian>::Symbols Symbols;
   typedef std::vector<Symbol_value<size> > Local_values;
 
+  // Views and sizes when relocating.
+  struct View_size
+  {
+    unsigned char* view;
+    typename elfcpp::Elf_types<size>::Elf_Addr address;
+    off_t offset;
+    section_size_type view_size;
+    bool is_input_output_view;
+    bool is_postprocessing_view;
+    bool is_ctors_reverse_view;
+  };
+
+  typedef std::vector<View_size> Views;
+
   static const Address invalid_address = static_cast<Address>(0) - 1;
 
   enum Compute_final_local_value_status
@@ -2202,6 +2288,18 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
 			    Symbol_value<size>* lv_out,
 			    const Symbol_table* symtab);
 
+  // Relocate the sections with indexes from FIRST_SHNDX up to but not
+  // including LAST_SHNDX.  This is called by Relocate_range_task.
+  void
+  relocate_section_range(const Symbol_table* symtab, const Layout* layout,
+			 const unsigned char* pshdrs, Output_file* of,
+			 Views* pviews, unsigned int first_shndx,
+			 unsigned int last_shndx)
+  {
+    this->do_relocate_sections(symtab, layout, pshdrs, of, pviews,
+			       first_shndx, last_shndx);
+  }
+
  protected:
   typedef typename Sized_relobj<size, big_endian>::Output_sections
       Output_sections;
@@ -2305,8 +2403,15 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   do_set_local_dynsym_offset(off_t);
 
   // Relocate the input sections and write out the local symbols.
+  Task_token*
+  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of,
+	      Workqueue*);
+
+  // Finish relocating the input sections and write out the local
+  // symbols, after the tasks relocating them are done.
   void
-  do_relocate(const Symbol_table* symtab, const Layout*, Output_file* of);
+  do_finish_relocate(const Symbol_table* symtab, const Layout*,
+		     Output_file* of);
 
   // Get the size of a section.
   uint64_t
@@ -2333,6 +2438,10 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
     return this->get_view(loc.file_offset, *plen, true, cache);
   }
 
+  // Return a lasting view of the contents of a section.
+  File_view*
+  do_lasting_section_view(unsigned int shndx, section_size_type* plen);
+
   // Return section flags.
   uint64_t
   do_section_flags(unsigned int shndx);
@@ -2413,30 +2522,28 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   local_values()
   { return &this->local_values_; }
 
-  // Views and sizes when relocating.
-  struct View_size
-  {
-    unsigned char* view;
-    typename elfcpp::Elf_types<size>::Elf_Addr address;
-    off_t offset;
-    section_size_type view_size;
-    bool is_input_output_view;
-    bool is_postprocessing_view;
-    bool is_ctors_reverse_view;
-  };
-
-  typedef std::vector<View_size> Views;
-
   // Stash away info for a number of special sections.
   // Return true if any of the sections found require local symbols to be read.
   virtual bool
   do_find_special_sections(Read_symbols_data* sd);
 
-  // This may be overriden by a child class.
+  // Relocate the sections with indexes from FIRST_SHNDX up to but not
+  // including LAST_SHNDX.  This may be overriden by a child class.
+  // Several ranges of the same object may be relocated at the same
+  // time by different threads.
   virtual void
   do_relocate_sections(const Symbol_table* symtab, const Layout* layout,
 		       const unsigned char* pshdrs, Output_file* of,
-		       Views* pviews);
+		       Views* pviews, unsigned int first_shndx,
+		       unsigned int last_shndx);
+
+  // Finish relocating the sections, once all the ranges are done.
+  // This is called by a single thread, and may be overriden by a
+  // child class which needs to change the relocated section data.
+  virtual void
+  do_finish_relocate_sections(const Symbol_table*, const Layout*,
+			      const unsigned char*, Output_file*, Views*)
+  { }
 
   // Adjust this local symbol value.  Return false if the symbol
   // should be discarded from the output file.
@@ -2555,7 +2662,24 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   relocate_sections(const Symbol_table* symtab, const Layout* layout,
 		    const unsigned char* pshdrs, Output_file* of,
 		    Views* pviews)
-  { this->do_relocate_sections(symtab, layout, pshdrs, of, pviews); }
+  {
+    this->do_relocate_sections(symtab, layout, pshdrs, of, pviews, 1,
+			       this->shnum());
+    this->do_finish_relocate_sections(symtab, layout, pshdrs, of, pviews);
+  }
+
+  // Split the relocation of a large object across several tasks.
+  // Return a blocker which the tasks release when they are done, or
+  // NULL if the object is not worth splitting.
+  Task_token*
+  relocate_sections_in_tasks(const Symbol_table* symtab,
+			     const Layout* layout,
+			     const unsigned char* pshdrs, Output_file* of,
+			     Views* pviews, Workqueue* workqueue);
+
+  // Write out the relocated VIEWS and the local symbols.
+  void
+  write_relocated_sections(const Layout*, Output_file*, Views* pviews);
 
   // Reverse the words in a section.  Used for .ctors sections mapped
   // to .init_array sections.
@@ -2747,6 +2871,10 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   // For compressed debug sections, map section index to uncompressed size
   // and contents.
   Compressed_section_map* compressed_sections_;
+  // While the sections are being relocated by several tasks, the
+  // ranges of sections they share, and the views they relocate.
+  Relocate_ranges* relocate_ranges_;
+  Views relocate_views_;
 };
 
 // A class to manage the list of all objects.
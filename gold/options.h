@@ -679,12 +679,14 @@ class General_options
 	      N_("Bind defined function symbols locally"), NULL);
 
   DEFINE_optional_string(build_id, options::TWO_DASHES, '\0', "tree",
-			 N_("Generate build ID note"),
+			 N_("Generate build ID note; STYLE is sha1, md5, "
+			    "uuid, tree, fast, none or 0xHEX"),
 			 N_("[=STYLE]"));
 
   DEFINE_uint64(build_id_chunk_size_for_treehash,
 		options::TWO_DASHES, '\0', 2 << 20,
-		N_("Chunk size for '--build-id=tree'"), N_("SIZE"));
+		N_("Chunk size for '--build-id=tree' and '--build-id=fast'"),
+		N_("SIZE"));
 
   DEFINE_uint64(build_id_min_file_size_for_treehash, options::TWO_DASHES,
 		'\0', 40 << 20,
@@ -1136,6 +1138,11 @@ class General_options
   DEFINE_string(sysroot, options::TWO_DASHES, '\0', "",
 		N_("Set target system root directory"), N_("DIR"));
 
+  DEFINE_string(trace_file, options::TWO_DASHES, '\0', NULL,
+		N_("Write a timeline of the link's tasks to FILE, "
+		   "in Chrome trace event format"),
+		N_("FILE"));
+
   DEFINE_bool(trace, options::TWO_DASHES, 't', false,
 	      N_("Print the name of each input file"), NULL);
 
@@ -1336,6 +1343,17 @@ class General_options
   // any problems.
   void finalize();
 
+  // Set the threading options, as --threads and --thread-count do.
+  // This is for programs which parse their own command line, such as
+  // dwp.  A THREAD_COUNT of zero means the default.
+  void
+  set_thread_options(bool threads, int thread_count)
+  {
+    this->set_threads(threads);
+    this->set_user_set_threads();
+    this->set_thread_count(thread_count);
+  }
+
   // True if we printed the version information.
   bool
   printed_version() const
@@ -45,6 +45,7 @@
 #include "descriptors.h"
 #include "layout.h"
 #include "output.h"
+#include "gold-threads.h"
 
 // For systems without mmap support.
 #ifndef HAVE_MMAP
@@ -4013,6 +4014,26 @@ Output_section::print_merge_stats()
     p->print_merge_stats(this->name_);
 }
 
+// Queue tasks to process SHF_MERGE sections.
+
+void
+Output_section::queue_merge_tasks(Workqueue* workqueue,
+				  std::vector<Task_token*>* blockers)
+{
+  for (Input_section_list::iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    {
+      if (p->is_merge_section())
+	{
+	  Task_token* blocker =
+	    p->output_merge_base()->queue_merge_tasks(workqueue);
+	  if (blocker != NULL)
+	    blockers->push_back(blocker);
+	}
+    }
+}
+
 // Set a fixed layout for the section.  Used for incremental update links.
 
 void
@@ -4897,7 +4918,14 @@ Output_file::Output_file(const char* name)
     base_(NULL),
     map_is_anonymous_(false),
     map_is_allocated_(false),
-    is_temporary_(false)
+    is_temporary_(false),
+    is_streaming_(false),
+    stream_views_(),
+    stream_view_buffers_(),
+    max_stream_view_size_(0),
+    written_extents_(),
+    resident_regions_(),
+    stream_lock_(NULL)
 {
 }
 
@@ -5058,7 +5086,14 @@ Output_file::resize(off_t file_size)
   // If the mmap is mapping an anonymous memory buffer, this is easy:
   // just mremap to the new size.  If it's mapping to a file, we want
   // to unmap to flush to the file, then remap after growing the file.
-  if (this->map_is_anonymous_)
+  if (this->is_streaming_)
+    {
+      gold_assert(this->stream_views_.empty());
+      if (::ftruncate(this->o_, file_size) < 0)
+	gold_fatal(_("%s: ftruncate: %s"), this->name_, strerror(errno));
+      this->file_size_ = file_size;
+    }
+  else if (this->map_is_anonymous_)
     {
       void* base;
       if (!this->map_is_allocated_)
@@ -5160,6 +5195,37 @@ Output_file::map_no_anonymous(bool writable)
   return true;
 }
 
+// Set up to write the output to the file as each view is finished,
+// rather than mapping it.  This requires a regular file.  It is not
+// used for incremental links, which rely on the views being part of
+// a single buffer, or for targets which write to a view after it has
+// been written.  Return whether we are streaming.
+
+bool
+Output_file::map_streaming()
+{
+  const int o = this->o_;
+  struct stat statbuf;
+  if (o == STDOUT_FILENO || o == STDERR_FILENO
+      || ::fstat(o, &statbuf) != 0
+      || !S_ISREG(statbuf.st_mode)
+      || this->is_temporary_
+      || parameters->incremental()
+      || (parameters->target_valid()
+	  && parameters->target().retains_output_views()))
+    return false;
+
+  int err = gold_fallocate(o, 0, this->file_size_);
+  if (err != 0)
+    gold_fatal(_("%s: %s"), this->name_, strerror(err));
+
+  this->stream_lock_ = new Lock();
+  this->is_streaming_ = true;
+  this->map_is_anonymous_ = false;
+  this->base_ = NULL;
+  return true;
+}
+
 // Map the file into memory.
 
 void
@@ -5173,7 +5239,11 @@ Output_file::map()
   // system might not support mmap at all, or it might not support
   // mmap with PROT_WRITE.  I'm not sure which errno values we will
   // see in all cases, so if the mmap fails for any reason and we
-  // don't care about file contents, try for an anonymous map.
+  // don't care about file contents, try to stream the output to the
+  // file, and failing that try for an anonymous map.
+  if (this->map_streaming())
+    return;
+
   if (this->map_anonymous())
     return;
 
@@ -5187,7 +5257,21 @@ Output_file::map()
 void
 Output_file::unmap()
 {
-  if (this->map_is_anonymous_)
+  if (this->is_streaming_)
+    {
+      // Everything else has been written as we went.
+      gold_assert(this->stream_views_.empty());
+      for (Resident_regions::iterator p = this->resident_regions_.begin();
+	   p != this->resident_regions_.end();
+	   ++p)
+	{
+	  this->stream_pwrite(p->first, p->second.end - p->first,
+			      p->second.data);
+	  delete[] p->second.data;
+	}
+      this->resident_regions_.clear();
+    }
+  else if (this->map_is_anonymous_)
     {
       // We've already written out the data, so there is no reason to
       // waste time unmapping or freeing the memory.
@@ -5200,6 +5284,476 @@ Output_file::unmap()
   this->base_ = NULL;
 }
 
+// Add the part of the file from START to END to EXTENTS, merging it
+// with any extents which it overlaps or touches.
+
+void
+Output_file::add_extent(Extents* extents, off_t start, off_t end)
+{
+  if (start >= end)
+    return;
+
+  Extents::iterator p = extents->upper_bound(start);
+  if (p != extents->begin())
+    {
+      Extents::iterator prev = p;
+      --prev;
+      if (prev->second >= start)
+	{
+	  start = prev->first;
+	  if (prev->second > end)
+	    end = prev->second;
+	  extents->erase(prev);
+	}
+    }
+  while (p != extents->end() && p->first <= end)
+    {
+      if (p->second > end)
+	end = p->second;
+      extents->erase(p++);
+    }
+  (*extents)[start] = end;
+}
+
+// Return whether any part of the file from START for SIZE bytes has
+// been written while streaming.  The stream lock must be held.
+
+bool
+Output_file::is_written(off_t start, size_t size) const
+{
+  off_t end = start + static_cast<off_t>(size);
+  Extents::const_iterator p = this->written_extents_.upper_bound(start);
+  if (p != this->written_extents_.begin())
+    {
+      Extents::const_iterator prev = p;
+      --prev;
+      if (prev->second > start)
+	return true;
+    }
+  return p != this->written_extents_.end() && p->first < end;
+}
+
+// Record a view of the file from START for SIZE bytes while
+// streaming, and return it.  Any part of it which another view is
+// being written to right now is treated as already overwritten, since
+// we cannot tell whether the contents we read for it are old or new.
+// The stream lock must be held.
+
+Output_file::Stream_views::iterator
+Output_file::add_stream_view(off_t start, size_t size)
+{
+  off_t end = start + static_cast<off_t>(size);
+  Stream_views::iterator pv =
+    this->stream_views_.insert(std::make_pair(start,
+					      Stream_view(start, size)));
+
+  off_t first = start - static_cast<off_t>(this->max_stream_view_size_);
+  for (Stream_views::iterator p = this->stream_views_.lower_bound(first);
+       p != this->stream_views_.end() && p->first < end;
+       ++p)
+    {
+      if (p == pv || !p->second.writing)
+	continue;
+      off_t from = std::max(start, p->first);
+      off_t to = std::min(end,
+			  p->first + static_cast<off_t>(p->second.size));
+      add_extent(&pv->second.overwritten, from, to);
+    }
+
+  if (size > this->max_stream_view_size_)
+    this->max_stream_view_size_ = size;
+  return pv;
+}
+
+// Return in GAPS the parts of a view of the file from START to END
+// which are not in OVERWRITTEN, which are the parts its user may have
+// written.
+
+static void
+stream_view_gaps(off_t start, off_t end,
+		 const std::map<off_t, off_t>& overwritten,
+		 std::vector<std::pair<off_t, off_t> >* gaps)
+{
+  off_t pos = start;
+  for (std::map<off_t, off_t>::const_iterator p = overwritten.begin();
+       p != overwritten.end();
+       ++p)
+    {
+      if (p->first > pos)
+	gaps->push_back(std::make_pair(pos, p->first));
+      if (p->second > pos)
+	pos = p->second;
+    }
+  if (pos < end)
+    gaps->push_back(std::make_pair(pos, end));
+}
+
+// Start writing the view PV, whose contents are in BUF, while
+// streaming.  This records the parts of the file it writes, which are
+// those not overwritten since it was handed out, as written, and as
+// overwritten in every other view which overlaps them.  Those parts
+// which are resident are copied now.  The stream lock must be held;
+// the file itself is written by finish_stream_write without it.
+
+void
+Output_file::start_stream_write(Stream_views::iterator pv,
+				const unsigned char* buf)
+{
+  off_t start = pv->second.start;
+  off_t end = start + static_cast<off_t>(pv->second.size);
+  pv->second.writing = true;
+
+  std::vector<std::pair<off_t, off_t> > gaps;
+  stream_view_gaps(start, end, pv->second.overwritten, &gaps);
+
+  off_t first = start - static_cast<off_t>(this->max_stream_view_size_);
+  for (std::vector<std::pair<off_t, off_t> >::const_iterator pg =
+	 gaps.begin();
+       pg != gaps.end();
+       ++pg)
+    {
+      off_t gap_start = pg->first;
+      off_t gap_end = pg->second;
+      add_extent(&this->written_extents_, gap_start, gap_end);
+      this->copy_to_resident(gap_start, gap_end - gap_start,
+			     buf + (gap_start - start));
+
+      for (Stream_views::iterator p = this->stream_views_.lower_bound(first);
+	   p != this->stream_views_.end() && p->first < gap_end;
+	   ++p)
+	{
+	  if (p == pv || p->second.writing)
+	    continue;
+	  off_t from = std::max(gap_start, p->first);
+	  off_t to = std::min(gap_end,
+			      p->first + static_cast<off_t>(p->second.size));
+	  add_extent(&p->second.overwritten, from, to);
+	}
+    }
+}
+
+// Finish writing the view PV, whose contents are in BUF, while
+// streaming: write the parts recorded by start_stream_write to the
+// file, and forget the view.  The stream lock must not be held.
+
+void
+Output_file::finish_stream_write(Stream_views::iterator pv,
+				 const unsigned char* buf)
+{
+  // Other views do not change the OVERWRITTEN extents of a view which
+  // is being written, so we may look at them without the lock.
+  off_t start = pv->second.start;
+  off_t end = start + static_cast<off_t>(pv->second.size);
+  std::vector<std::pair<off_t, off_t> > gaps;
+  stream_view_gaps(start, end, pv->second.overwritten, &gaps);
+
+  for (std::vector<std::pair<off_t, off_t> >::const_iterator pg =
+	 gaps.begin();
+       pg != gaps.end();
+       ++pg)
+    this->stream_pwrite(pg->first, pg->second - pg->first,
+			buf + (pg->first - start));
+
+  Hold_lock hl(*this->stream_lock_);
+  this->stream_views_.erase(pv);
+}
+
+// Read SIZE bytes at START from the file into BUF while streaming.
+
+void
+Output_file::stream_pread(off_t start, size_t size, unsigned char* buf)
+{
+  while (size > 0)
+    {
+      ssize_t got = ::pread(this->o_, buf, size, start);
+      if (got < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  gold_fatal(_("%s: pread: %s"), this->name_, strerror(errno));
+	}
+      if (got == 0)
+	gold_fatal(_("%s: pread: unexpected end of file"), this->name_);
+      buf += got;
+      start += got;
+      size -= got;
+    }
+}
+
+// Write SIZE bytes from BUF at START in the file while streaming.
+
+void
+Output_file::stream_pwrite(off_t start, size_t size, const unsigned char* buf)
+{
+  while (size > 0)
+    {
+      ssize_t written = ::pwrite(this->o_, buf, size, start);
+      if (written < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  gold_fatal(_("%s: pwrite: %s"), this->name_, strerror(errno));
+	}
+      if (written == 0)
+	gold_fatal(_("%s: pwrite: unexpected 0 return-value"), this->name_);
+      buf += written;
+      start += written;
+      size -= written;
+    }
+}
+
+// Return the resident region which holds all of the file from START
+// for SIZE bytes, or NULL if there is none.  The stream lock must be
+// held.
+
+unsigned char*
+Output_file::find_resident(off_t start, size_t size) const
+{
+  Resident_regions::const_iterator p =
+    this->resident_regions_.upper_bound(start);
+  if (p == this->resident_regions_.begin())
+    return NULL;
+  --p;
+  if (start + static_cast<off_t>(size) > p->second.end)
+    return NULL;
+  return p->second.data + (start - p->first);
+}
+
+// Return whether any part of the file from START for SIZE bytes is in
+// a resident region.  The stream lock must be held.
+
+bool
+Output_file::overlaps_resident(off_t start, size_t size) const
+{
+  off_t end = start + static_cast<off_t>(size);
+  Resident_regions::const_iterator p =
+    this->resident_regions_.upper_bound(start);
+  if (p != this->resident_regions_.begin())
+    {
+      Resident_regions::const_iterator prev = p;
+      --prev;
+      if (prev->second.end > start)
+	return true;
+    }
+  return p != this->resident_regions_.end() && p->first < end;
+}
+
+// Copy the parts of the file from START for SIZE bytes which are in
+// resident regions into BUF.  The stream lock must be held.
+
+void
+Output_file::copy_from_resident(off_t start, size_t size,
+				unsigned char* buf) const
+{
+  off_t end = start + static_cast<off_t>(size);
+  Resident_regions::const_iterator p =
+    this->resident_regions_.upper_bound(start);
+  if (p != this->resident_regions_.begin())
+    --p;
+  for (; p != this->resident_regions_.end() && p->first < end; ++p)
+    {
+      off_t from = std::max(start, p->first);
+      off_t to = std::min(end, p->second.end);
+      if (from < to)
+	memcpy(buf + (from - start), p->second.data + (from - p->first),
+	       to - from);
+    }
+}
+
+// Copy the parts of BUF, which holds the file from START for SIZE
+// bytes, which are in resident regions into those regions.  The
+// stream lock must be held.
+
+void
+Output_file::copy_to_resident(off_t start, size_t size,
+			      const unsigned char* buf)
+{
+  off_t end = start + static_cast<off_t>(size);
+  Resident_regions::iterator p = this->resident_regions_.upper_bound(start);
+  if (p != this->resident_regions_.begin())
+    --p;
+  for (; p != this->resident_regions_.end() && p->first < end; ++p)
+    {
+      off_t from = std::max(start, p->first);
+      off_t to = std::min(end, p->second.end);
+      if (from < to)
+	memcpy(p->second.data + (from - p->first), buf + (from - start),
+	       to - from);
+    }
+}
+
+// Return a view of the file from START for SIZE bytes while
+// streaming, which is shared with all other views of the same part of
+// the file.  The first such view makes that part of the file resident
+// in memory, and it is written out when the file is closed.  This is
+// used for sections which every object relocates in place, such as
+// .eh_frame, so that the objects need neither a copy of the section
+// each nor to merge their changes back into the file.
+
+unsigned char*
+Output_file::get_resident_view(off_t start, size_t size)
+{
+  {
+    Hold_lock hl(*this->stream_lock_);
+
+    unsigned char* view = this->find_resident(start, size);
+    if (view != NULL)
+      return view;
+
+    // This happens once for each such section, so we simply hold the
+    // lock while we read it.
+    if (!this->overlaps_resident(start, size))
+      {
+	view = new unsigned char[size];
+	if (!this->is_written(start, size))
+	  memset(view, 0, size);
+	else
+	  this->stream_pread(start, size, view);
+	this->resident_regions_.insert(
+	    std::make_pair(start, Resident_region(start + size, view)));
+	return view;
+      }
+  }
+
+  // This partly overlaps a resident region, which should not happen
+  // as we only use these views for whole output sections.  Fall back
+  // to an ordinary view.
+  return this->get_stream_view(start, size);
+}
+
+// Return a view of the file from START for SIZE bytes while streaming.
+// If that part of the file is resident, this is simply a pointer into
+// it.  Otherwise the view holds the current contents of the file.
+// Different views may overlap, as long as their users write different
+// bytes.  When the view is written, the parts of it which other views
+// have written since it was handed out are left alone.
+
+unsigned char*
+Output_file::get_stream_view(off_t start, size_t size)
+{
+  unsigned char* view;
+  bool written;
+  bool overlaps_resident;
+  {
+    Hold_lock hl(*this->stream_lock_);
+
+    view = this->find_resident(start, size);
+    if (view != NULL)
+      return view;
+
+    view = new unsigned char[size];
+    Stream_views::iterator pv = this->add_stream_view(start, size);
+    this->stream_view_buffers_[view] = pv;
+    written = this->is_written(start, size);
+    overlaps_resident = this->overlaps_resident(start, size);
+  }
+
+  // Any part of the file which is being written now is already
+  // recorded as overwritten in this view, so it does not matter what
+  // we read for it.
+  if (!written)
+    memset(view, 0, size);
+  else
+    this->stream_pread(start, size, view);
+
+  if (overlaps_resident)
+    {
+      Hold_lock hl(*this->stream_lock_);
+      this->copy_from_resident(start, size, view);
+    }
+
+  return view;
+}
+
+// Write the view VIEW of the file from START for SIZE bytes, and free
+// it.  A view into a resident region is written when the file is
+// closed.
+
+void
+Output_file::write_stream_view(off_t start, size_t size, unsigned char* view)
+{
+  Stream_views::iterator pv;
+  {
+    Hold_lock hl(*this->stream_lock_);
+
+    if (view == this->find_resident(start, size))
+      return;
+
+    Stream_view_buffers::iterator p = this->stream_view_buffers_.find(view);
+    gold_assert(p != this->stream_view_buffers_.end());
+    pv = p->second;
+    this->stream_view_buffers_.erase(p);
+    this->start_stream_write(pv, view);
+  }
+
+  this->finish_stream_write(pv, view);
+  delete[] view;
+}
+
+// Return a read-only view of the file from START for SIZE bytes while
+// streaming.  This is freed by free_input_view.
+
+const unsigned char*
+Output_file::read_stream_view(off_t start, size_t size)
+{
+  bool written;
+  bool overlaps_resident;
+  {
+    Hold_lock hl(*this->stream_lock_);
+
+    unsigned char* view = this->find_resident(start, size);
+    if (view != NULL)
+      return view;
+
+    written = this->is_written(start, size);
+    overlaps_resident = this->overlaps_resident(start, size);
+  }
+
+  unsigned char* view = new unsigned char[size];
+  if (!written)
+    memset(view, 0, size);
+  else
+    this->stream_pread(start, size, view);
+
+  if (overlaps_resident)
+    {
+      Hold_lock hl(*this->stream_lock_);
+      this->copy_from_resident(start, size, view);
+    }
+
+  return view;
+}
+
+// Free a view returned by read_stream_view.
+
+void
+Output_file::free_stream_view(off_t start, size_t size,
+			      const unsigned char* view)
+{
+  {
+    Hold_lock hl(*this->stream_lock_);
+    if (view == this->find_resident(start, size))
+      return;
+  }
+  delete[] view;
+}
+
+// Write SIZE bytes of DATA at START in the file while streaming.  This
+// is treated as a view which is written as soon as it is handed out.
+
+void
+Output_file::stream_write(off_t start, const void* data, size_t size)
+{
+  const unsigned char* buf = static_cast<const unsigned char*>(data);
+  Stream_views::iterator pv;
+  {
+    Hold_lock hl(*this->stream_lock_);
+    pv = this->add_stream_view(start, size);
+    this->start_stream_write(pv, buf);
+  }
+  this->finish_stream_write(pv, buf);
+}
+
 // Close the output file.
 
 void
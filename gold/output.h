@@ -24,6 +24,7 @@
 #define GOLD_OUTPUT_H
 
 #include <list>
+#include <map>
 #include <vector>
 
 #include "elfcpp.h"
@@ -35,6 +36,7 @@ namespace gold
 {
 
 class General_options;
+class Lock;
 class Object;
 class Symbol;
 class Output_file;
@@ -3918,6 +3920,12 @@ class Output_section : public Output_data
   void
   print_merge_stats();
 
+  // Queue tasks to process the input sections of SHF_MERGE sections
+  // in parallel, and add the blockers which are unblocked when they
+  // are done to BLOCKERS.
+  void
+  queue_merge_tasks(Workqueue* workqueue, std::vector<Task_token*>* blockers);
+
   // Set a fixed layout for the section.  Used for incremental update links.
   void
   set_fixed_layout(uint64_t sh_addr, off_t sh_offset, off_t sh_size,
@@ -4792,13 +4800,24 @@ class Output_file
   filename()
   { return this->name_; }
 
-  // We currently always use mmap which makes the view handling quite
-  // simple.  In the future we may support other approaches.
+  // Normally the file is mapped into memory, either directly or as
+  // an anonymous buffer which is written out when the file is closed,
+  // which makes the view handling quite simple.  If the file cannot
+  // be mapped, or --no-mmap-output-file is used, and the file is a
+  // regular file, we instead stream the output: each view is a
+  // separate buffer which is written to the file with pwrite when the
+  // caller is done with it, so only the views in use are held in
+  // memory.
 
   // Write data to the output file.
   void
   write(off_t offset, const void* data, size_t len)
-  { memcpy(this->base_ + offset, data, len); }
+  {
+    if (this->is_streaming_)
+      this->stream_write(offset, data, len);
+    else
+      memcpy(this->base_ + offset, data, len);
+  }
 
   // Get a buffer to use to write to the file, given the offset into
   // the file and the size.
@@ -4807,38 +4826,109 @@ class Output_file
   {
     gold_assert(start >= 0
 		&& start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->is_streaming_)
+      return this->get_stream_view(start, size);
     return this->base_ + start;
   }
 
   // VIEW must have been returned by get_output_view.  Write the
   // buffer to the file, passing in the offset and the size.
   void
-  write_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_output_view(off_t start, size_t size, unsigned char* view)
+  {
+    if (this->is_streaming_)
+      this->write_stream_view(start, size, view);
+  }
 
   // Get a read/write buffer.  This is used when we want to write part
-  // of the file, read it in, and write it again.
+  // of the file, read it in, and write it again.  Several tasks may
+  // use views of the same part of the file at once, each writing
+  // different bytes, so when streaming all such views share one
+  // buffer, which is written out when the file is closed.
   unsigned char*
   get_input_output_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    if (this->is_streaming_)
+      {
+	gold_assert(start >= 0
+		    && start + static_cast<off_t>(size) <= this->file_size_);
+	return this->get_resident_view(start, size);
+      }
+    return this->get_output_view(start, size);
+  }
 
   // Write a read/write buffer back to the file.
   void
-  write_input_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_input_output_view(off_t start, size_t size, unsigned char* view)
+  { this->write_output_view(start, size, view); }
 
   // Get a read buffer.  This is used when we just want to read part
   // of the file back it in.
   const unsigned char*
   get_input_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    if (this->is_streaming_)
+      {
+	gold_assert(start >= 0
+		    && start + static_cast<off_t>(size) <= this->file_size_);
+	return this->read_stream_view(start, size);
+      }
+    return this->get_output_view(start, size);
+  }
 
   // Release a read bfufer.
   void
-  free_input_view(off_t, size_t, const unsigned char*)
-  { }
+  free_input_view(off_t start, size_t size, const unsigned char* view)
+  {
+    if (this->is_streaming_)
+      this->free_stream_view(start, size, view);
+  }
 
  private:
+  // Parts of the file, mapping the start offset to the end offset.
+  // Adjacent parts are merged.
+  typedef std::map<off_t, off_t> Extents;
+
+  // A view handed out while streaming, of the file from START for
+  // SIZE bytes.  OVERWRITTEN holds the parts of it which other writes
+  // have written since it was handed out; its user did not write
+  // them, so they are not written back from it.  WRITING is set while
+  // the view itself is being written to the file.
+  struct Stream_view
+  {
+    Stream_view(off_t a_start, size_t a_size)
+      : start(a_start), size(a_size), writing(false), overwritten()
+    { }
+
+    off_t start;
+    size_t size;
+    bool writing;
+    Extents overwritten;
+  };
+
+  // The views handed out, indexed by start offset, and the same views
+  // indexed by buffer.
+  typedef std::multimap<off_t, Stream_view> Stream_views;
+  typedef Unordered_map<const unsigned char*, Stream_views::iterator>
+    Stream_view_buffers;
+
+  // A part of the file which is kept in memory while streaming,
+  // because it is written through input/output views.  END is the
+  // end offset, and DATA holds the contents.
+  struct Resident_region
+  {
+    Resident_region(off_t a_end, unsigned char* a_data)
+      : end(a_end), data(a_data)
+    { }
+
+    off_t end;
+    unsigned char* data;
+  };
+
+  // The resident regions, indexed by start offset.  They do not
+  // overlap.
+  typedef std::map<off_t, Resident_region> Resident_regions;
+
   // Map the file into memory or, if that fails, allocate anonymous
   // memory.
   void
@@ -4852,10 +4942,66 @@ class Output_file
   bool
   map_no_anonymous(bool);
 
+  // Set up to stream the output to the file.
+  bool
+  map_streaming();
+
   // Unmap the file from memory (and flush to disk buffers).
   void
   unmap();
 
+  // Functions used when streaming the output.
+  unsigned char*
+  get_stream_view(off_t start, size_t size);
+
+  void
+  write_stream_view(off_t start, size_t size, unsigned char* view);
+
+  const unsigned char*
+  read_stream_view(off_t start, size_t size);
+
+  void
+  free_stream_view(off_t start, size_t size, const unsigned char* view);
+
+  unsigned char*
+  get_resident_view(off_t start, size_t size);
+
+  unsigned char*
+  find_resident(off_t start, size_t size) const;
+
+  bool
+  overlaps_resident(off_t start, size_t size) const;
+
+  void
+  copy_from_resident(off_t start, size_t size, unsigned char* buf) const;
+
+  void
+  copy_to_resident(off_t start, size_t size, const unsigned char* buf);
+
+  void
+  stream_write(off_t start, const void* data, size_t size);
+
+  static void
+  add_extent(Extents* extents, off_t start, off_t end);
+
+  bool
+  is_written(off_t start, size_t size) const;
+
+  Stream_views::iterator
+  add_stream_view(off_t start, size_t size);
+
+  void
+  start_stream_write(Stream_views::iterator pv, const unsigned char* buf);
+
+  void
+  finish_stream_write(Stream_views::iterator pv, const unsigned char* buf);
+
+  void
+  stream_pread(off_t start, size_t size, unsigned char* buf);
+
+  void
+  stream_pwrite(off_t start, size_t size, const unsigned char* buf);
+
   // File name.
   const char* name_;
   // File descriptor.
@@ -4870,6 +5016,20 @@ class Output_file
   bool map_is_allocated_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
+  // True if we are streaming the output to the file rather than
+  // mapping it.
+  bool is_streaming_;
+  // When streaming, the views which have been handed out and not yet
+  // written, the size of the largest view handed out, the parts of
+  // the file which have been written, the parts which are kept in
+  // memory, and the lock which protects them.  The lock is not held
+  // while reading or writing the file.
+  Stream_views stream_views_;
+  Stream_view_buffers stream_view_buffers_;
+  size_t max_stream_view_size_;
+  Extents written_extents_;
+  Resident_regions resident_regions_;
+  Lock* stream_lock_;
 };
 
 } // End namespace gold.
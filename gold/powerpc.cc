@@ -4441,6 +4441,7 @@ Stub_table<size, big_endian>::do_write(Output_file* of)
 	    }
 	}
     }
+  of->write_output_view(off, oview_size, oview);
 }
 
 // Write out .glink.
@@ -304,6 +304,12 @@ Read_symbols::do_read_symbols(Workqueue* workqueue)
 				      this->dirpath_, this);
 	  arch->setup();
 
+	  // An incremental link records a digest of the archive file.
+	  // Compute it here, in parallel, rather than in the serialized
+	  // Add_archive_symbols task.
+	  if (this->layout_->incremental_inputs() != NULL)
+	    arch->compute_file_digest();
+
 	  // Unlock the archive so it can be used in the next task.
 	  arch->unlock(this);
 
@@ -400,6 +406,16 @@ Read_symbols::do_read_symbols(Workqueue* workqueue)
       Read_symbols_data* sd = new Read_symbols_data;
       elf_obj->read_symbols(sd);
 
+      // An incremental link records a digest of each file named
+      // directly.  Compute it here, in parallel, rather than in the
+      // serialized Add_symbols task.
+      if (this->member_ == NULL
+	  && this->layout_->incremental_inputs() != NULL)
+	{
+	  elf_obj->get_file_digest(sd->file_digest);
+	  sd->has_file_digest = true;
+	}
+
       // Opening the file locked it, so now we need to unlock it.  We
       // need to unlock it before queuing the Add_symbols task,
       // because the workqueue doesn't know about our lock on the
@@ -629,7 +645,11 @@ Add_symbols::run(Workqueue*)
 	  unsigned int arg_serial = this->input_argument_->file().arg_serial();
 	  Script_info* script_info = this->input_argument_->script_info();
 	  incremental_inputs->report_object(this->object_, arg_serial,
-					    this->library_, script_info);
+					    this->library_, script_info,
+					    (this->sd_ != NULL
+					     && this->sd_->has_file_digest
+					     ? this->sd_->file_digest
+					     : NULL));
 	}
       this->object_->layout(this->symtab_, this->layout_, this->sd_);
       this->object_->add_symbols(this->symtab_, this->sd_, this->layout_);
@@ -713,7 +733,8 @@ Check_script::run(Workqueue*)
   Script_info* script_info =
       this->ibase_->get_script_info(this->input_file_index_);
   Timespec mtime = this->input_reader_->get_mtime();
-  incremental_inputs->report_script(script_info, arg_serial, mtime);
+  incremental_inputs->report_script(script_info, arg_serial, mtime,
+				    this->input_reader_->get_digest());
 }
 
 // Class Check_library.
@@ -234,9 +234,29 @@ Relocate_task::locks(Task_locker* tl)
 // Run the task.
 
 void
-Relocate_task::run(Workqueue*)
+Relocate_task::run(Workqueue* workqueue)
 {
-  this->object_->relocate(this->symtab_, this->layout_, this->of_);
+  // The merged sections have found their strings by now.
+  this->object_->release_lasting_views();
+
+  Task_token* ranges_blocker = this->object_->relocate(this->symtab_,
+						       this->layout_,
+						       this->of_, workqueue);
+  if (ranges_blocker != NULL)
+    {
+      // Other tasks are still relocating parts of the object.  Leave
+      // the file alone, and queue a task to finish with it when they
+      // are done.  That task takes over our blockers.
+      if (this->input_sections_blocker_ != NULL)
+	workqueue->add_blocker(this->input_sections_blocker_);
+      workqueue->add_blocker(this->final_blocker_);
+      workqueue->queue_soon(new Relocate_finish_task(
+			      this->symtab_, this->layout_, this->object_,
+			      this->of_, ranges_blocker,
+			      this->input_sections_blocker_,
+			      this->final_blocker_));
+      return;
+    }
 
   // This is normally the last thing we will do with an object, so
   // uncache all views.
@@ -253,6 +273,174 @@ Relocate_task::get_name() const
   return "Relocate_task " + this->object_->name();
 }
 
+// Relocate_finish_task methods.
+
+// We have to wait for the tasks relocating the object, and then for
+// the file.  While they run the file counts as locked although nobody
+// holds its token, so look at the token itself.
+
+Task_token*
+Relocate_finish_task::is_runnable()
+{
+  if (this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  Task_token* token = this->object_->token();
+  if (token != NULL && !token->is_writable())
+    return token;
+  return NULL;
+}
+
+// Like Relocate_task, we lock the file and unblock
+// INPUT_SECTIONS_BLOCKER, which may be NULL, and FINAL_BLOCKER.
+
+void
+Relocate_finish_task::locks(Task_locker* tl)
+{
+  if (this->input_sections_blocker_ != NULL)
+    tl->add(this, this->input_sections_blocker_);
+  tl->add(this, this->final_blocker_);
+  Task_token* token = this->object_->token();
+  if (token != NULL)
+    tl->add(this, token);
+}
+
+// Run the task.
+
+void
+Relocate_finish_task::run(Workqueue*)
+{
+  this->object_->finish_relocate(this->symtab_, this->layout_, this->of_);
+  this->object_->clear_view_cache_marks();
+  this->object_->release();
+}
+
+// Return a debugging name for the task.
+
+std::string
+Relocate_finish_task::get_name() const
+{
+  return "Relocate_finish_task " + this->object_->name();
+}
+
+// When a large object is relocated in several pieces, this records
+// the pieces and which of them have been claimed.  It is shared by
+// the Relocate_task for the object and the Relocate_range_tasks which
+// help it, and freed by the Relocate_finish_task.  Each piece is a
+// range of section indexes.
+
+class Relocate_ranges
+{
+ public:
+  typedef std::vector<std::pair<unsigned int, unsigned int> > Ranges;
+
+  // PSHDRS is the object's section headers.  BLOCKER is released by
+  // each Relocate_range_task.
+  Relocate_ranges(const Ranges& ranges, const unsigned char* pshdrs,
+		  Task_token* blocker)
+    : ranges_(ranges), next_(0), pshdrs_(pshdrs), blocker_(blocker),
+      lock_(), file_lock_()
+  { }
+
+  // Claim the next range which nobody has started, and return it in
+  // *FIRST_SHNDX and *LAST_SHNDX.  Return false if there are none
+  // left.
+  bool
+  claim(unsigned int* first_shndx, unsigned int* last_shndx)
+  {
+    Hold_lock hl(this->lock_);
+    if (this->next_ >= this->ranges_.size())
+      return false;
+    *first_shndx = this->ranges_[this->next_].first;
+    *last_shndx = this->ranges_[this->next_].second;
+    ++this->next_;
+    return true;
+  }
+
+  // The object's section headers.
+  const unsigned char*
+  pshdrs() const
+  { return this->pshdrs_; }
+
+  // The blocker released by the Relocate_range_tasks.
+  Task_token*
+  blocker() const
+  { return this->blocker_; }
+
+  // The lock to use for the object's file while the ranges are being
+  // relocated.
+  Lock*
+  file_lock()
+  { return &this->file_lock_; }
+
+ private:
+  // The ranges of section indexes.
+  Ranges ranges_;
+  // The index in ranges_ of the next range to claim.
+  size_t next_;
+  // The section headers.
+  const unsigned char* pshdrs_;
+  // The blocker for the Relocate_finish_task.
+  Task_token* blocker_;
+  // Protects next_.
+  Lock lock_;
+  // Held while reading the object's file.
+  Lock file_lock_;
+};
+
+// A task which helps the Relocate_task for a large object, by
+// relocating ranges of its sections until there are none left.
+
+template<int size, bool big_endian>
+class Relocate_range_task : public Task
+{
+ public:
+  typedef typename Sized_relobj_file<size, big_endian>::Views Views;
+
+  Relocate_range_task(const Symbol_table* symtab, const Layout* layout,
+		      Sized_relobj_file<size, big_endian>* object,
+		      Output_file* of, Views* pviews,
+		      Relocate_ranges* ranges)
+    : symtab_(symtab), layout_(layout), object_(object), of_(of),
+      pviews_(pviews), ranges_(ranges)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->ranges_->blocker()); }
+
+  void
+  run(Workqueue*)
+  {
+    // The Relocate_finish_task for the object waits for us, so the
+    // object and its views are valid while we relocate it.
+    unsigned int first_shndx;
+    unsigned int last_shndx;
+    while (this->ranges_->claim(&first_shndx, &last_shndx))
+      this->object_->relocate_section_range(this->symtab_, this->layout_,
+					    this->ranges_->pshdrs(),
+					    this->of_, this->pviews_,
+					    first_shndx, last_shndx);
+  }
+
+  std::string
+  get_name() const
+  { return "Relocate_range_task " + this->object_->name(); }
+
+ private:
+  const Symbol_table* symtab_;
+  const Layout* layout_;
+  Sized_relobj_file<size, big_endian>* object_;
+  Output_file* of_;
+  Views* pviews_;
+  Relocate_ranges* ranges_;
+};
+
 // Read the relocs and local symbols from the object file and store
 // the information in RD.
 
@@ -640,10 +828,11 @@ Sized_relobj_file<size, big_endian>::incremental_relocs_scan_reltype(
 // Relocate the input sections and write out the local symbols.
 
 template<int size, bool big_endian>
-void
+Task_token*
 Sized_relobj_file<size, big_endian>::do_relocate(const Symbol_table* symtab,
 						 const Layout* layout,
-						 Output_file* of)
+						 Output_file* of,
+						 Workqueue* workqueue)
 {
   unsigned int shnum = this->shnum();
 
@@ -665,9 +854,55 @@ Sized_relobj_file<size, big_endian>::do_relocate(const Symbol_table* symtab,
   // input offsets to output addresses.
   this->initialize_input_to_output_maps();
 
-  // Apply relocations.
+  // Apply relocations.  The work for a large object may be shared
+  // with other tasks, in which case do_finish_relocate does the rest.
+
+  Task_token* ranges_blocker =
+    this->relocate_sections_in_tasks(symtab, layout, pshdrs, of, &views,
+				     workqueue);
+  if (ranges_blocker != NULL)
+    return ranges_blocker;
 
   this->relocate_sections(symtab, layout, pshdrs, of, &views);
+  this->write_relocated_sections(layout, of, &views);
+  return NULL;
+}
+
+// Finish relocating the sections once the tasks sharing the work are
+// done, and write them out with the local symbols.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_finish_relocate(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    Output_file* of)
+{
+  Relocate_ranges* relocate_ranges = this->relocate_ranges_;
+  gold_assert(relocate_ranges != NULL);
+  this->relocate_ranges_ = NULL;
+
+  this->input_file()->file().set_share_lock(NULL);
+
+  this->do_finish_relocate_sections(symtab, layout, relocate_ranges->pshdrs(),
+				    of, &this->relocate_views_);
+  this->write_relocated_sections(layout, of, &this->relocate_views_);
+
+  Views().swap(this->relocate_views_);
+  delete relocate_ranges;
+}
+
+// Write out the relocated views and the local symbols.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::write_relocated_sections(
+    const Layout* layout,
+    Output_file* of,
+    Views* pviews)
+{
+  Views& views(*pviews);
+  unsigned int shnum = this->shnum();
 
   // After we've done the relocations, we release the hash tables,
   // since we no longer need them.
@@ -896,8 +1131,111 @@ Sized_relobj_file<size, big_endian>::write_sections(const Layout* layout,
     }
 }
 
-// Relocate section data.  VIEWS points to the section data as views
-// in the output file.
+// When using threads, an object with at least twice this many bytes
+// of relocations is relocated by several tasks, each handling about
+// this many bytes.  This keeps one large object from holding up the
+// end of the link.
+
+static const off_t relocate_range_size = 4 * 1024 * 1024;
+
+// The most tasks we use for one object.
+
+static const unsigned int max_relocate_ranges = 32;
+
+// Split relocating the sections of a large object into ranges of
+// section indexes, and queue tasks to relocate them in parallel.  We
+// relocate ranges ourselves as well, until none are left to claim.
+// The views in *PVIEWS are moved into the object, for the tasks and
+// for do_finish_relocate.  Return a blocker which the tasks release
+// when they are done, or NULL if the object is not worth splitting;
+// the caller should then relocate it.
+
+template<int size, bool big_endian>
+Task_token*
+Sized_relobj_file<size, big_endian>::relocate_sections_in_tasks(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const unsigned char* pshdrs,
+    Output_file* of,
+    Views* pviews,
+    Workqueue* workqueue)
+{
+  if (workqueue == NULL
+      || !parameters->options().threads()
+      || parameters->incremental())
+    return NULL;
+
+  // Weigh each section by the size of its relocations.
+  unsigned int shnum = this->shnum();
+  off_t total_size = 0;
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      if (sh_type == elfcpp::SHT_REL || sh_type == elfcpp::SHT_RELA)
+	total_size += shdr.get_sh_size();
+    }
+  if (total_size < 2 * relocate_range_size)
+    return NULL;
+
+  unsigned int range_count = std::min(static_cast<off_t>(max_relocate_ranges),
+				      total_size / relocate_range_size);
+  off_t range_size = total_size / range_count;
+
+  Relocate_ranges::Ranges ranges;
+  ranges.reserve(range_count);
+  unsigned int first_shndx = 1;
+  off_t size_so_far = 0;
+  p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      if (sh_type != elfcpp::SHT_REL && sh_type != elfcpp::SHT_RELA)
+	continue;
+      size_so_far += shdr.get_sh_size();
+      if (ranges.size() + 1 < range_count
+	  && size_so_far >= static_cast<off_t>(ranges.size() + 1) * range_size)
+	{
+	  ranges.push_back(std::make_pair(first_shndx, i + 1));
+	  first_shndx = i + 1;
+	}
+    }
+  ranges.push_back(std::make_pair(first_shndx, shnum));
+  if (ranges.size() < 2)
+    return NULL;
+
+  // The file counts as locked while the helper tasks read it, even
+  // after we are done, and they serialize their access to it.
+  unsigned int helper_count = ranges.size() - 1;
+  Task_token* ranges_blocker = new Task_token(true);
+  ranges_blocker->add_blockers(helper_count);
+  gold_assert(this->relocate_ranges_ == NULL);
+  Relocate_ranges* relocate_ranges = new Relocate_ranges(ranges, pshdrs,
+							 ranges_blocker);
+  this->relocate_ranges_ = relocate_ranges;
+  this->relocate_views_.swap(*pviews);
+  File_read& file(this->input_file()->file());
+  file.set_share_lock(relocate_ranges->file_lock());
+
+  for (unsigned int i = 0; i < helper_count; ++i)
+    workqueue->queue_soon(new Relocate_range_task<size, big_endian>(
+			    symtab, layout, this, of, &this->relocate_views_,
+			    relocate_ranges));
+
+  unsigned int last_shndx;
+  while (relocate_ranges->claim(&first_shndx, &last_shndx))
+    this->relocate_section_range(symtab, layout, pshdrs, of,
+				 &this->relocate_views_, first_shndx,
+				 last_shndx);
+
+  return ranges_blocker;
+}
+
+// Relocate section data for the sections with indexes from
+// FIRST_SHNDX up to but not including LAST_SHNDX.  VIEWS points to
+// the section data as views in the output file.
 
 template<int size, bool big_endian>
 void
@@ -906,9 +1244,10 @@ Sized_relobj_file<size, big_endian>::do_relocate_sections(
     const Layout* layout,
     const unsigned char* pshdrs,
     Output_file* of,
-    Views* pviews)
+    Views* pviews,
+    unsigned int first_shndx,
+    unsigned int last_shndx)
 {
-  unsigned int shnum = this->shnum();
   Sized_target<size, big_endian>* target =
     parameters->sized_target<size, big_endian>();
 
@@ -920,8 +1259,8 @@ Sized_relobj_file<size, big_endian>::do_relocate_sections(
   relinfo.layout = layout;
   relinfo.object = this;
 
-  const unsigned char* p = pshdrs + This::shdr_size;
-  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+  const unsigned char* p = pshdrs + first_shndx * This::shdr_size;
+  for (unsigned int i = first_shndx; i < last_shndx; ++i, p += This::shdr_size)
     {
       typename This::Shdr shdr(p);
 
@@ -1160,12 +1499,17 @@ Sized_relobj_file<size, big_endian>::incremental_relocs_write_reltype(
 }
 
 // Create merge hash tables for the local symbols.  These are used to
-// speed up relocations.
+// speed up relocations.  Sort the merge mappings first, since the
+// relocations may be applied by several tasks.
 
 template<int size, bool big_endian>
 void
 Sized_relobj_file<size, big_endian>::initialize_input_to_output_maps()
 {
+  Object_merge_map* object_merge_map = this->merge_map();
+  if (object_merge_map != NULL)
+    object_merge_map->sort_input_merge_maps();
+
   const unsigned int loccount = this->local_symbol_count_;
   for (unsigned int i = 1; i < loccount; ++i)
     {
@@ -1692,34 +2036,66 @@ Sized_relobj_file<64, true>::do_scan_relocs(Symbol_table* symtab,
 
 #ifdef HAVE_TARGET_32_LITTLE
 template
-void
+Task_token*
 Sized_relobj_file<32, false>::do_relocate(const Symbol_table* symtab,
 					  const Layout* layout,
-					  Output_file* of);
+					  Output_file* of,
+					  Workqueue* workqueue);
+
+template
+void
+Sized_relobj_file<32, false>::do_finish_relocate(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    Output_file* of);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
 template
-void
+Task_token*
 Sized_relobj_file<32, true>::do_relocate(const Symbol_table* symtab,
 					 const Layout* layout,
-					 Output_file* of);
+					 Output_file* of,
+					 Workqueue* workqueue);
+
+template
+void
+Sized_relobj_file<32, true>::do_finish_relocate(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    Output_file* of);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
 template
-void
+Task_token*
 Sized_relobj_file<64, false>::do_relocate(const Symbol_table* symtab,
 					  const Layout* layout,
-					  Output_file* of);
+					  Output_file* of,
+					  Workqueue* workqueue);
+
+template
+void
+Sized_relobj_file<64, false>::do_finish_relocate(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    Output_file* of);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
 template
-void
+Task_token*
 Sized_relobj_file<64, true>::do_relocate(const Symbol_table* symtab,
 					 const Layout* layout,
-					 Output_file* of);
+					 Output_file* of,
+					 Workqueue* workqueue);
+
+template
+void
+Sized_relobj_file<64, true>::do_finish_relocate(
+    const Symbol_table* symtab,
+    const Layout* layout,
+    Output_file* of);
 #endif
 
 #ifdef HAVE_TARGET_32_LITTLE
@@ -1730,7 +2106,9 @@ Sized_relobj_file<32, false>::do_relocate_sections(
     const Layout* layout,
     const unsigned char* pshdrs,
     Output_file* of,
-    Views* pviews);
+    Views* pviews,
+    unsigned int first_shndx,
+    unsigned int last_shndx);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
@@ -1741,7 +2119,9 @@ Sized_relobj_file<32, true>::do_relocate_sections(
     const Layout* layout,
     const unsigned char* pshdrs,
     Output_file* of,
-    Views* pviews);
+    Views* pviews,
+    unsigned int first_shndx,
+    unsigned int last_shndx);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
@@ -1752,7 +2132,9 @@ Sized_relobj_file<64, false>::do_relocate_sections(
     const Layout* layout,
     const unsigned char* pshdrs,
     Output_file* of,
-    Views* pviews);
+    Views* pviews,
+    unsigned int first_shndx,
+    unsigned int last_shndx);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
@@ -1763,7 +2145,9 @@ Sized_relobj_file<64, true>::do_relocate_sections(
     const Layout* layout,
     const unsigned char* pshdrs,
     Output_file* of,
-    Views* pviews);
+    Views* pviews,
+    unsigned int first_shndx,
+    unsigned int last_shndx);
 #endif
 
 #ifdef HAVE_TARGET_32_LITTLE
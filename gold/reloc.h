@@ -214,6 +214,51 @@ class Relocate_task : public Task
   Task_token* final_blocker_;
 };
 
+// Finish relocating an object whose sections were relocated by
+// several tasks.  This runs once they are all done, and holds the
+// blockers of the Relocate_task in its place.
+
+class Relocate_finish_task : public Task
+{
+ public:
+  Relocate_finish_task(const Symbol_table* symtab, const Layout* layout,
+		       Relobj* object, Output_file* of,
+		       Task_token* this_blocker,
+		       Task_token* input_sections_blocker,
+		       Task_token* final_blocker)
+    : symtab_(symtab), layout_(layout), object_(object), of_(of),
+      this_blocker_(this_blocker),
+      input_sections_blocker_(input_sections_blocker),
+      final_blocker_(final_blocker)
+  { }
+
+  ~Relocate_finish_task()
+  { delete this->this_blocker_; }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const;
+
+ private:
+  const Symbol_table* symtab_;
+  const Layout* layout_;
+  Relobj* object_;
+  Output_file* of_;
+  Task_token* this_blocker_;
+  Task_token* input_sections_blocker_;
+  Task_token* final_blocker_;
+};
+
 // During a relocatable link, this class records how relocations
 // should be handled for a single input reloc section.  An instance of
 // this class is created while scanning relocs, and it is used while
@@ -577,13 +577,12 @@ class Sections_element
   finalize_symbols(Symbol_table*, const Layout*, uint64_t*)
   { }
 
-  // Return the output section name to use for an input file name and
-  // section name.  This only real implementation is in
+  // Add any input section specifications to the section name
+  // matcher.  The only real implementation is in
   // Output_section_definition.
-  virtual const char*
-  output_section_name(const char*, const char*, Output_section***,
-		      Script_sections::Section_type*, bool*)
-  { return NULL; }
+  virtual void
+  add_to_matcher(Input_section_matcher*)
+  { }
 
   // Initialize OSP with an output section.
   virtual void
@@ -803,6 +802,13 @@ class Output_section_element
   match_name(const char*, const char*, bool *) const
   { return false; }
 
+  // Add this element to the section name matcher, as part of the
+  // output section definition.  The only real implementation is in
+  // Output_section_element_input.
+  virtual void
+  add_to_matcher(Input_section_matcher*, Output_section_definition*) const
+  { }
+
   // Set section addresses.  This includes applying assignments if the
   // expression is an absolute value.
   virtual void
@@ -1222,6 +1228,297 @@ class Output_section_element_fill : public Output_section_element
   Expression* val_;
 };
 
+// A compiled wildcard pattern from a linker script.  Input section
+// specifications are matched against every input section, so rather
+// than calling fnmatch each time we classify the pattern once.  A
+// pattern with no wildcard characters is compared with strcmp, and
+// the common forms "PREFIX*" and "*SUFFIX" are compared directly.
+// Other patterns are compiled into a list of tokens.  We leave
+// anything unusual--backslash escapes, character ranges and classes,
+// unterminated brackets, or a non-ASCII string--to fnmatch, which
+// knows about the locale.
+
+class Glob_pattern
+{
+ public:
+  Glob_pattern(const std::string& pattern);
+
+  // Return the source pattern.
+  const std::string&
+  pattern() const
+  { return this->pattern_; }
+
+  // Return the characters which must start every string that this
+  // pattern matches.
+  const std::string&
+  prefix() const
+  { return this->prefix_; }
+
+  // Return whether S matches this pattern.
+  bool
+  match(const char* s) const
+  {
+    switch (this->kind_)
+      {
+      case GLOB_LITERAL:
+	return strcmp(s, this->pattern_.c_str()) == 0;
+      case GLOB_PREFIX:
+	if (strncmp(s, this->prefix_.data(), this->prefix_.length()) != 0)
+	  return false;
+	return (is_ascii(s + this->prefix_.length())
+		|| fnmatch(this->pattern_.c_str(), s, 0) == 0);
+      default:
+	return this->match_slow(s);
+      }
+  }
+
+ private:
+  // The ways we know how to match a pattern.
+  enum Kind
+  {
+    // No wildcard characters.
+    GLOB_LITERAL,
+    // A literal string followed by a single '*'.
+    GLOB_PREFIX,
+    // A single '*' followed by a literal string.
+    GLOB_SUFFIX,
+    // A list of tokens.
+    GLOB_TOKENS,
+    // Call fnmatch.
+    GLOB_FNMATCH
+  };
+
+  // A single element of a compiled pattern.
+  struct Token
+  {
+    enum Token_kind
+    {
+      // Match C.
+      TOKEN_CHAR,
+      // '?': match any character.
+      TOKEN_ANY,
+      // '[...]': match a character in SET, or not in SET if NEGATE.
+      TOKEN_SET,
+      // '*': match any string.
+      TOKEN_STAR
+    };
+
+    Token_kind kind;
+    char c;
+    bool negate;
+    std::string set;
+
+    Token(Token_kind kinda, char ca)
+      : kind(kinda), c(ca), negate(false), set()
+    { }
+  };
+
+  // Return whether S contains only ASCII characters.
+  static bool
+  is_ascii(const char* s)
+  {
+    for (; *s != '\0'; ++s)
+      if ((*s & 0x80) != 0)
+	return false;
+    return true;
+  }
+
+  // Compile the pattern into tokens_.  Return false if we need to
+  // use fnmatch.
+  bool
+  compile();
+
+  // Match a pattern which is not a literal or a prefix.
+  bool
+  match_slow(const char* s) const;
+
+  // Match S against tokens_.
+  bool
+  match_tokens(const char* s) const;
+
+  // The source pattern.
+  std::string pattern_;
+  // How to match it.
+  Kind kind_;
+  // The literal prefix of the pattern.
+  std::string prefix_;
+  // The literal suffix, for GLOB_SUFFIX.
+  std::string suffix_;
+  // The compiled pattern, for GLOB_TOKENS.
+  std::vector<Token> tokens_;
+};
+
+Glob_pattern::Glob_pattern(const std::string& pattern)
+  : pattern_(pattern), kind_(GLOB_LITERAL), prefix_(), suffix_(), tokens_()
+{
+  const char* p = this->pattern_.c_str();
+  if (!is_wildcard_string(p))
+    {
+      this->prefix_ = this->pattern_;
+      return;
+    }
+
+  size_t len = strcspn(p, "?*[\\");
+  this->prefix_.assign(p, len);
+
+  if (p[len] == '*' && p[len + 1] == '\0')
+    this->kind_ = GLOB_PREFIX;
+  else if (len == 0
+	   && p[0] == '*'
+	   && strpbrk(p + 1, "?*[\\") == NULL)
+    {
+      this->kind_ = GLOB_SUFFIX;
+      this->suffix_.assign(p + 1);
+    }
+  else if (this->compile())
+    this->kind_ = GLOB_TOKENS;
+  else
+    this->kind_ = GLOB_FNMATCH;
+}
+
+// Compile the pattern into a list of tokens.
+
+bool
+Glob_pattern::compile()
+{
+  const char* p = this->pattern_.c_str();
+  while (*p != '\0')
+    {
+      switch (*p)
+	{
+	case '\\':
+	  return false;
+
+	case '*':
+	  // Consecutive stars are the same as one.
+	  if (this->tokens_.empty()
+	      || this->tokens_.back().kind != Token::TOKEN_STAR)
+	    this->tokens_.push_back(Token(Token::TOKEN_STAR, '\0'));
+	  ++p;
+	  break;
+
+	case '?':
+	  this->tokens_.push_back(Token(Token::TOKEN_ANY, '\0'));
+	  ++p;
+	  break;
+
+	case '[':
+	  {
+	    Token t(Token::TOKEN_SET, '\0');
+	    ++p;
+	    if (*p == '!' || *p == '^')
+	      {
+		t.negate = true;
+		++p;
+	      }
+	    // A ']' at the start of the set is an ordinary character.
+	    if (*p == ']')
+	      {
+		t.set.push_back(']');
+		++p;
+	      }
+	    while (*p != ']')
+	      {
+		if (*p == '\0' || *p == '\\')
+		  return false;
+		if (*p == '[' && (p[1] == ':' || p[1] == '=' || p[1] == '.'))
+		  return false;
+		if (*p == '-' && !t.set.empty() && p[1] != ']')
+		  return false;
+		t.set.push_back(*p);
+		++p;
+	      }
+	    ++p;
+	    this->tokens_.push_back(t);
+	  }
+	  break;
+
+	default:
+	  this->tokens_.push_back(Token(Token::TOKEN_CHAR, *p));
+	  ++p;
+	  break;
+	}
+    }
+  return true;
+}
+
+// Match a pattern which is not a literal or a prefix.
+
+bool
+Glob_pattern::match_slow(const char* s) const
+{
+  if (this->kind_ == GLOB_FNMATCH || !is_ascii(s))
+    return fnmatch(this->pattern_.c_str(), s, 0) == 0;
+
+  if (this->kind_ == GLOB_SUFFIX)
+    {
+      size_t len = strlen(s);
+      size_t suffix_len = this->suffix_.length();
+      return (len >= suffix_len
+	      && memcmp(s + len - suffix_len, this->suffix_.data(),
+			suffix_len) == 0);
+    }
+
+  gold_assert(this->kind_ == GLOB_TOKENS);
+  return this->match_tokens(s);
+}
+
+// Match S against the compiled tokens.  When a token fails to match,
+// we let the most recent '*' absorb one more character and try
+// again; earlier stars never need to be revisited.
+
+bool
+Glob_pattern::match_tokens(const char* s) const
+{
+  const size_t count = this->tokens_.size();
+  size_t i = 0;
+  size_t star_next = count;
+  const char* star_s = NULL;
+  while (*s != '\0')
+    {
+      if (i < count)
+	{
+	  const Token& t(this->tokens_[i]);
+	  bool matched;
+	  switch (t.kind)
+	    {
+	    case Token::TOKEN_STAR:
+	      star_next = i + 1;
+	      star_s = s;
+	      ++i;
+	      continue;
+	    case Token::TOKEN_CHAR:
+	      matched = *s == t.c;
+	      break;
+	    case Token::TOKEN_ANY:
+	      matched = true;
+	      break;
+	    case Token::TOKEN_SET:
+	      matched = (t.set.find(*s) != std::string::npos) != t.negate;
+	      break;
+	    default:
+	      gold_unreachable();
+	    }
+	  if (matched)
+	    {
+	      ++i;
+	      ++s;
+	      continue;
+	    }
+	}
+
+      if (star_s == NULL)
+	return false;
+      i = star_next;
+      ++star_s;
+      s = star_s;
+    }
+
+  while (i < count && this->tokens_[i].kind == Token::TOKEN_STAR)
+    ++i;
+  return i == count;
+}
+
 // An input section specification in an output section
 
 class Output_section_element_input : public Output_section_element
@@ -1250,6 +1547,20 @@ class Output_section_element_input : public Output_section_element
 			Output_section**, std::string* fill,
 			Input_section_list*);
 
+  // Add this element to the section name matcher.
+  void
+  add_to_matcher(Input_section_matcher*, Output_section_definition*) const;
+
+  // See if we match a file name.
+  bool
+  match_file_name(const char* file_name) const;
+
+  // Return whether matching sections should be kept when garbage
+  // collecting.
+  bool
+  keep() const
+  { return this->keep_; }
+
   // Print for debugging.
   void
   print(FILE* f) const;
@@ -1258,43 +1569,24 @@ class Output_section_element_input : public Output_section_element
   // An input section pattern.
   struct Input_section_pattern
   {
-    std::string pattern;
-    bool pattern_is_wildcard;
+    Glob_pattern pattern;
     Sort_wildcard sort;
 
     Input_section_pattern(const char* patterna, size_t patternlena,
 			  Sort_wildcard sorta)
-      : pattern(patterna, patternlena),
-	pattern_is_wildcard(is_wildcard_string(this->pattern.c_str())),
+      : pattern(std::string(patterna, patternlena)),
 	sort(sorta)
     { }
   };
 
   typedef std::vector<Input_section_pattern> Input_section_patterns;
 
-  // Filename_exclusions is a pair of filename pattern and a bool
-  // indicating whether the filename is a wildcard.
-  typedef std::vector<std::pair<std::string, bool> > Filename_exclusions;
-
-  // Return whether STRING matches PATTERN, where IS_WILDCARD_PATTERN
-  // indicates whether this is a wildcard pattern.
-  static inline bool
-  match(const char* string, const char* pattern, bool is_wildcard_pattern)
-  {
-    return (is_wildcard_pattern
-	    ? fnmatch(pattern, string, 0) == 0
-	    : strcmp(string, pattern) == 0);
-  }
-
-  // See if we match a file name.
-  bool
-  match_file_name(const char* file_name) const;
+  // The list of file name patterns to exclude.
+  typedef std::vector<Glob_pattern> Filename_exclusions;
 
   // The file name pattern.  If this is the empty string, we match all
   // files.
-  std::string filename_pattern_;
-  // Whether the file name pattern is a wildcard.
-  bool filename_is_wildcard_;
+  Glob_pattern filename_pattern_;
   // How the file names should be sorted.  This may only be
   // SORT_WILDCARD_NONE or SORT_WILDCARD_BY_NAME.
   Sort_wildcard filename_sort_;
@@ -1318,8 +1610,7 @@ class Output_section_element_input : public Output_section_element
 Output_section_element_input::Output_section_element_input(
     const Input_section_spec* spec,
     bool keep)
-  : filename_pattern_(),
-    filename_is_wildcard_(false),
+  : filename_pattern_(std::string()),
     filename_sort_(spec->file.sort),
     filename_exclusions_(),
     input_section_patterns_(),
@@ -1330,9 +1621,8 @@ Output_section_element_input::Output_section_element_input(
   // The filename pattern "*" is common, and matches all files.  Turn
   // it into the empty string.
   if (spec->file.name.length != 1 || spec->file.name.value[0] != '*')
-    this->filename_pattern_.assign(spec->file.name.value,
-				   spec->file.name.length);
-  this->filename_is_wildcard_ = is_wildcard_string(this->filename_pattern_.c_str());
+    this->filename_pattern_ = Glob_pattern(std::string(spec->file.name.value,
+						       spec->file.name.length));
 
   if (spec->input_sections.exclude != NULL)
     {
@@ -1340,11 +1630,7 @@ Output_section_element_input::Output_section_element_input(
 	     spec->input_sections.exclude->begin();
 	   p != spec->input_sections.exclude->end();
 	   ++p)
-	{
-	  bool is_wildcard = is_wildcard_string((*p).c_str());
-	  this->filename_exclusions_.push_back(std::make_pair(*p,
-							      is_wildcard));
-	}
+	this->filename_exclusions_.push_back(Glob_pattern(*p));
     }
 
   if (spec->input_sections.sections != NULL)
@@ -1364,15 +1650,14 @@ Output_section_element_input::Output_section_element_input(
 bool
 Output_section_element_input::match_file_name(const char* file_name) const
 {
-  if (!this->filename_pattern_.empty())
+  if (!this->filename_pattern_.pattern().empty())
     {
       // If we were called with no filename, we refuse to match a
       // pattern which requires a file name.
       if (file_name == NULL)
 	return false;
 
-      if (!match(file_name, this->filename_pattern_.c_str(),
-		 this->filename_is_wildcard_))
+      if (!this->filename_pattern_.match(file_name))
 	return false;
     }
 
@@ -1385,7 +1670,7 @@ Output_section_element_input::match_file_name(const char* file_name) const
 	   p != this->filename_exclusions_.end();
 	   ++p)
 	{
-	  if (match(file_name, p->first.c_str(), p->second))
+	  if (p->match(file_name))
 	    return false;
 	}
     }
@@ -1416,7 +1701,7 @@ Output_section_element_input::match_name(const char* file_name,
        p != this->input_section_patterns_.end();
        ++p)
     {
-      if (match(section_name, p->pattern.c_str(), p->pattern_is_wildcard))
+      if (p->pattern.match(section_name))
 	return true;
     }
 
@@ -1611,8 +1896,7 @@ Output_section_element_input::set_section_addresses(
 	    {
 	      const Input_section_pattern&
 		isp(this->input_section_patterns_[i]);
-	      if (match(isi.section_name().c_str(), isp.pattern.c_str(),
-			isp.pattern_is_wildcard))
+	      if (isp.pattern.match(isi.section_name().c_str()))
 		break;
 	    }
 
@@ -1705,7 +1989,7 @@ Output_section_element_input::print(FILE* f) const
   if (this->keep_)
     fprintf(f, "KEEP(");
 
-  if (!this->filename_pattern_.empty())
+  if (!this->filename_pattern_.pattern().empty())
     {
       bool need_close_paren = false;
       switch (this->filename_sort_)
@@ -1720,7 +2004,7 @@ Output_section_element_input::print(FILE* f) const
 	  gold_unreachable();
 	}
 
-      fprintf(f, "%s", this->filename_pattern_.c_str());
+      fprintf(f, "%s", this->filename_pattern_.pattern().c_str());
 
       if (need_close_paren)
 	fprintf(f, ")");
@@ -1743,7 +2027,7 @@ Output_section_element_input::print(FILE* f) const
 	    {
 	      if (need_comma)
 		fprintf(f, ", ");
-	      fprintf(f, "%s", p->first.c_str());
+	      fprintf(f, "%s", p->pattern().c_str());
 	      need_comma = true;
 	    }
 	  fprintf(f, ")");
@@ -1783,7 +2067,7 @@ Output_section_element_input::print(FILE* f) const
 	      gold_unreachable();
 	    }
 
-	  fprintf(f, "%s", p->pattern.c_str());
+	  fprintf(f, "%s", p->pattern.pattern().c_str());
 
 	  for (int i = 0; i < close_parens; ++i)
 	    fprintf(f, ")");
@@ -1861,12 +2145,22 @@ class Output_section_definition : public Sections_element
   void
   finalize_symbols(Symbol_table*, const Layout*, uint64_t*);
 
-  // Return the output section name to use for an input file name and
-  // section name.
+  // Add our input section specifications to the section name
+  // matcher.
+  void
+  add_to_matcher(Input_section_matcher*);
+
+  // Return the output section name to use for an input section which
+  // matched one of our input section specifications, and set *SLOT
+  // and *PSECTION_TYPE.
   const char*
-  output_section_name(const char* file_name, const char* section_name,
-		      Output_section***, Script_sections::Section_type*,
-		      bool*);
+  matched_output_section_name(Output_section*** slot,
+			      Script_sections::Section_type* psection_type)
+  {
+    *slot = &this->output_section_;
+    *psection_type = this->section_type();
+    return this->name_.c_str();
+  }
 
   // Initialize OSP with an output section.
   void
@@ -2144,33 +2438,16 @@ Output_section_definition::finalize_symbols(Symbol_table* symtab,
     (*p)->finalize_symbols(symtab, layout, dot_value, &dot_section);
 }
 
-// Return the output section name to use for an input section name.
+// Add our input section specifications to the section name matcher,
+// in order.
 
-const char*
-Output_section_definition::output_section_name(
-    const char* file_name,
-    const char* section_name,
-    Output_section*** slot,
-    Script_sections::Section_type* psection_type,
-    bool* keep)
+void
+Output_section_definition::add_to_matcher(Input_section_matcher* matcher)
 {
-  // Ask each element whether it matches NAME.
   for (Output_section_elements::const_iterator p = this->elements_.begin();
        p != this->elements_.end();
        ++p)
-    {
-      if ((*p)->match_name(file_name, section_name, keep))
-	{
-	  // We found a match for NAME, which means that it should go
-	  // into this output section.
-	  *slot = &this->output_section_;
-	  *psection_type = this->section_type();
-	  return this->name_.c_str();
-	}
-    }
-
-  // We don't know about this section name.
-  return NULL;
+    (*p)->add_to_matcher(matcher, this);
 }
 
 // Return true if memory from START to START + LENGTH is contained
@@ -3161,6 +3438,314 @@ Script_sections::set_memory_region(Memory_region* mr, bool set_vma)
   this->sections_elements_->back()->set_memory_region(mr, set_vma);
 }
 
+// Input_section_matcher maps an input file name and section name to
+// an output section as specified by the SECTIONS clause.  It is built
+// the first time it is needed, from all the input section
+// specifications in script order.  The first specification which
+// matches wins, as it would if we asked each output section
+// definition in turn.  To avoid trying every specification, we put
+// the literal prefix of each section name pattern into a trie; only
+// the specifications we find while walking a section name down the
+// trie can match it.  Many input sections share the same name, and
+// with garbage collection each input section is looked up twice, so
+// we also remember the result for each name.  When the script has
+// file name patterns, the file name is part of the key.  We only look
+// up names while laying out input sections, which happens one object
+// at a time, so we don't need a lock.
+
+class Input_section_matcher
+{
+ public:
+  Input_section_matcher(Script_sections::Sections_elements*);
+
+  // Record that input section specification INPUT in output section
+  // definition POSD may match a section name starting with any of
+  // PREFIXES.
+  void
+  add(Output_section_definition* posd,
+      const Output_section_element_input* input, bool uses_file_name,
+      const std::vector<std::string>& prefixes);
+
+  // Implement Script_sections::output_section_name.
+  const char*
+  output_section_name(const char* file_name, const char* section_name,
+		      Output_section*** output_section_slot,
+		      Script_sections::Section_type* psection_type,
+		      bool* keep);
+
+ private:
+  // An input section specification.
+  struct Entry
+  {
+    Output_section_definition* posd;
+    const Output_section_element_input* input;
+
+    Entry(Output_section_definition* posda,
+	  const Output_section_element_input* inputa)
+      : posd(posda), input(inputa)
+    { }
+  };
+
+  // A node in the trie of section name prefixes.
+  struct Prefix_node
+  {
+    // The indexes into entries_ of the specifications with a pattern
+    // whose literal prefix ends at this node.
+    std::vector<unsigned int> entries;
+    // The children of this node, as pairs of the next character and
+    // an index into nodes_.
+    std::vector<std::pair<char, unsigned int> > children;
+  };
+
+  // The result of a lookup.
+  struct Result
+  {
+    // The output section name, NULL for /DISCARD/.
+    const char* name;
+    // The output section slot.
+    Output_section** slot;
+    // The section type specified in the script.
+    Script_sections::Section_type section_type;
+    // Whether a specification matched.
+    bool matched;
+    // Whether we set *KEEP, and what we set it to.
+    bool set_keep;
+    bool keep;
+  };
+
+  // A lookup key: a file name, which is NULL if the script does not
+  // care about file names, and a section name, both taken from
+  // names_.
+  typedef std::pair<const char*, const char*> Name_key;
+
+  struct Name_key_hash
+  {
+    size_t
+    operator()(const Name_key& k) const
+    {
+      return (reinterpret_cast<uintptr_t>(k.first) * 31
+	      ^ reinterpret_cast<uintptr_t>(k.second));
+    }
+  };
+
+  typedef Unordered_map<Name_key, Result, Name_key_hash> Result_map;
+
+  // Find the output section for a name we have not seen before.
+  void
+  lookup(const char* file_name, const char* section_name, Result*);
+
+  // The input section specifications in script order.
+  std::vector<Entry> entries_;
+  // The trie of section name prefixes.  The first node is the root.
+  std::vector<Prefix_node> nodes_;
+  // Whether any specification has a file name pattern.
+  bool uses_file_names_;
+  // Copies of the names we have seen.
+  Stringpool names_;
+  // The result for each name we have seen.
+  Result_map results_;
+  // The candidate entries for a lookup, kept here to avoid
+  // reallocating.
+  std::vector<unsigned int> candidates_;
+};
+
+Input_section_matcher::Input_section_matcher(
+    Script_sections::Sections_elements* sections_elements)
+  : entries_(), nodes_(1), uses_file_names_(false), names_(), results_(),
+    candidates_()
+{
+  for (Script_sections::Sections_elements::const_iterator p =
+	 sections_elements->begin();
+       p != sections_elements->end();
+       ++p)
+    (*p)->add_to_matcher(this);
+}
+
+// Add an input section specification.
+
+void
+Input_section_matcher::add(Output_section_definition* posd,
+			   const Output_section_element_input* input,
+			   bool uses_file_name,
+			   const std::vector<std::string>& prefixes)
+{
+  unsigned int index = this->entries_.size();
+  this->entries_.push_back(Entry(posd, input));
+  if (uses_file_name)
+    this->uses_file_names_ = true;
+
+  for (std::vector<std::string>::const_iterator p = prefixes.begin();
+       p != prefixes.end();
+       ++p)
+    {
+      unsigned int node = 0;
+      for (std::string::const_iterator c = p->begin(); c != p->end(); ++c)
+	{
+	  std::vector<std::pair<char, unsigned int> >&
+	    children(this->nodes_[node].children);
+	  std::vector<std::pair<char, unsigned int> >::const_iterator q;
+	  for (q = children.begin(); q != children.end(); ++q)
+	    if (q->first == *c)
+	      break;
+	  if (q != children.end())
+	    node = q->second;
+	  else
+	    {
+	      unsigned int child = this->nodes_.size();
+	      children.push_back(std::make_pair(*c, child));
+	      // This may invalidate CHILDREN.
+	      this->nodes_.push_back(Prefix_node());
+	      node = child;
+	    }
+	}
+
+      // Two patterns may have the same prefix.
+      std::vector<unsigned int>& entries(this->nodes_[node].entries);
+      if (entries.empty() || entries.back() != index)
+	entries.push_back(index);
+    }
+}
+
+// Find the output section for FILE_NAME and SECTION_NAME.
+
+void
+Input_section_matcher::lookup(const char* file_name,
+			      const char* section_name,
+			      Result* result)
+{
+  result->name = NULL;
+  result->slot = NULL;
+  result->section_type = Script_sections::ST_NONE;
+  result->matched = false;
+  result->set_keep = false;
+  result->keep = false;
+
+  // Collect the specifications whose prefixes match, and try them in
+  // script order.
+  std::vector<unsigned int>& candidates(this->candidates_);
+  candidates.clear();
+  unsigned int node = 0;
+  const char* pc = section_name;
+  while (true)
+    {
+      const Prefix_node& n(this->nodes_[node]);
+      candidates.insert(candidates.end(), n.entries.begin(), n.entries.end());
+      if (*pc == '\0')
+	break;
+      std::vector<std::pair<char, unsigned int> >::const_iterator q;
+      for (q = n.children.begin(); q != n.children.end(); ++q)
+	if (q->first == *pc)
+	  break;
+      if (q == n.children.end())
+	break;
+      node = q->second;
+      ++pc;
+    }
+  std::sort(candidates.begin(), candidates.end());
+
+  for (std::vector<unsigned int>::const_iterator p = candidates.begin();
+       p != candidates.end();
+       ++p)
+    {
+      const Entry& e(this->entries_[*p]);
+      bool keep;
+      if (e.input->match_name(file_name, section_name, &keep))
+	{
+	  result->name = e.posd->matched_output_section_name(&result->slot,
+							     &result->section_type);
+	  result->matched = true;
+	  result->set_keep = true;
+	  result->keep = keep;
+	  return;
+	}
+    }
+
+  // Nothing matched.  Checking each specification in turn would have
+  // set *KEEP from the last one whose file name pattern matched.
+  for (std::vector<Entry>::const_reverse_iterator p = this->entries_.rbegin();
+       p != this->entries_.rend();
+       ++p)
+    {
+      if (p->input->match_file_name(file_name))
+	{
+	  result->set_keep = true;
+	  result->keep = p->input->keep();
+	  return;
+	}
+    }
+}
+
+// Return the name of the output section to use for FILE_NAME and
+// SECTION_NAME.
+
+const char*
+Input_section_matcher::output_section_name(
+    const char* file_name,
+    const char* section_name,
+    Output_section*** output_section_slot,
+    Script_sections::Section_type* psection_type,
+    bool* keep)
+{
+  // If there are no file name patterns, every file name other than
+  // NULL gets the same result.
+  if (file_name != NULL)
+    file_name = (this->uses_file_names_
+		 ? this->names_.add(file_name, true, NULL)
+		 : "");
+  Name_key key(file_name, this->names_.add(section_name, true, NULL));
+  std::pair<Result_map::iterator, bool> ins =
+    this->results_.insert(std::make_pair(key, Result()));
+  Result* result = &ins.first->second;
+  if (ins.second)
+    this->lookup(key.first, key.second, result);
+
+  if (result->set_keep)
+    *keep = result->keep;
+
+  if (!result->matched)
+    {
+      // If we couldn't find a mapping for the name, the output
+      // section gets the name of the input section.
+      *output_section_slot = NULL;
+      *psection_type = Script_sections::ST_NONE;
+      return section_name;
+    }
+
+  // The special name /DISCARD/ means that the input section should
+  // be discarded.
+  if (strcmp(result->name, "/DISCARD/") == 0)
+    {
+      *output_section_slot = NULL;
+      *psection_type = Script_sections::ST_NONE;
+      return NULL;
+    }
+
+  *output_section_slot = result->slot;
+  *psection_type = result->section_type;
+  return result->name;
+}
+
+// Add this input section specification to the section name matcher.
+
+void
+Output_section_element_input::add_to_matcher(
+    Input_section_matcher* matcher,
+    Output_section_definition* posd) const
+{
+  bool uses_file_name = (!this->filename_pattern_.pattern().empty()
+			 || !this->filename_exclusions_.empty());
+  std::vector<std::string> prefixes;
+  // If there are no section name patterns, we match every section.
+  if (this->input_section_patterns_.empty())
+    prefixes.push_back(std::string());
+  for (Input_section_patterns::const_iterator p =
+	 this->input_section_patterns_.begin();
+       p != this->input_section_patterns_.end();
+       ++p)
+    prefixes.push_back(p->pattern.prefix());
+  matcher->add(posd, this, uses_file_name, prefixes);
+}
+
 // Class Script_sections.
 
 Script_sections::Script_sections()
@@ -3174,7 +3759,8 @@ Script_sections::Script_sections()
     data_segment_align_start_(),
     saw_data_segment_align_(false),
     saw_relro_end_(false),
-    saw_segment_start_expression_(false)
+    saw_segment_start_expression_(false),
+    matcher_(NULL)
 {
 }
 
@@ -3309,6 +3895,13 @@ Script_sections::add_input_section(const Input_section_spec* spec, bool keep)
 {
   gold_assert(this->output_section_ != NULL);
   this->output_section_->add_input_section(spec, keep);
+
+  // Rebuild the section name matcher if it has already been used.
+  if (this->matcher_ != NULL)
+    {
+      delete this->matcher_;
+      this->matcher_ = NULL;
+    }
 }
 
 // This is called when we see DATA_SEGMENT_ALIGN.  It means that any
@@ -3398,35 +3991,11 @@ Script_sections::output_section_name(
     Script_sections::Section_type* psection_type,
     bool* keep)
 {
-  for (Sections_elements::const_iterator p = this->sections_elements_->begin();
-       p != this->sections_elements_->end();
-       ++p)
-    {
-      const char* ret = (*p)->output_section_name(file_name, section_name,
-						  output_section_slot,
-						  psection_type, keep);
-
-      if (ret != NULL)
-	{
-	  // The special name /DISCARD/ means that the input section
-	  // should be discarded.
-	  if (strcmp(ret, "/DISCARD/") == 0)
-	    {
-	      *output_section_slot = NULL;
-	      *psection_type = Script_sections::ST_NONE;
-	      return NULL;
-	    }
-	  return ret;
-	}
-    }
-
-  // If we couldn't find a mapping for the name, the output section
-  // gets the name of the input section.
-
-  *output_section_slot = NULL;
-  *psection_type = Script_sections::ST_NONE;
-
-  return section_name;
+  if (this->matcher_ == NULL)
+    this->matcher_ = new Input_section_matcher(this->sections_elements_);
+  return this->matcher_->output_section_name(file_name, section_name,
+					     output_section_slot,
+					     psection_type, keep);
 }
 
 // Place a marker for an orphan output section into the SECTIONS
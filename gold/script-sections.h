@@ -44,6 +44,7 @@ class Output_section_definition;
 class Output_section;
 class Output_segment;
 class Orphan_section_placement;
+class Input_section_matcher;
 
 class Script_sections
 {
@@ -319,6 +320,8 @@ class Script_sections
   bool saw_relro_end_;
   // Whether we have seen SEGMENT_START.
   bool saw_segment_start_expression_;
+  // Maps input sections to output sections; built when first needed.
+  Input_section_matcher* matcher_;
 };
 
 // Attributes for memory regions.
@@ -1476,10 +1476,12 @@ read_input_script(Workqueue* workqueue, Symbol_table* symtab, Layout* layout,
     {
       const std::string& filename = input_file->filename();
       Timespec mtime = input_file->file().get_mtime();
+      unsigned char digest[file_digest_size];
+      input_file->file().get_digest(digest);
       unsigned int arg_serial = input_argument->file().arg_serial();
       script_info = new Script_info(filename);
       layout->incremental_inputs()->report_script(script_info, arg_serial,
-						  mtime);
+						  mtime, digest);
     }
 
   Parser_closure closure(input_file->filename().c_str(),
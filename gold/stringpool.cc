@@ -24,6 +24,7 @@
 
 #include <cstring>
 #include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "output.h"
@@ -240,6 +241,19 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 						      size_t length,
 						      bool copy,
 						      Key* pkey)
+{
+  return this->add_prehashed(s, length, string_hash(s, length), copy, pkey);
+}
+
+// Add a string whose hash code has already been computed.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_prehashed(const Stringpool_char* s,
+						    size_t length,
+						    size_t hash_code,
+						    bool copy,
+						    Key* pkey)
 {
   typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
 
@@ -251,7 +265,8 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
       // When we don't need to copy the string, we can call insert
       // directly.
 
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
+      std::pair<Hashkey, Hashval> element(Hashkey(s, length, hash_code),
+					  k);
 
       Insert_type ins = this->string_set_.insert(element);
 
@@ -275,10 +290,9 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 
   // When we have to copy the string, we look it up twice in the hash
   // table.  The problem is that we can't insert S before we
-  // canonicalize it by copying it into the canonical list. The hash
-  // code will only be computed once.
+  // canonicalize it by copying it into the canonical list.
 
-  Hashkey hk(s, length);
+  Hashkey hk(s, length, hash_code);
   typename String_set_type::const_iterator p = this->string_set_.find(hk);
   if (p != this->string_set_.end())
     {
@@ -336,8 +350,8 @@ Stringpool_template<Stringpool_char>::Stringpool_sort_comparison::operator()(
   const Stringpool_sort_info& sort_info1,
   const Stringpool_sort_info& sort_info2) const
 {
-  const Hashkey& h1(sort_info1->first);
-  const Hashkey& h2(sort_info2->first);
+  const Hashkey& h1(sort_info1.first);
+  const Hashkey& h2(sort_info2.first);
   const Stringpool_char* s1 = h1.string;
   const Stringpool_char* s2 = h2.string;
   const size_t len1 = h1.length;
@@ -353,6 +367,82 @@ Stringpool_template<Stringpool_char>::Stringpool_sort_comparison::operator()(
   return len1 > len2;
 }
 
+// Return the character of the string for SORT_INFO which is DEPTH
+// characters from the end.  Compare characters the way
+// Stringpool_sort_comparison does.
+
+template<typename Stringpool_char>
+inline long long
+Stringpool_template<Stringpool_char>::suffix_char(
+    const Stringpool_sort_info& sort_info,
+    size_t depth)
+{
+  const Hashkey& h(sort_info.first);
+  if (depth >= h.length)
+    return std::numeric_limits<long long>::min();
+  return h.string[h.length - 1 - depth];
+}
+
+// Sort the COUNT strings at V, which all end with the same DEPTH
+// characters, into suffix order.  This is a multikey quicksort: it
+// partitions the strings three ways on one character, so that each
+// character of a common suffix is examined once per string rather
+// than once per comparison.  That makes the sort fast enough to
+// always do for the main string tables.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::sort_by_suffix(Stringpool_sort_info* v,
+						     size_t count,
+						     size_t depth)
+{
+  while (count > 1)
+    {
+      if (count < 8)
+	{
+	  std::sort(v, v + count, Stringpool_sort_comparison());
+	  return;
+	}
+
+      long long c1 = suffix_char(v[0], depth);
+      long long c2 = suffix_char(v[count / 2], depth);
+      long long c3 = suffix_char(v[count - 1], depth);
+      long long pivot;
+      if (c1 < c2)
+	pivot = c2 < c3 ? c2 : (c1 < c3 ? c3 : c1);
+      else
+	pivot = c1 < c3 ? c1 : (c2 < c3 ? c3 : c2);
+
+      // Partition into characters greater than, equal to, and less
+      // than the pivot, in that order.
+      size_t gt = 0;
+      size_t lt = count;
+      size_t i = 0;
+      while (i < lt)
+	{
+	  long long c = suffix_char(v[i], depth);
+	  if (c > pivot)
+	    std::swap(v[gt++], v[i++]);
+	  else if (c < pivot)
+	    std::swap(v[i], v[--lt]);
+	  else
+	    ++i;
+	}
+
+      sort_by_suffix(v, gt, depth);
+      sort_by_suffix(v + lt, count - lt, depth);
+
+      // The strings are all different, so at most one of them can end
+      // here.
+      if (pivot == std::numeric_limits<long long>::min())
+	return;
+
+      v += gt;
+      count = lt - gt;
+      ++depth;
+    }
+}
+
 // Return whether s1 is a suffix of s2.
 
 template<typename Stringpool_char>
@@ -385,11 +475,10 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
   // Offset 0 may be reserved for the empty string.
   section_offset_type offset = this->zero_null_ ? charsize : 0;
 
-  // Sorting to find suffixes can take over 25% of the total CPU time
-  // used by the linker.  Since it's merely an optimization to reduce
-  // the strtab size, and gives a relatively small benefit (it's
-  // typically rare for a symbol to be a suffix of another), we only
-  // take the time to sort when the user asks for heavy optimization.
+  // Sorting to find suffixes is merely an optimization to reduce the
+  // strtab size.  It is done by default for the main string tables,
+  // and for everything else only when the user asks for heavy
+  // optimization.
   if (!this->optimize_)
     {
       // If we are not optimizing, the offsets are already assigned.
@@ -405,9 +494,10 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
       for (typename String_set_type::iterator p = this->string_set_.begin();
            p != this->string_set_.end();
            ++p)
-        v.push_back(Stringpool_sort_info(p));
+        v.push_back(Stringpool_sort_info(p->first, p->second));
 
-      std::sort(v.begin(), v.end(), Stringpool_sort_comparison());
+      if (!v.empty())
+	sort_by_suffix(&v[0], v.size(), 0);
 
       section_offset_type last_offset = -1;
       for (typename std::vector<Stringpool_sort_info>::iterator last = v.end(),
@@ -416,22 +506,22 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
            last = curr++)
         {
 	  section_offset_type this_offset;
-          if (this->zero_null_ && (*curr)->first.string[0] == 0)
+          if (this->zero_null_ && curr->first.string[0] == 0)
             this_offset = 0;
           else if (last != v.end()
-                   && is_suffix((*curr)->first.string,
-				(*curr)->first.length,
-                                (*last)->first.string,
-				(*last)->first.length))
+                   && is_suffix(curr->first.string,
+				curr->first.length,
+                                last->first.string,
+				last->first.length))
             this_offset = (last_offset
-			   + (((*last)->first.length - (*curr)->first.length)
+			   + ((last->first.length - curr->first.length)
 			      * charsize));
           else
             {
               this_offset = align_address(offset, this->addralign_);
-              offset = this_offset + ((*curr)->first.length + 1) * charsize;
+              offset = this_offset + (curr->first.length + 1) * charsize;
             }
-	  this->key_to_offset_[(*curr)->second - 1] = this_offset;
+	  this->key_to_offset_[curr->second - 1] = this_offset;
 	  last_offset = this_offset;
         }
     }
@@ -207,7 +207,8 @@ class Stringpool_template
   }
 
   // Indicate that this string pool should be optimized, even if not
-  // running with -O2.
+  // running with -O2.  The offsets of the strings are then not known
+  // until set_string_offsets is called.
   void
   set_optimize()
   { this->optimize_ = true; }
@@ -229,6 +230,20 @@ class Stringpool_template
   const Stringpool_char*
   add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
 
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is the value returned by hash_string for S.  This lets
+  // a caller compute the hash code ahead of time, e.g., in a task
+  // which runs in parallel with other tasks.
+  const Stringpool_char*
+  add_prehashed(const Stringpool_char* s, size_t len, size_t hash_code,
+		bool copy, Key* pkey);
+
+  // Return the hash code which the pool uses for string S of length
+  // LEN characters.
+  static size_t
+  hash_string(const Stringpool_char* s, size_t len)
+  { return string_hash(s, len); }
+
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
   // set *PKEY to the key.
@@ -353,6 +368,10 @@ class Stringpool_template
     Hashkey(const Stringpool_char* s, size_t len)
       : string(s), length(len), hash_code(string_hash(s, len))
     { }
+
+    Hashkey(const Stringpool_char* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
   };
 
   // Hash function.  This is trivial, since we have already computed
@@ -378,9 +397,11 @@ class Stringpool_template
   typedef Unordered_map<Hashkey, Hashval, Stringpool_hash,
 			Stringpool_eq> String_set_type;
 
-  // Comparison routine used when sorting into a string table.
+  // Comparison routine used when sorting into a string table.  We
+  // sort copies of the hash table entries, to avoid following a
+  // pointer to the entry whenever we look at a string.
 
-  typedef typename String_set_type::iterator Stringpool_sort_info;
+  typedef std::pair<Hashkey, Hashval> Stringpool_sort_info;
 
   struct Stringpool_sort_comparison
   {
@@ -388,6 +409,17 @@ class Stringpool_template
     operator()(const Stringpool_sort_info&, const Stringpool_sort_info&) const;
   };
 
+  // Return the character DEPTH characters from the end of a string,
+  // or a value less than any character if the string is not that
+  // long.
+  static long long
+  suffix_char(const Stringpool_sort_info&, size_t depth);
+
+  // Sort strings into the order given by Stringpool_sort_comparison,
+  // given that they all have the same last DEPTH characters.
+  static void
+  sort_by_suffix(Stringpool_sort_info*, size_t count, size_t depth);
+
   // Keys map to offsets via a Chunked_vector.  We only use the
   // offsets if we turn this into an string table section.
   typedef Chunked_vector<section_offset_type> Key_to_offset;
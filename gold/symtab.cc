@@ -80,6 +80,8 @@ Symbol::init_fields(const char* name, const char* version,
   this->undef_binding_set_ = false;
   this->undef_binding_weak_ = false;
   this->is_predefined_ = false;
+  this->gnu_hash_ = 0;
+  this->has_gnu_hash_ = false;
 }
 
 // Return the demangled version of the symbol's name, but only
@@ -1109,6 +1111,8 @@ Symbol_table::add_from_relobj(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const size_t* sym_name_hashes,
+    const uint32_t* sym_gnu_hashes,
     typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
     size_t* defined)
 {
@@ -1272,14 +1276,27 @@ Symbol_table::add_from_relobj(
         }
 
       Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
+      if (sym_name_hashes != NULL)
+	name = this->namepool_.add_prehashed(name, namelen,
+					     sym_name_hashes[i], true,
 					     &name_key);
+      else
+	name = this->namepool_.add_with_length(name, namelen, true,
+					       &name_key);
 
       Sized_symbol<size>* res;
       res = this->add_from_object(relobj, name, name_key, ver, ver_key,
 				  is_default_version, *psym, st_shndx,
 				  is_ordinary, orig_st_shndx);
-      
+
+      // The hash code is for NAME, and --wrap may have given RES a
+      // different name.  Names in the pool are unique, so comparing
+      // the pointers is enough.
+      if (sym_gnu_hashes != NULL
+	  && !res->has_gnu_hash()
+	  && res->name() == name)
+	res->set_gnu_hash(sym_gnu_hashes[i]);
+
       if (is_forced_local)
 	this->force_local(res);
 
@@ -3213,6 +3230,8 @@ Symbol_table::print_stats() const
 	  program_name, this->table_.size());
 #endif
   this->namepool_.print_stats("symbol table stringpool");
+  if (this->gc_ != NULL)
+    this->gc_->print_stats();
 }
 
 // We check for ODR violations by looking for symbols with the same
@@ -3250,30 +3269,276 @@ struct Odr_violation_compare
   }
 };
 
-// Returns all of the lines attached to LOC, not just the one the
-// instruction actually came from.
-std::vector<std::string>
-Symbol_table::linenos_from_loc(const Task* task,
-                               const Symbol_location& loc)
-{
-  // We need to lock the object in order to read it.  This
-  // means that we have to run in a singleton Task.  If we
-  // want to run this in a general Task for better
-  // performance, we will need one Task for object, plus
-  // appropriate locking to ensure that we don't conflict with
-  // other uses of the object.  Also note, one_addr2line is not
-  // currently thread-safe.
-  Task_lock_obj<Object> tl(task, loc.object);
-
-  std::vector<std::string> result;
-  Symbol_location code_loc = loc;
-  parameters->target().function_location(&code_loc);
-  // 16 is the size of the object-cache that one_addr2line should use.
-  std::string canonical_result = Dwarf_line_info::one_addr2line(
-      code_loc.object, code_loc.shndx, code_loc.offset, 16, &result);
-  if (!canonical_result.empty())
-    result.push_back(canonical_result);
-  return result;
+// A task which reads the line numbers for the ODR violation
+// candidates defined in one object.  The line information of the
+// object is read once, for all sections, and then used for each of
+// the locations.  Each location has its own result vector, so these
+// tasks may run in parallel.
+
+class Odr_lineno_task : public Task
+{
+ public:
+  typedef std::vector<std::pair<Symbol_location, std::vector<std::string>*> >
+  Locations;
+
+  Odr_lineno_task(Object* object, Task_token* blocker)
+    : object_(object), locations_(), blocker_(blocker)
+  { }
+
+  // Add a location whose line numbers should be stored in LINENOS.
+  void
+  add_location(const Symbol_location& loc, std::vector<std::string>* linenos)
+  { this->locations_.push_back(std::make_pair(loc, linenos)); }
+
+  Task_token*
+  is_runnable()
+  { return this->object_->is_locked() ? this->object_->token() : NULL; }
+
+  void
+  locks(Task_locker* tl)
+  {
+    Task_token* token = this->object_->token();
+    if (token != NULL)
+      tl->add(this, token);
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Odr_lineno_task " + this->object_->name(); }
+
+ private:
+  Object* object_;
+  Locations locations_;
+  Task_token* blocker_;
+};
+
+// Store all of the lines attached to each location, not just the one
+// the instruction actually came from, sorted by Odr_violation_compare
+// to make std::set_intersection work.
+
+void
+Odr_lineno_task::run(Workqueue*)
+{
+  Dwarf_line_info* lineinfo = Dwarf_line_info::make_line_info(this->object_,
+							       -1U);
+  for (Locations::const_iterator p = this->locations_.begin();
+       p != this->locations_.end();
+       ++p)
+    {
+      Symbol_location code_loc = p->first;
+      parameters->target().function_location(&code_loc);
+      gold_assert(code_loc.object == this->object_);
+      std::vector<std::string>* linenos = p->second;
+      std::string canonical_result = lineinfo->addr2line(code_loc.shndx,
+							 code_loc.offset,
+							 linenos);
+      if (!canonical_result.empty())
+	linenos->push_back(canonical_result);
+      std::sort(linenos->begin(), linenos->end(), Odr_violation_compare());
+    }
+  delete lineinfo;
+  this->object_->release();
+}
+
+// A task which reports the ODR violations once the line numbers have
+// been read.  This is blocked by THIS_BLOCKER and LINENO_BLOCKER, and
+// unblocks NEXT_BLOCKER.
+
+class Detect_odr_violations_task : public Task
+{
+ public:
+  Detect_odr_violations_task(const Symbol_table* symtab,
+			     const char* output_file_name,
+			     Task_token* this_blocker,
+			     Task_token* lineno_blocker,
+			     Task_token* next_blocker)
+    : symtab_(symtab), output_file_name_(output_file_name),
+      this_blocker_(this_blocker), lineno_blocker_(lineno_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Detect_odr_violations_task()
+  {
+    delete this->this_blocker_;
+    delete this->lineno_blocker_;
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (this->lineno_blocker_->is_blocked())
+      return this->lineno_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->symtab_->detect_odr_violations(this->output_file_name_); }
+
+  std::string
+  get_name() const
+  { return "Detect_odr_violations_task"; }
+
+ private:
+  const Symbol_table* symtab_;
+  const char* output_file_name_;
+  Task_token* this_blocker_;
+  Task_token* lineno_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Sort ODR candidates by symbol name.
+
+struct Odr_candidate_compare
+{
+  bool
+  operator()(const std::pair<const char*, std::vector<Symbol_location> >& c1,
+	     const std::pair<const char*, std::vector<Symbol_location> >& c2)
+    const
+  { return strcmp(c1.first, c2.first) < 0; }
+};
+
+// Sort the locations of an ODR candidate into input order.
+
+class Odr_location_compare
+{
+ public:
+  typedef Unordered_map<const Object*, unsigned int> Object_order;
+
+  Odr_location_compare(const Object_order* object_order)
+    : object_order_(object_order)
+  { }
+
+  bool
+  operator()(const Symbol_location& loc1, const Symbol_location& loc2) const
+  {
+    if (loc1.object != loc2.object)
+      {
+	unsigned int index1 = this->index(loc1.object);
+	unsigned int index2 = this->index(loc2.object);
+	if (index1 != index2)
+	  return index1 < index2;
+	// Neither object is in Input_objects, as may happen for a
+	// plugin object.
+	return loc1.object->name() < loc2.object->name();
+      }
+    if (loc1.shndx != loc2.shndx)
+      return loc1.shndx < loc2.shndx;
+    return loc1.offset < loc2.offset;
+  }
+
+ private:
+  unsigned int
+  index(const Object* object) const
+  {
+    Object_order::const_iterator p = this->object_order_->find(object);
+    if (p == this->object_order_->end())
+      return -1U;
+    return p->second;
+  }
+
+  const Object_order* object_order_;
+};
+
+// Queue the tasks which read the line numbers of the ODR violation
+// candidates, and the task which checks them.  The line numbers are
+// read in parallel, one task per object; the check itself runs in a
+// single task, walking the candidates in sorted order, so the
+// warnings do not depend on the order in which the tasks run.
+
+Task_token*
+Symbol_table::queue_odr_tasks(Workqueue* workqueue,
+			      const Input_objects* input_objects,
+			      Task_token* this_blocker,
+			      const char* output_file_name)
+{
+  if (this->candidate_odr_violations_.empty())
+    return this_blocker;
+
+  Odr_location_compare::Object_order object_order;
+  unsigned int index = 0;
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    object_order[*p] = index++;
+  for (Input_objects::Dynobj_iterator p = input_objects->dynobj_begin();
+       p != input_objects->dynobj_end();
+       ++p)
+    object_order[*p] = index++;
+
+  this->odr_candidates_.reserve(this->candidate_odr_violations_.size());
+  for (Odr_map::const_iterator it = this->candidate_odr_violations_.begin();
+       it != this->candidate_odr_violations_.end();
+       ++it)
+    {
+      this->odr_candidates_.push_back(
+	  std::make_pair(it->first, std::vector<Symbol_location>()));
+      std::vector<Symbol_location>& locations(
+	  this->odr_candidates_.back().second);
+      locations.assign(it->second.begin(), it->second.end());
+      std::sort(locations.begin(), locations.end(),
+		Odr_location_compare(&object_order));
+    }
+  std::sort(this->odr_candidates_.begin(), this->odr_candidates_.end(),
+	    Odr_candidate_compare());
+
+  // Give each distinct location a result vector, and group the
+  // locations by object.  All the result vectors are created before
+  // any task runs, so the tasks do not modify odr_linenos_ itself.
+  Task_token* lineno_blocker = new Task_token(true);
+  typedef Unordered_map<const Object*, Odr_lineno_task*> Object_tasks;
+  Object_tasks object_tasks;
+  std::vector<Odr_lineno_task*> tasks;
+  for (Odr_candidates::const_iterator p = this->odr_candidates_.begin();
+       p != this->odr_candidates_.end();
+       ++p)
+    for (std::vector<Symbol_location>::const_iterator loc = p->second.begin();
+	 loc != p->second.end();
+	 ++loc)
+      {
+	std::pair<Odr_linenos::iterator, bool> ins =
+	  this->odr_linenos_.insert(std::make_pair(*loc,
+						   std::vector<std::string>()));
+	if (!ins.second)
+	  continue;
+
+	Odr_lineno_task*& task(object_tasks[loc->object]);
+	if (task == NULL)
+	  {
+	    task = new Odr_lineno_task(loc->object, lineno_blocker);
+	    tasks.push_back(task);
+	  }
+	task->add_location(*loc, &ins.first->second);
+      }
+
+  // Add all the blockers before queuing any tasks, since the tasks
+  // may start running as soon as they are queued.
+  lineno_blocker->add_blockers(tasks.size());
+
+  Task_token* next_blocker = new Task_token(true);
+  next_blocker->add_blocker();
+
+  for (std::vector<Odr_lineno_task*>::const_iterator p = tasks.begin();
+       p != tasks.end();
+       ++p)
+    workqueue->queue(*p);
+
+  workqueue->queue(new Detect_odr_violations_task(this, output_file_name,
+						  this_blocker,
+						  lineno_blocker,
+						  next_blocker));
+
+  return next_blocker;
 }
 
 // OutputIterator that records if it was ever assigned to.  This
@@ -3310,23 +3575,25 @@ struct Check_intersection
 // for each line assigned to the first instruction).
 
 void
-Symbol_table::detect_odr_violations(const Task* task,
-				    const char* output_file_name) const
+Symbol_table::detect_odr_violations(const char* output_file_name) const
 {
-  for (Odr_map::const_iterator it = candidate_odr_violations_.begin();
-       it != candidate_odr_violations_.end();
+  for (Odr_candidates::const_iterator it = this->odr_candidates_.begin();
+       it != this->odr_candidates_.end();
        ++it)
     {
       const char* const symbol_name = it->first;
 
       std::string first_object_name;
-      std::vector<std::string> first_object_linenos;
-
-      Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
-          locs = it->second.begin();
-      const Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
-          locs_end = it->second.end();
-      for (; locs != locs_end && first_object_linenos.empty(); ++locs)
+      const std::vector<std::string>* first_object_linenos = NULL;
+
+      std::vector<Symbol_location>::const_iterator locs = it->second.begin();
+      const std::vector<Symbol_location>::const_iterator locs_end =
+	  it->second.end();
+      for (;
+	   (locs != locs_end
+	    && (first_object_linenos == NULL
+		|| first_object_linenos->empty()));
+	   ++locs)
         {
           // Save the line numbers from the first definition to
           // compare to the other definitions.  Ideally, we'd compare
@@ -3335,28 +3602,21 @@ Symbol_table::detect_odr_violations(const Task* task,
           // false negatives that appear or disappear depending on the
           // link order, but it won't cause false positives.
           first_object_name = locs->object->name();
-          first_object_linenos = this->linenos_from_loc(task, *locs);
+          first_object_linenos = this->odr_linenos(*locs);
         }
 
-      // Sort by Odr_violation_compare to make std::set_intersection work.
-      std::sort(first_object_linenos.begin(), first_object_linenos.end(),
-                Odr_violation_compare());
-
       for (; locs != locs_end; ++locs)
         {
-          std::vector<std::string> linenos =
-              this->linenos_from_loc(task, *locs);
+          const std::vector<std::string>* linenos = this->odr_linenos(*locs);
           // linenos will be empty if we couldn't parse the debug info.
-          if (linenos.empty())
+          if (linenos->empty())
             continue;
-          // Sort by Odr_violation_compare to make std::set_intersection work.
-          std::sort(linenos.begin(), linenos.end(), Odr_violation_compare());
 
           Check_intersection intersection_result =
-              std::set_intersection(first_object_linenos.begin(),
-                                    first_object_linenos.end(),
-                                    linenos.begin(),
-                                    linenos.end(),
+              std::set_intersection(first_object_linenos->begin(),
+                                    first_object_linenos->end(),
+                                    linenos->begin(),
+                                    linenos->end(),
                                     Check_intersection(),
                                     Odr_violation_compare());
           if (!intersection_result.had_intersection())
@@ -3368,13 +3628,13 @@ Symbol_table::detect_odr_violations(const Task* task,
               // which may not be the location we expect to intersect
               // with another definition.  We could print the whole
               // set of locations, but that seems too verbose.
-              gold_assert(!first_object_linenos.empty());
-              gold_assert(!linenos.empty());
+              gold_assert(!first_object_linenos->empty());
+              gold_assert(!linenos->empty());
               fprintf(stderr, _("  %s from %s\n"),
-                      first_object_linenos[0].c_str(),
+                      (*first_object_linenos)[0].c_str(),
                       first_object_name.c_str());
               fprintf(stderr, _("  %s from %s\n"),
-                      linenos[0].c_str(),
+                      (*linenos)[0].c_str(),
                       locs->object->name().c_str());
               // Only print one broken pair, to avoid needing to
               // compare against a list of the disjoint definition
@@ -3386,8 +3646,6 @@ Symbol_table::detect_odr_violations(const Task* task,
             }
         }
     }
-  // We only call one_addr2line() in this function, so we can clear its cache.
-  Dwarf_line_info::clear_addr2line_cache();
 }
 
 // Warnings functions.
@@ -3469,6 +3727,8 @@ Symbol_table::add_from_relobj<32, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const size_t* sym_name_hashes,
+    const uint32_t* sym_gnu_hashes,
     Sized_relobj_file<32, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3483,6 +3743,8 @@ Symbol_table::add_from_relobj<32, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const size_t* sym_name_hashes,
+    const uint32_t* sym_gnu_hashes,
     Sized_relobj_file<32, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3497,6 +3759,8 @@ Symbol_table::add_from_relobj<64, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const size_t* sym_name_hashes,
+    const uint32_t* sym_gnu_hashes,
     Sized_relobj_file<64, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3511,6 +3775,8 @@ Symbol_table::add_from_relobj<64, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const size_t* sym_name_hashes,
+    const uint32_t* sym_gnu_hashes,
     Sized_relobj_file<64, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -60,6 +60,8 @@ class Output_file;
 class Output_symtab_xindex;
 class Garbage_collection;
 class Icf;
+class Task_token;
+class Workqueue;
 
 // The base class of an entry in the symbol table.  The symbol table
 // can have a lot of entries, so we don't want this class too big.
@@ -862,6 +864,28 @@ class Symbol
   is_predefined() const
   { return this->is_predefined_; }
 
+  // Return whether we know the GNU hash code of the symbol name.
+  bool
+  has_gnu_hash() const
+  { return this->has_gnu_hash_; }
+
+  // Return the GNU hash code of the symbol name, for the
+  // .gnu.hash section.
+  uint32_t
+  gnu_hash() const
+  {
+    gold_assert(this->has_gnu_hash_);
+    return this->gnu_hash_;
+  }
+
+  // Set the GNU hash code of the symbol name.
+  void
+  set_gnu_hash(uint32_t gnu_hash)
+  {
+    this->gnu_hash_ = gnu_hash;
+    this->has_gnu_hash_ = true;
+  }
+
   // Return true if this is a C++ vtable symbol.
   bool
   is_cxx_vtable() const
@@ -1002,6 +1026,10 @@ class Symbol
   // is no PLT entry.
   unsigned int plt_offset_;
 
+  // The GNU hash code of the symbol name, if has_gnu_hash_ is set.
+  // This fits in padding, so it does not make the symbol larger.
+  uint32_t gnu_hash_;
+
   // Symbol type (bits 0 to 3).
   elfcpp::STT type_ : 4;
   // Symbol binding (bits 4 to 7).
@@ -1064,6 +1092,8 @@ class Symbol
   bool undef_binding_weak_ : 1;
   // True if this symbol is a predefined linker symbol (bit 34).
   bool is_predefined_ : 1;
+  // True if gnu_hash_ is set.
+  bool has_gnu_hash_ : 1;
 };
 
 // The parts of a symbol which are size specific.  Using a template
@@ -1398,15 +1428,19 @@ class Symbol_table
   // Add COUNT external symbols from the relocatable object RELOBJ to
   // the symbol table.  SYMS is the symbols, SYMNDX_OFFSET is the
   // offset in the symbol table of the first symbol, SYM_NAMES is
-  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  This sets
-  // SYMPOINTERS to point to the symbols in the symbol table.  It sets
-  // *DEFINED to the number of defined symbols.
+  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  If
+  // SYM_NAME_HASHES is not NULL, it holds the precomputed hash codes
+  // of the unversioned symbol names.  If SYM_GNU_HASHES is not NULL,
+  // it holds their GNU hash codes.  This sets SYMPOINTERS to point
+  // to the symbols in the symbol table.  It sets *DEFINED to the
+  // number of defined symbols.
   template<int size, bool big_endian>
   void
   add_from_relobj(Sized_relobj_file<size, big_endian>* relobj,
 		  const unsigned char* syms, size_t count,
 		  size_t symndx_offset, const char* sym_names,
-		  size_t sym_name_size,
+		  size_t sym_name_size, const size_t* sym_name_hashes,
+		  const uint32_t* sym_gnu_hashes,
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
@@ -1532,10 +1566,21 @@ class Symbol_table
 		size_t relnum, off_t reloffset) const
   { this->warnings_.issue_warning(sym, relinfo, relnum, reloffset); }
 
+  // If we are detecting ODR violations, queue the tasks which read
+  // the line numbers for the locations in candidate_odr_violations_,
+  // one task per object, followed by a task which checks them.
+  // Return a blocker that will unblock when they and BLOCKER finish.
+  // Otherwise return BLOCKER.
+  Task_token*
+  queue_odr_tasks(Workqueue*, const Input_objects*, Task_token* blocker,
+		  const char* output_file_name);
+
   // Check candidate_odr_violations_ to find symbols with the same name
   // but apparently different definitions (different source-file/line-no).
+  // This uses the candidates sorted and the line numbers read by
+  // queue_odr_tasks.
   void
-  detect_odr_violations(const Task*, const char* output_file_name) const;
+  detect_odr_violations(const char* output_file_name) const;
 
   // Add any undefined symbols named on the command line to the symbol
   // table.
@@ -1682,6 +1727,20 @@ class Symbol_table
                         Unordered_set<Symbol_location, Symbol_location_hash> >
   Odr_map;
 
+  // A map from a location in candidate_odr_violations_ to all of the
+  // lines attached to it, not just the one the instruction actually
+  // came from, sorted by Odr_violation_compare.  This helps the ODR
+  // checker avoid false positives.
+  typedef Unordered_map<Symbol_location, std::vector<std::string>,
+			Symbol_location_hash>
+  Odr_linenos;
+
+  // The entries of candidate_odr_violations_ sorted by symbol name,
+  // with the locations of each symbol sorted into input order, so
+  // that the ODR warnings do not depend on hash table order.
+  typedef std::vector<std::pair<const char*, std::vector<Symbol_location> > >
+  Odr_candidates;
+
   // Make FROM a forwarder symbol to TO.
   void
   make_forwarder(Symbol* from, Symbol* to);
@@ -1830,11 +1889,14 @@ class Symbol_table
   do_allocate_commons_list(Layout*, Commons_section_type, Commons_type*,
 			   Mapfile*, Sort_commons_order);
 
-  // Returns all of the lines attached to LOC, not just the one the
-  // instruction actually came from.  This helps the ODR checker avoid
-  // false positives.
-  static std::vector<std::string>
-  linenos_from_loc(const Task* task, const Symbol_location& loc);
+  // Return the line numbers read for LOC by queue_odr_tasks.
+  const std::vector<std::string>*
+  odr_linenos(const Symbol_location& loc) const
+  {
+    Odr_linenos::const_iterator p = this->odr_linenos_.find(loc);
+    gold_assert(p != this->odr_linenos_.end());
+    return &p->second;
+  }
 
   // Implement detect_odr_violations.
   template<int size, bool big_endian>
@@ -1936,6 +1998,10 @@ class Symbol_table
   Warnings warnings_;
   // Manage potential One Definition Rule (ODR) violations.
   Odr_map candidate_odr_violations_;
+  // The sorted candidate ODR violations.
+  Odr_candidates odr_candidates_;
+  // The line numbers of the locations in odr_candidates_.
+  Odr_linenos odr_linenos_;
 
   // When we emit a COPY reloc for a symbol, we define it in an
   // Output_data.  When it's time to emit version information for it,
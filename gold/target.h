@@ -369,6 +369,13 @@ class Target
      return this->do_may_relax();
   }
 
+  // Return true if the target keeps an output view after passing it
+  // to Output_file::write_output_view, and writes to it later.  If
+  // this is true, the whole output file must be held in memory.
+  bool
+  retains_output_views() const
+  { return this->do_retains_output_views(); }
+
   // Perform a relaxation pass.  Return true if layout may be changed.
   bool
   relax(int pass, const Input_objects* input_objects, Symbol_table* symtab,
@@ -713,6 +720,11 @@ class Target
   do_relax(int, const Input_objects*, Symbol_table*, Layout*, const Task*)
   { return false; }
 
+  // Virtual function which may be overridden by the child class.
+  virtual bool
+  do_retains_output_views() const
+  { return false; }
+
   // A function for targets to call.  Return whether BYTES/LEN matches
   // VIEW/VIEW_SIZE at OFFSET.
   bool
@@ -0,0 +1,57 @@
+#!/bin/sh
+
+# build_id_fast_test.sh -- test --build-id=fast.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with build_id_fast_test_[1-4].stdout, the output of
+# readelf -n for the same program linked twice with --build-id=fast,
+# and twice with a small chunk size, with and without threads.  The
+# build ID must be a 160-bit value which is not all zeros, and must
+# not depend on anything but the output contents and chunk size.
+
+build_id()
+{
+    id=`sed -n -e 's/^ *Build ID: *\([0-9a-f]*\).*/\1/p' $1`
+    if test `echo "$id" | wc -c` -ne 41; then
+	echo "$1: no 160-bit build ID found"
+	exit 1
+    fi
+    if echo "$id" | grep -q '^0*$'; then
+	echo "$1: build ID is zero"
+	exit 1
+    fi
+    echo "$id"
+}
+
+same()
+{
+    id1=`build_id $1` || { echo "$id1"; exit 1; }
+    id2=`build_id $2` || { echo "$id2"; exit 1; }
+    if test "$id1" != "$id2"; then
+	echo "build IDs differ: $1: $id1, $2: $id2"
+	exit 1
+    fi
+}
+
+same build_id_fast_test_1.stdout build_id_fast_test_2.stdout
+same build_id_fast_test_3.stdout build_id_fast_test_4.stdout
+
+exit 0
@@ -0,0 +1,12 @@
+# compress_chunks_test.s -- input for compress_chunks_test.
+
+# A debug section of about 4.8M, which is more than one chunk for
+# --compress-debug-sections.  The words vary enough that the chunks
+# do not all compress to the same bytes.
+
+	.section .debug_macinfo,"",@progbits
+	.set	v, 0
+	.rept	1200000
+	.long	v * 1103 + v / 7
+	.set	v, v + 1
+	.endr
@@ -134,6 +134,35 @@ check debug_msg_so.err ": symbol 'SometimesInlineFunction(int)' defined in multi
 check debug_msg_so.err "debug_msg.cc:68"
 check debug_msg_so.err "odr_violation2.cc:27"
 
+# With threads, the ODR warnings must be exactly the same.  They are
+# sorted by symbol name, and each symbol's definitions are listed in
+# input order.
+odr_warnings()
+{
+    sed -n -e 's/.*while linking [^:]*: \(.*possible ODR violation.*\)/\1/p' \
+	-e '/^  .* from .*/p' "$1"
+}
+if test "`odr_warnings debug_msg.err`" != "`odr_warnings debug_msg_threads.err`"
+then
+    echo "ODR warnings differ with threads:"
+    odr_warnings debug_msg.err
+    echo ""
+    echo "Actual error output below:"
+    cat debug_msg_threads.err
+    exit 1
+fi
+check debug_msg_threads.err ": symbol 'Ordering::operator()(int, int)' defined in multiple places (possible ODR violation):"
+check debug_msg_threads.err ": symbol 'SometimesInlineFunction(int)' defined in multiple places (possible ODR violation):"
+odr_order=`odr_warnings debug_msg_threads.err | sed -n -e "s/^symbol '\([^(]*\).*/\1/p" -e 's/^  .*\/\([^/]*\.cc\):.*/\1/p' | tr '\n' ' '`
+if test "$odr_order" != "SometimesInlineFunction debug_msg.cc odr_violation2.cc Ordering::operator odr_violation1.cc odr_violation2.cc "
+then
+    echo "ODR warnings out of order with threads: $odr_order"
+    echo ""
+    echo "Actual error output below:"
+    cat debug_msg_threads.err
+    exit 1
+fi
+
 # These messages shouldn't need any debug info to detect:
 check debug_msg_ndebug.err "debug_msg_ndebug.so: error: undefined reference to 'undef_fn1()'"
 check debug_msg_ndebug.err "debug_msg_ndebug.so: error: undefined reference to 'undef_fn2()'"
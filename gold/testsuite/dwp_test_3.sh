@@ -0,0 +1,38 @@
+#!/bin/sh
+
+# dwp_test_3.sh -- Test the dwp tool with threads.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# dwp_test_3.dwp is built from the same .dwo files as dwp_test_1.dwp,
+# and dwp_test_3b.dwp from the same .dwp files as dwp_test_2.dwp, but
+# with --threads.  The input files are scanned and copied in parallel,
+# while their strings and units are merged in order, so the outputs
+# must be identical.
+
+for p in "dwp_test_1.dwp dwp_test_3.dwp" "dwp_test_2.dwp dwp_test_3b.dwp"; do
+    set -- $p
+    if ! cmp -s $1 $2; then
+	echo "$1 and $2 differ"
+	exit 1
+    fi
+done
+
+exit 0
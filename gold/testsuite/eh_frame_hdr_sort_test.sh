@@ -0,0 +1,56 @@
+#!/bin/sh
+
+# eh_frame_hdr_sort_test.sh -- test sorting the .eh_frame_hdr table.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# eh_frame_hdr_sort_test.so has 330 FDEs, of which 30 pairs share a
+# PC.  After the 12 byte header, .eh_frame_hdr holds pairs of 32-bit
+# offsets from the start of the section: the PC, then the FDE.  The
+# PCs must not decrease, and where two are the same the FDE offsets
+# must increase, as the empty FDE comes first in .eh_frame.
+
+set -e
+
+set -- `sed -n -e 's/.* \.eh_frame_hdr  *PROGBITS  *[0-9a-f]*  *\([0-9a-f]*\)  *\([0-9a-f]*\) .*/\1 \2/p' eh_frame_hdr_sort_test.stdout`
+if test $# != 2; then
+    echo "Could not find .eh_frame_hdr in eh_frame_hdr_sort_test.stdout"
+    exit 1
+fi
+
+offset=`expr $((0x$1)) + 12`
+size=`expr $((0x$2)) - 12`
+
+result=`od -A n -t d4 -v -j $offset -N $size eh_frame_hdr_sort_test.so \
+    | awk '{ for (i = 1; i < NF; i += 2) print $i, $(i + 1) }' \
+    | awk 'NR > 1 && ($1 < pc || ($1 == pc && $2 <= fde)) { bad++ }
+	   NR > 1 && $1 == pc { same++ }
+	   { pc = $1; fde = $2 }
+	   END { print NR, same + 0, bad + 0 }'`
+
+if test "$result" != "330 30 0"; then
+    echo "Unexpected .eh_frame_hdr table: entries, same PCs, misordered:"
+    echo "   $result"
+    echo "Expected:"
+    echo "   330 30 0"
+    exit 1
+fi
+
+exit 0
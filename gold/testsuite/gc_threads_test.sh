@@ -0,0 +1,80 @@
+#!/bin/sh
+
+# gc_threads_test.sh -- test --gc-sections with --threads.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# gc_threads_test_1.so is linked without threads and
+# gc_threads_test_2.so with 4 threads.  Of the 4000 sections .text.f<N>,
+# the 1231 which can be reached from f1 to f8 are kept.  The removed
+# sections must be reported in the same order, and the outputs must
+# be identical.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+for f in gc_threads_test_1.err gc_threads_test_2.err; do
+    check $f "removing unused section from '.text.f10' in file"
+    check $f "removing unused section from '.text.f11' in file"
+    check $f "removing unused section from '.text.f20' in file"
+    check_missing $f "removing unused section from '.text.f5' in file"
+    check_missing $f "removing unused section from '.text.f19' in file"
+    check_missing $f "removing unused section from '.text.f38' in file"
+    removed=`grep -c "removing unused section from '.text\\." $f`
+    if test "$removed" != 2769; then
+	echo "$f: removed $removed sections, expected 2769"
+	exit 1
+    fi
+done
+
+if ! cmp -s gc_threads_test_1.err gc_threads_test_2.err; then
+    echo "gc_threads_test_1.err and gc_threads_test_2.err differ"
+    exit 1
+fi
+
+if ! cmp -s gc_threads_test_1.so gc_threads_test_2.so; then
+    echo "gc_threads_test_1.so and gc_threads_test_2.so differ"
+    exit 1
+fi
+
+exit 0
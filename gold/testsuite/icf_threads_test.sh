@@ -0,0 +1,65 @@
+#!/bin/sh
+
+# icf_threads_test.sh -- test --icf=all with --threads.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# icf_threads_test_1.so is linked without threads and
+# icf_threads_test_2.so with 4 threads.  The 8000 candidate sections
+# fall into eight groups, four of b<N> and four of a<N>, so all but
+# eight of them are folded.  The empty .text sections are folded too,
+# but are not counted.  The folds must be reported in the same order,
+# and the outputs must be identical.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+for f in icf_threads_test_1.err icf_threads_test_2.err; do
+    check $f "ICF Converged after 2 iteration(s)"
+    check $f "folding section '.text.b5' in file 'icf_threads_test_1.o' into '.text.b1' in file 'icf_threads_test_1.o'"
+    check $f "folding section '.text.a3999' in file 'icf_threads_test_4.o' into '.text.a3' in file 'icf_threads_test_1.o'"
+    folded=`grep -c "ICF folding section '.text\\." $f`
+    if test "$folded" != 7992; then
+	echo "$f: folded $folded sections, expected 7992"
+	exit 1
+    fi
+done
+
+if ! cmp -s icf_threads_test_1.err icf_threads_test_2.err; then
+    echo "icf_threads_test_1.err and icf_threads_test_2.err differ"
+    exit 1
+fi
+
+if ! cmp -s icf_threads_test_1.so icf_threads_test_2.so; then
+    echo "icf_threads_test_1.so and icf_threads_test_2.so differ"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,45 @@
+#!/bin/sh
+
+# incremental_digest_test.sh -- test that an incremental update reuses
+# input files whose timestamps changed but whose contents did not.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The test touches an object file and an archive between a full
+# incremental link and an incremental update.  Both must be reused
+# by comparing their digests, and nothing must be read again.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check incremental_digest_test.stats "incremental inputs read again: 0$"
+check incremental_digest_test.stats "incremental inputs reused by content digest: 2$"
+
+exit 0
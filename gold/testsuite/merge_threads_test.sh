@@ -0,0 +1,39 @@
+#!/bin/sh
+
+# merge_threads_test.sh -- test merging strings in parallel tasks.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# merge_threads_test_1.so is linked without threads, and
+# merge_threads_test_2.so and merge_threads_test_3.so with 4 and 7
+# threads.  The merged string section is large enough that the
+# threaded links find and deduplicate its strings in parallel tasks,
+# working on input sections which are still views of the input
+# files.  The merged constants and the pointers into both kinds of
+# section must come out the same.  The outputs must be identical.
+
+for f in merge_threads_test_2.so merge_threads_test_3.so; do
+    if ! cmp -s merge_threads_test_1.so $f; then
+	echo "merge_threads_test_1.so and $f differ"
+	exit 1
+    fi
+done
+
+exit 0
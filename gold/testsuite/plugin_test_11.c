@@ -0,0 +1,29 @@
+/* plugin_test_11.c -- test rescanning archives in plugins
+
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This file is added by the plugin after all symbols have been read,
+   in place of plugin_test_11.syms, which does not mention
+   collide_ab.  So collide_ab can only be found by rescanning the
+   archive.  */
+
+extern int collide_ab;
+
+int *plugin_test_11_p = &collide_ab;
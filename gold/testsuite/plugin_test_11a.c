@@ -0,0 +1,26 @@
+/* plugin_test_11a.c -- test rescanning archives in plugins
+
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   The names collide_ab and collide_bA have the same hash value in
+   gold's string_hash: 'a' + 1 == 'b' and 'b' - 33 == 'A'.  So
+   they always share a bucket in the hash table of the archive map.  */
+
+int collide_ab = 1;
@@ -0,0 +1,68 @@
+#!/bin/sh
+
+# script_test_12.sh -- test which script statement an input section
+# matches.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with script_test_12.t and script_test_12[ab].s.  Each
+# input section defines one symbol, and objdump -t shows the output
+# section it ended up in.
+
+check()
+{
+    if ! grep -q "[ 	]$2[ 	].* $1\$" script_test_12.stdout
+    then
+	echo "Did not find $1 in section $2:"
+	echo ""
+	echo "Actual output below:"
+	cat script_test_12.stdout
+	exit 1
+    fi
+}
+
+check first_one .first
+check first_two .second
+check pre_exact .prefix
+check pre_other .prefix
+check excl_a .excl
+check excl_b .excl_rest
+check byfile_a .exact
+check byfile_b .wild
+check sort_a .sorted
+check sort_b .sorted
+check sort_c .sorted
+check kept .kept
+
+if grep -q " collected\$" script_test_12.stdout; then
+    echo "Section .collected was not garbage collected:"
+    cat script_test_12.stdout
+    exit 1
+fi
+
+# The input order is .sort.c, .sort.a, .sort.b.
+order=`grep " sort_[abc]\$" script_test_12.syms | sed -e 's/.* //' | tr '\n' ' '`
+if test "$order" != "sort_a sort_b sort_c "; then
+    echo "Sections sorted as: $order"
+    cat script_test_12.syms
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,49 @@
+/* script_test_12.t -- test which script statement an input section
+   matches.
+
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+SECTIONS
+{
+  .text : { *(.text) }
+
+  /* The first statement which matches a section wins, even when a
+     later statement names the section exactly.  */
+  .first : { *(.first.one) }
+  .second : { *(.first.*) }
+  .prefix : { *(.pre*) }
+  .prefix_exact : { *(.pre.exact) }
+
+  /* EXCLUDE_FILE leaves a section to a later statement.  */
+  .excl : { *(EXCLUDE_FILE(*script_test_12b.o) .excl) }
+  .excl_rest : { *(.excl) }
+
+  /* An exact file name matches only that file; a wildcard matches the
+     rest.  */
+  .exact : { script_test_12a.o(.byfile) }
+  .wild : { *(.byfile) }
+
+  /* SORT orders the sections by name, not by input order.  */
+  .sorted : { *(SORT(.sort.*)) }
+
+  /* KEEP keeps a section which --gc-sections would remove.  */
+  .kept : { KEEP(*(.kept)) }
+  .collected : { *(.collected) }
+}
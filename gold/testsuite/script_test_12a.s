@@ -0,0 +1,51 @@
+# script_test_12a.s -- input for script_test_12.
+
+# Refer to every section but .kept and .collected, so that
+# --gc-sections keeps them.
+
+	.text
+	.globl	script_test_12_start
+script_test_12_start:
+	.dc.a	first_one, first_two, pre_exact, pre_other
+	.dc.a	excl_a, excl_b, byfile_a, byfile_b
+	.dc.a	sort_a, sort_b, sort_c
+
+	.section .first.one, "a"
+	.globl	first_one
+first_one:
+	.byte	1
+
+	.section .first.two, "a"
+	.globl	first_two
+first_two:
+	.byte	2
+
+	.section .pre.exact, "a"
+	.globl	pre_exact
+pre_exact:
+	.byte	3
+
+	.section .excl, "a"
+	.globl	excl_a
+excl_a:
+	.byte	4
+
+	.section .byfile, "a"
+	.globl	byfile_a
+byfile_a:
+	.byte	5
+
+	.section .sort.c, "a"
+	.globl	sort_c
+sort_c:
+	.byte	6
+
+	.section .sort.a, "a"
+	.globl	sort_a
+sort_a:
+	.byte	7
+
+	.section .kept, "a"
+	.globl	kept
+kept:
+	.byte	8
@@ -0,0 +1,26 @@
+# script_test_12b.s -- input for script_test_12.
+
+	.section .pre.other, "a"
+	.globl	pre_other
+pre_other:
+	.byte	1
+
+	.section .excl, "a"
+	.globl	excl_b
+excl_b:
+	.byte	2
+
+	.section .byfile, "a"
+	.globl	byfile_b
+byfile_b:
+	.byte	3
+
+	.section .sort.b, "a"
+	.globl	sort_b
+sort_b:
+	.byte	4
+
+	.section .collected, "a"
+	.globl	collected
+collected:
+	.byte	5
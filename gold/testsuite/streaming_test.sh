@@ -0,0 +1,38 @@
+#!/bin/sh
+
+# streaming_test.sh -- test --no-mmap-output-file.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with streaming_test_[12].s.  streaming_test_1 is
+# linked with the output file mapped, and streaming_test_2 and
+# streaming_test_3 are linked with it streamed, without and with
+# threads.  Every object relocates its part of .eh_frame in a view of
+# the whole output section, so this checks that the objects' changes
+# are all kept when streaming.  The outputs must be identical.
+
+for f in streaming_test_2 streaming_test_3; do
+    if ! cmp -s streaming_test_1 $f; then
+	echo "streaming_test_1 and $f differ"
+	exit 1
+    fi
+done
+
+exit 0
@@ -0,0 +1,98 @@
+# streaming_test_1.s -- input for streaming_test.sh.
+
+# Each function has its own CFI, so that each object contributes
+# several FDEs to .eh_frame.  The code is just padding, so that this
+# assembles for any target.
+
+	.text
+	.globl	f1_0
+	.type	f1_0, @function
+f1_0:
+	.cfi_startproc
+	.skip	4
+	.cfi_adjust_cfa_offset	16
+	.skip	4
+	.cfi_endproc
+	.size	f1_0, .-f1_0
+
+	.text
+	.globl	f1_1
+	.type	f1_1, @function
+f1_1:
+	.cfi_startproc
+	.skip	8
+	.cfi_adjust_cfa_offset	32
+	.skip	4
+	.cfi_endproc
+	.size	f1_1, .-f1_1
+
+	.text
+	.globl	f1_2
+	.type	f1_2, @function
+f1_2:
+	.cfi_startproc
+	.skip	12
+	.cfi_adjust_cfa_offset	48
+	.skip	4
+	.cfi_endproc
+	.size	f1_2, .-f1_2
+
+	.text
+	.globl	f1_3
+	.type	f1_3, @function
+f1_3:
+	.cfi_startproc
+	.skip	16
+	.cfi_adjust_cfa_offset	64
+	.skip	4
+	.cfi_endproc
+	.size	f1_3, .-f1_3
+
+	.text
+	.globl	f1_4
+	.type	f1_4, @function
+f1_4:
+	.cfi_startproc
+	.skip	20
+	.cfi_adjust_cfa_offset	80
+	.skip	4
+	.cfi_endproc
+	.size	f1_4, .-f1_4
+
+	.text
+	.globl	f1_5
+	.type	f1_5, @function
+f1_5:
+	.cfi_startproc
+	.skip	24
+	.cfi_adjust_cfa_offset	96
+	.skip	4
+	.cfi_endproc
+	.size	f1_5, .-f1_5
+
+	.text
+	.globl	f1_6
+	.type	f1_6, @function
+f1_6:
+	.cfi_startproc
+	.skip	28
+	.cfi_adjust_cfa_offset	112
+	.skip	4
+	.cfi_endproc
+	.size	f1_6, .-f1_6
+
+	.text
+	.globl	f1_7
+	.type	f1_7, @function
+f1_7:
+	.cfi_startproc
+	.skip	32
+	.cfi_adjust_cfa_offset	128
+	.skip	4
+	.cfi_endproc
+	.size	f1_7, .-f1_7
+
+	.data
+	.globl	v1
+v1:
+	.long	0x1111
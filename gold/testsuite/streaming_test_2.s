@@ -0,0 +1,98 @@
+# streaming_test_2.s -- input for streaming_test.sh.
+
+# Each function has its own CFI, so that each object contributes
+# several FDEs to .eh_frame.  The code is just padding, so that this
+# assembles for any target.
+
+	.text
+	.globl	f2_0
+	.type	f2_0, @function
+f2_0:
+	.cfi_startproc
+	.skip	4
+	.cfi_adjust_cfa_offset	16
+	.skip	4
+	.cfi_endproc
+	.size	f2_0, .-f2_0
+
+	.text
+	.globl	f2_1
+	.type	f2_1, @function
+f2_1:
+	.cfi_startproc
+	.skip	8
+	.cfi_adjust_cfa_offset	32
+	.skip	4
+	.cfi_endproc
+	.size	f2_1, .-f2_1
+
+	.text
+	.globl	f2_2
+	.type	f2_2, @function
+f2_2:
+	.cfi_startproc
+	.skip	12
+	.cfi_adjust_cfa_offset	48
+	.skip	4
+	.cfi_endproc
+	.size	f2_2, .-f2_2
+
+	.text
+	.globl	f2_3
+	.type	f2_3, @function
+f2_3:
+	.cfi_startproc
+	.skip	16
+	.cfi_adjust_cfa_offset	64
+	.skip	4
+	.cfi_endproc
+	.size	f2_3, .-f2_3
+
+	.text
+	.globl	f2_4
+	.type	f2_4, @function
+f2_4:
+	.cfi_startproc
+	.skip	20
+	.cfi_adjust_cfa_offset	80
+	.skip	4
+	.cfi_endproc
+	.size	f2_4, .-f2_4
+
+	.text
+	.globl	f2_5
+	.type	f2_5, @function
+f2_5:
+	.cfi_startproc
+	.skip	24
+	.cfi_adjust_cfa_offset	96
+	.skip	4
+	.cfi_endproc
+	.size	f2_5, .-f2_5
+
+	.text
+	.globl	f2_6
+	.type	f2_6, @function
+f2_6:
+	.cfi_startproc
+	.skip	28
+	.cfi_adjust_cfa_offset	112
+	.skip	4
+	.cfi_endproc
+	.size	f2_6, .-f2_6
+
+	.text
+	.globl	f2_7
+	.type	f2_7, @function
+f2_7:
+	.cfi_startproc
+	.skip	32
+	.cfi_adjust_cfa_offset	128
+	.skip	4
+	.cfi_endproc
+	.size	f2_7, .-f2_7
+
+	.data
+	.globl	v2
+v2:
+	.long	0x2222
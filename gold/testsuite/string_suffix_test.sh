@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# string_suffix_test.sh -- test suffix sharing in string tables.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with string_suffix_test_[12].c.  The program is
+# linked with -E, so that the names of its variables are in both
+# .strtab and .dynstr.  Each table should hold the longer name only,
+# with the shorter name pointing into it, while the symbols still
+# have the right names.  The shorter string literal should be stored
+# inside the longer one in the merged string section.
+
+check_count()
+{
+    count=`grep -c "$2" "$1"`
+    if test "$count" != "$3"; then
+	echo "Found $count instead of $3 lines matching \"$2\" in $1:"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check()
+{
+    if ! grep -q "$2" "$1"; then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_count string_suffix_test.stdout "\]  the_string_suffix_tail$" 2
+check_count string_suffix_test.stdout "\]  string_suffix_tail$" 0
+
+check string_suffix_test.syms " D the_string_suffix_tail$"
+check string_suffix_test.syms " D string_suffix_tail$"
+
+./string_suffix_test > string_suffix_test.out
+check string_suffix_test.out "^sharing a suffix$"
+check string_suffix_test.out "^a suffix$"
+check string_suffix_test.out "^1 2$"
+check string_suffix_test.out "^literals shared$"
+
+exit 0
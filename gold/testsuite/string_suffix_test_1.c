@@ -0,0 +1,36 @@
+/* string_suffix_test_1.c -- test suffix sharing in string tables.
+
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   The names of the two variables are suffixes of each other, and so
+   are the two string literals, one of which is in each file.  The
+   linker should store each shorter name, and the shorter literal, as
+   a suffix of the longer one.  */
+
+int string_suffix_tail = 1;
+int the_string_suffix_tail = 2;
+
+const char *string_suffix_long (void);
+
+const char *
+string_suffix_long (void)
+{
+  return "sharing a suffix";
+}
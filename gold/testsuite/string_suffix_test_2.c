@@ -0,0 +1,46 @@
+/* string_suffix_test_2.c -- test suffix sharing in string tables.
+
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This program prints the variables and string literals defined in
+   string_suffix_test_1.c and here, and whether the shorter literal
+   was stored as a suffix of the longer one.  */
+
+#include <stdio.h>
+#include <string.h>
+
+extern int string_suffix_tail;
+extern int the_string_suffix_tail;
+extern const char *string_suffix_long (void);
+
+int
+main (void)
+{
+  const char *l = string_suffix_long ();
+  const char *s = "a suffix";
+
+  printf ("%s\n%s\n", l, s);
+  printf ("%d %d\n", string_suffix_tail, the_string_suffix_tail);
+  if (s == l + strlen (l) - strlen (s))
+    printf ("literals shared\n");
+  else
+    printf ("literals not shared\n");
+  return 0;
+}
@@ -0,0 +1,70 @@
+#!/bin/sh
+
+# trace_file_test.sh -- test --trace-file.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with trace_file_test.json, the trace written by
+# --trace-file when linking trace_file_test.so with threads.  gold
+# writes one JSON value per line, so check that each line is one of
+# the values it may write.  Together with the first and last lines,
+# that makes the whole file a valid JSON object in the Chrome trace
+# event format.
+
+f=trace_file_test.json
+
+if test "`sed -n -e '1p' $f`" != '{"traceEvents":['; then
+    echo "$f: bad first line"
+    exit 1
+fi
+if test "`sed -n -e '$p' $f`" != ']}'; then
+    echo "$f: bad last line"
+    exit 1
+fi
+
+str='"\([^"\\]*\(\\.\)*\)*"'
+num='[0-9][0-9]*'
+task="{\"name\":$str,\"cat\":\"task\",\"ph\":\"X\",\"pid\":1,\"tid\":$num,\"ts\":$num,\"dur\":$num,\"args\":{\"blocked_us\":$num,\"queued_us\":$num}},"
+wait="{\"name\":\"(idle)\",\"cat\":\"wait\",\"ph\":\"X\",\"pid\":1,\"tid\":$num,\"ts\":$num,\"dur\":$num},"
+thread="{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":$num,\"args\":{\"name\":\"thread $num\"}},"
+process="{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":$str}}"
+
+# Every line but the first and last must be an event followed by a
+# comma, except for the process name, which must come last.
+sed -e '1d' -e '$d' $f > trace_file_test.events
+if ! sed -n -e '$p' trace_file_test.events | grep -q "^$process\$"; then
+    echo "$f: process name is not the last event"
+    exit 1
+fi
+if sed -e '$d' trace_file_test.events \
+   | grep -v -e "^$task\$" -e "^$wait\$" -e "^$thread\$"; then
+    echo "$f: bad events above"
+    exit 1
+fi
+
+# The link must have relocated each input in a task.
+for o in streaming_test_1.o streaming_test_2.o; do
+    if ! grep -q "^{\"name\":\"Relocate_task $o\"" $f; then
+	echo "$f: no Relocate_task for $o"
+	exit 1
+    fi
+done
+
+exit 0
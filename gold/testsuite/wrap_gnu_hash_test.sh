@@ -0,0 +1,37 @@
+#!/bin/sh
+
+# wrap_gnu_hash_test.sh -- test --wrap with --hash-style=gnu.
+
+# Copyright (C) 2014 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with wrap_gnu_hash_test_[12].stdout, the dynamic
+# symbols and .gnu.hash section of wrap_gnu_hash_test_1.so, linked
+# with --wrap=foo, and of wrap_gnu_hash_test_2.so, linked from objects
+# which refer to __wrap_foo and foo directly.  If a symbol kept the
+# hash code of its name before --wrap renamed it, __wrap_foo and foo
+# could not be found through .gnu.hash, and the two would differ.
+
+if ! cmp -s wrap_gnu_hash_test_1.stdout wrap_gnu_hash_test_2.stdout; then
+    echo "wrap_gnu_hash_test_1.so and wrap_gnu_hash_test_2.so differ:"
+    diff wrap_gnu_hash_test_1.stdout wrap_gnu_hash_test_2.stdout
+    exit 1
+fi
+
+exit 0
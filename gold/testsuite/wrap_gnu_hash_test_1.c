@@ -0,0 +1,44 @@
+/* wrap_gnu_hash_test_1.c -- test --wrap with --hash-style=gnu.
+
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This file is compiled twice.  Linked with --wrap=foo, the plain
+   version refers to __wrap_foo and foo, which is what the version
+   compiled with WRAPPED defined refers to without --wrap.  The
+   .gnu.hash sections of the two links must be the same.  */
+
+#ifdef WRAPPED
+#define CALL_FOO __wrap_foo
+#define CALL_REAL_FOO foo
+#else
+#define CALL_FOO foo
+#define CALL_REAL_FOO __real_foo
+#endif
+
+extern int CALL_FOO (void);
+extern int CALL_REAL_FOO (void);
+
+int call_foo (void);
+
+int
+call_foo (void)
+{
+  return CALL_FOO () + CALL_REAL_FOO ();
+}
@@ -0,0 +1,40 @@
+/* wrap_gnu_hash_test_2.c -- test --wrap with --hash-style=gnu.
+
+   Copyright (C) 2014 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This defines the symbols which wrap_gnu_hash_test_1.c refers to.  It
+   comes after wrap_gnu_hash_test_1.o on the command line, so that the
+   symbols are first seen as undefined references which --wrap
+   renames.  */
+
+int foo (void);
+int __wrap_foo (void);
+
+int
+foo (void)
+{
+  return 1;
+}
+
+int
+__wrap_foo (void)
+{
+  return 2;
+}
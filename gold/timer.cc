@@ -23,6 +23,7 @@
 #include "gold.h"
 
 #include <unistd.h>
+#include <sys/time.h>
 
 #ifdef HAVE_TIMES
 #include <sys/times.h>
@@ -130,4 +131,14 @@ Timer::get_pass_time(int n)
   return thispass;
 }
 
+// Return the current wall clock time in microseconds.
+
+long long
+wall_clock_usec()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return static_cast<long long>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
 }
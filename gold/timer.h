@@ -76,5 +76,11 @@ class Timer
   TimeStats pass_times_[3];
 };
 
+// Return the current wall clock time in microseconds.  This is used
+// for statistics about steps which take well under a clock tick, and
+// so need finer resolution than Timer.
+extern long long
+wall_clock_usec();
+
 }
 #endif
@@ -22,6 +22,9 @@
 
 #include "gold.h"
 
+#include <cerrno>
+#include <cstring>
+
 #include "debug.h"
 #include "options.h"
 #include "timer.h"
@@ -123,8 +126,16 @@ Workqueue::Workqueue(const General_options& options)
     running_(0),
     waiting_(0),
     condvar_(this->lock_),
+    gather_stats_(options.stats()),
+    thread_stats_(),
+    trace_(options.trace_file() != NULL),
+    trace_start_(0),
+    trace_events_(),
     threader_(NULL)
 {
+  if (this->trace_)
+    this->trace_start_ = wall_clock_usec();
+
   bool threads = options.threads();
 #ifndef ENABLE_THREADS
   threads = false;
@@ -156,6 +167,7 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
   Task_token* token = t->is_runnable();
   if (token != NULL)
     {
+      this->note_blocked(t);
       if (front)
 	token->add_waiting_front(t);
       else
@@ -164,6 +176,7 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
     }
   else
     {
+      this->note_runnable(t);
       if (front)
 	queue->push_front(t);
       else
@@ -199,6 +212,27 @@ Workqueue::queue_next(Task* t)
   this->add_to_queue(&this->first_tasks_, t, true);
 }
 
+// Note that T is blocked by a Task_token, for --trace-file.  The
+// workqueue lock must be held when this is called.
+
+inline void
+Workqueue::note_blocked(Task* t)
+{
+  if (this->trace_)
+    t->trace_blocked(wall_clock_usec());
+}
+
+// Note that T is ready to run, either on a run queue or about to be
+// run by the thread which unblocked it, for --trace-file.  The
+// workqueue lock must be held when this is called.
+
+inline void
+Workqueue::note_runnable(Task* t)
+{
+  if (this->trace_)
+    t->trace_queued(wall_clock_usec());
+}
+
 // Return whether to cancel the current thread.
 
 inline bool
@@ -222,6 +256,7 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
       if (token == NULL)
 	return t;
 
+      this->note_blocked(t);
       token->add_waiting(t);
       ++this->waiting_;
     }
@@ -269,8 +304,21 @@ Workqueue::find_runnable_or_wait(int thread_number)
 
       gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
 
+      bool timed = this->gather_stats_ || this->trace_;
+      long long wait_start = timed ? wall_clock_usec() : 0;
+
       this->condvar_.wait();
 
+      long long wait_end = timed ? wall_clock_usec() : 0;
+      if (this->gather_stats_)
+	{
+	  Thread_stats& stats(this->thread_stats(thread_number));
+	  ++stats.waits;
+	  stats.idle_time += wait_end - wait_start;
+	}
+      if (this->trace_)
+	this->add_trace_event(NULL, thread_number, wait_start, wait_end, 0, 0);
+
       gold_debug(DEBUG_TASK, "%3d awake", thread_number);
 
       t = this->find_runnable();
@@ -315,9 +363,13 @@ Workqueue::find_and_run_task(int thread_number)
       Timer timer;
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
+      bool timed = this->gather_stats_ || this->trace_;
+      long long run_start = timed ? wall_clock_usec() : 0;
 
       t->run(this);
 
+      long long run_end = timed ? wall_clock_usec() : 0;
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
           Timer::TimeStats elapsed = timer.get_elapsed_time();
@@ -337,10 +389,28 @@ Workqueue::find_and_run_task(int thread_number)
 
 	--this->running_;
 
+	if (this->gather_stats_)
+	  {
+	    Thread_stats& stats(this->thread_stats(thread_number));
+	    ++stats.tasks_run;
+	    stats.run_time += run_end - run_start;
+	  }
+
+	if (this->trace_)
+	  {
+	    t->trace_running(run_start);
+	    this->add_trace_event(t->name().c_str(), thread_number,
+				  run_start, run_end, t->blocked_usec(),
+				  t->queued_usec());
+	  }
+
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
 	next = this->release_locks(t, &tl);
 
+	if (next != NULL && this->gather_stats_)
+	  ++this->thread_stats(thread_number).tasks_handed_off;
+
 	if (next == NULL)
 	  next = this->find_runnable();
 
@@ -400,11 +470,14 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 
   if (token != NULL)
     {
+      this->note_blocked(t);
       token->add_waiting(t);
       ++this->waiting_;
       return false;
     }
 
+  this->note_runnable(t);
+
   bool should_queue = false;
   bool should_return = false;
 
@@ -518,4 +591,131 @@ Workqueue::add_blocker(Task_token* token)
   token->add_blocker();
 }
 
+// Return the statistics for THREAD_NUMBER, creating them if
+// necessary.  The workqueue lock must be held.
+
+Workqueue::Thread_stats&
+Workqueue::thread_stats(int thread_number)
+{
+  gold_assert(thread_number >= 0);
+  if (static_cast<size_t>(thread_number) >= this->thread_stats_.size())
+    this->thread_stats_.resize(thread_number + 1);
+  return this->thread_stats_[thread_number];
+}
+
+// Print per-thread statistics.  A thread which spends most of its
+// time idle while others have long run times indicates a serial
+// phase of the link.
+
+void
+Workqueue::print_stats()
+{
+  Hold_lock hl(this->lock_);
+
+  for (size_t i = 0; i < this->thread_stats_.size(); ++i)
+    {
+      const Thread_stats& stats(this->thread_stats_[i]);
+      fprintf(stderr,
+	      _("%s: workqueue thread %zu: tasks run: %u "
+		"(handed off: %u, from queue: %u); waits: %u; "
+		"run time: %lld.%06lld; idle time: %lld.%06lld\n"),
+	      program_name, i, stats.tasks_run, stats.tasks_handed_off,
+	      stats.tasks_run - stats.tasks_handed_off, stats.waits,
+	      stats.run_time / 1000000, stats.run_time % 1000000,
+	      stats.idle_time / 1000000, stats.idle_time % 1000000);
+    }
+}
+
+// Record an event for --trace-file.  NAME is NULL for a thread
+// waiting for a task.  The workqueue lock must be held.
+
+void
+Workqueue::add_trace_event(const char* name, int thread_number,
+			   long long start, long long end, long long blocked,
+			   long long queued)
+{
+  Trace_event event;
+  if (name != NULL)
+    event.name = name;
+  event.thread_number = thread_number;
+  event.start = start - this->trace_start_;
+  event.duration = end - start;
+  event.blocked = blocked;
+  event.queued = queued;
+  this->trace_events_.push_back(event);
+}
+
+// Write the string S to F as a JSON string.
+
+static void
+write_json_string(FILE* f, const std::string& s)
+{
+  putc('"', f);
+  for (std::string::const_iterator p = s.begin(); p != s.end(); ++p)
+    {
+      unsigned char c = *p;
+      if (c == '"' || c == '\\')
+	fprintf(f, "\\%c", c);
+      else if (c < 0x20)
+	fprintf(f, "\\u%04x", c);
+      else
+	putc(c, f);
+    }
+  putc('"', f);
+}
+
+// Write the recorded events to FILENAME in the Chrome trace event
+// format, which may be loaded into chrome://tracing or Perfetto.
+// Each task is a complete event on the thread which ran it, with the
+// time it spent blocked by a Task_token before it could run, and the
+// time it then spent ready to run, waiting for a thread.  Time a
+// thread spent waiting for any runnable task is shown as "(idle)".
+
+void
+Workqueue::write_trace(const char* filename)
+{
+  Hold_lock hl(this->lock_);
+
+  FILE* f = fopen(filename, "w");
+  if (f == NULL)
+    {
+      gold_error(_("cannot open trace file %s: %s"), filename,
+		 strerror(errno));
+      return;
+    }
+
+  fprintf(f, "{\"traceEvents\":[\n");
+  int max_thread = -1;
+  for (std::vector<Trace_event>::const_iterator p =
+	 this->trace_events_.begin();
+       p != this->trace_events_.end();
+       ++p)
+    {
+      fprintf(f, "{\"name\":");
+      write_json_string(f, p->name.empty() ? "(idle)" : p->name);
+      fprintf(f, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+	      "\"ts\":%lld,\"dur\":%lld",
+	      p->name.empty() ? "wait" : "task", p->thread_number,
+	      p->start, p->duration);
+      if (!p->name.empty())
+	fprintf(f, ",\"args\":{\"blocked_us\":%lld,\"queued_us\":%lld}",
+		p->blocked, p->queued);
+      fprintf(f, "},\n");
+      if (p->thread_number > max_thread)
+	max_thread = p->thread_number;
+    }
+  for (int i = 0; i <= max_thread; ++i)
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+	    "\"tid\":%d,\"args\":{\"name\":\"thread %d\"}},\n", i, i);
+  fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+	  "\"args\":{\"name\":");
+  write_json_string(f, program_name);
+  fprintf(f, "}}\n");
+  fprintf(f, "]}\n");
+
+  if (fclose(f) != 0)
+    gold_error(_("cannot write trace file %s: %s"), filename,
+	       strerror(errno));
+}
+
 } // End namespace gold.
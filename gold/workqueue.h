@@ -28,6 +28,7 @@
 #define GOLD_WORKQUEUE_H
 
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -45,7 +46,8 @@ class Task
 {
  public:
   Task()
-    : list_next_(NULL), name_(), should_run_soon_(false)
+    : list_next_(NULL), name_(), should_run_soon_(false), trace_since_(0),
+      trace_is_blocked_(false), blocked_usec_(0), queued_usec_(0)
   { }
   virtual ~Task()
   { }
@@ -96,6 +98,42 @@ class Task
   clear_list_next()
   { this->list_next_ = NULL; }
 
+  // Record that at time T this Task was blocked by a Task_token,
+  // was put on the run queue, or started running.  These are only
+  // used for --trace-file, to total the time the Task spent blocked
+  // and the time it spent ready to run before it ran.
+  void
+  trace_blocked(long long t)
+  {
+    this->trace_update(t);
+    this->trace_is_blocked_ = true;
+  }
+
+  void
+  trace_queued(long long t)
+  {
+    this->trace_update(t);
+    this->trace_is_blocked_ = false;
+  }
+
+  void
+  trace_running(long long t)
+  {
+    this->trace_update(t);
+    this->trace_since_ = 0;
+  }
+
+  // Return the total time this Task was blocked by a Task_token.
+  long long
+  blocked_usec() const
+  { return this->blocked_usec_; }
+
+  // Return the total time this Task was ready to run but waiting for
+  // a thread.
+  long long
+  queued_usec() const
+  { return this->queued_usec_; }
+
   // Return the name of the Task.  This is only used for debugging
   // purposes.
   const std::string&
@@ -117,6 +155,20 @@ class Task
   Task(const Task&);
   Task& operator=(const Task&);
 
+  // Add the time since the last trace call to the current state.
+  void
+  trace_update(long long t)
+  {
+    if (this->trace_since_ != 0)
+      {
+	if (this->trace_is_blocked_)
+	  this->blocked_usec_ += t - this->trace_since_;
+	else
+	  this->queued_usec_ += t - this->trace_since_;
+      }
+    this->trace_since_ = t;
+  }
+
   // If this Task is on a list, this is a pointer to the next Task on
   // the list.  We use this simple list structure rather than building
   // a container, in order to avoid memory allocation while holding
@@ -127,6 +179,14 @@ class Task
   // Whether this Task should be executed soon.  This is used for
   // Tasks which can be run after some data is read.
   bool should_run_soon_;
+  // For --trace-file, the time at which the Task entered its current
+  // state, or 0 if it is running or has not been queued; whether that
+  // state is blocked rather than queued; and the total times spent
+  // blocked and queued.
+  long long trace_since_;
+  bool trace_is_blocked_;
+  long long blocked_usec_;
+  long long queued_usec_;
 };
 
 // An interface for Task_function.  This is a convenience class to run
@@ -233,11 +293,80 @@ class Workqueue
   void
   add_blocker(Task_token*);
 
+  // Print per-thread statistics to stderr.  This is used for --stats.
+  void
+  print_stats();
+
+  // Write the recorded task timeline to FILENAME.  This is used for
+  // --trace-file.
+  void
+  write_trace(const char* filename);
+
  private:
   // This class can not be copied.
   Workqueue(const Workqueue&);
   Workqueue& operator=(const Workqueue&);
 
+  // Statistics gathered for each thread when --stats is used.  All
+  // times are wall clock microseconds.
+  struct Thread_stats
+  {
+    Thread_stats()
+      : tasks_run(0), tasks_handed_off(0), waits(0), idle_time(0),
+	run_time(0)
+    { }
+
+    // Number of tasks run by the thread.
+    unsigned int tasks_run;
+    // Number of those tasks which the thread picked up directly from
+    // the task it ran before, because that task unblocked them.  The
+    // remaining tasks were taken from the shared run queues.
+    unsigned int tasks_handed_off;
+    // Number of times the thread found no runnable task and waited.
+    unsigned int waits;
+    // Time spent waiting for a runnable task.
+    long long idle_time;
+    // Time spent running tasks.
+    long long run_time;
+  };
+
+  // An event recorded for --trace-file.  All times are wall clock
+  // microseconds.
+  struct Trace_event
+  {
+    // The name of the task, or empty for a thread waiting for a task.
+    std::string name;
+    // The thread which ran the task or waited.
+    int thread_number;
+    // When the task started running, or the thread started waiting.
+    long long start;
+    // How long the task ran, or the thread waited.
+    long long duration;
+    // How long the task was blocked by a Task_token before it ran.
+    long long blocked;
+    // How long the task was ready to run before a thread ran it.
+    long long queued;
+  };
+
+  // Note that a Task is blocked, for --trace-file.
+  void
+  note_blocked(Task*);
+
+  // Note that a Task is ready to run, for --trace-file.
+  void
+  note_runnable(Task*);
+
+  // Record an event for --trace-file.  The workqueue lock must be
+  // held when this is called.
+  void
+  add_trace_event(const char* name, int thread_number, long long start,
+		  long long end, long long blocked, long long queued);
+
+  // Return the statistics for a thread.  The workqueue lock must be
+  // held when this is called.
+  Thread_stats&
+  thread_stats(int thread_number);
+
   // Add a task to a queue.
   void
   add_to_queue(Task_list* queue, Task* t, bool front);
@@ -284,6 +413,16 @@ class Workqueue
   // Condition variable associated with lock_.  This is signalled when
   // there may be a new Task to execute.
   Condvar condvar_;
+  // Whether to gather statistics for --stats.
+  bool gather_stats_;
+  // Statistics for each thread, indexed by thread number.
+  std::vector<Thread_stats> thread_stats_;
+  // Whether to record events for --trace-file.
+  bool trace_;
+  // The time at which the workqueue was created, for --trace-file.
+  long long trace_start_;
+  // Events recorded for --trace-file.
+  std::vector<Trace_event> trace_events_;
 
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.